@@ -0,0 +1,109 @@
+/*
+ * Isometry library benchmarks
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include "harness.hpp"
+
+#include <ctime>
+#include <iomanip>
+
+#include <isometry/simd.hpp>
+
+namespace ekumen {
+namespace math {
+namespace bench {
+namespace {
+
+/// \brief Escapes a string for a JSON document.
+std::string escapeJson(const std::string& text) {
+  std::string escaped;
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+/// \brief Current UTC time in ISO 8601 format.
+std::string utcTimestamp() {
+  const std::time_t now = std::time(nullptr);
+  std::tm utc{};
+  gmtime_r(&now, &utc);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+}  // namespace
+
+constexpr int Suite::kRuns;
+
+Suite::Suite(const std::string& filter,
+             const std::chrono::nanoseconds min_run_time)
+    : filter_(filter), min_run_time_(min_run_time) {
+  std::cout << std::left << std::setw(48) << "benchmark" << std::right
+            << std::setw(14) << "ns/op" << std::setw(16) << "ops/s"
+            << std::setw(16) << "points/s" << std::endl;
+}
+
+bool Suite::enabled(const std::string& name) const {
+  return name.find(filter_) != std::string::npos;
+}
+
+void Suite::report(const Result& result) {
+  const double ops_per_second = 1e9 / result.ns_per_op;
+  std::cout << std::left << std::setw(48) << result.name << std::right
+            << std::setw(14) << std::setprecision(4) << result.ns_per_op
+            << std::setw(16) << std::setprecision(4) << ops_per_second
+            << std::setw(16);
+  if (result.points > 0) {
+    std::cout << std::setprecision(4)
+              << ops_per_second * static_cast<double>(result.points);
+  } else {
+    std::cout << "-";
+  }
+  std::cout << std::endl;
+  results_.push_back(result);
+}
+
+void Suite::writeJson(std::ostream& os) const {
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"date\": \"" << utcTimestamp() << "\",\n";
+  os << "    \"compiler\": \"" << escapeJson(__VERSION__) << "\",\n";
+  os << "    \"build_type\": \"" << escapeJson(ISOMETRY_BUILD_TYPE)
+     << "\",\n";
+#ifdef __AVX2__
+  os << "    \"avx2\": true,\n";
+#else
+  os << "    \"avx2\": false,\n";
+#endif
+  os << "    \"simd\": \"" << toString(activeSimdLevel()) << "\",\n";
+  os << "    \"runs\": " << kRuns << ",\n";
+  os << "    \"min_run_time_ns\": " << min_run_time_.count() << "\n";
+  os << "  },\n";
+  os << "  \"benchmarks\": [";
+  os << std::setprecision(6);
+  for (std::size_t i = 0; i < results_.size(); ++i) {
+    const Result& result = results_[i];
+    const double ops_per_second = 1e9 / result.ns_per_op;
+    os << (i == 0 ? "\n" : ",\n");
+    os << "    {\"name\": \"" << escapeJson(result.name) << "\", "
+       << "\"points_per_op\": " << result.points << ", "
+       << "\"iterations\": " << result.iterations << ", "
+       << "\"ns_per_op\": " << result.ns_per_op << ", "
+       << "\"ops_per_second\": " << ops_per_second << ", "
+       << "\"points_per_second\": "
+       << ops_per_second * static_cast<double>(result.points) << "}";
+  }
+  os << "\n  ]\n";
+  os << "}\n";
+}
+
+}  // namespace bench
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,129 @@
+/*
+ * Isometry library benchmarks
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ekumen {
+namespace math {
+namespace bench {
+
+/// \brief Keeps the compiler from discarding the computation of `value`.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "m"(value) : "memory");
+}
+
+/// \brief Keeps the compiler from discarding the computation of `value` and
+/// from assuming it is unchanged afterwards, which also keeps it from hoisting
+/// loop invariant work that reads `value` out of the measured loop.
+template <typename T>
+inline void doNotOptimize(T& value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+
+/// \brief Measurement of a single benchmark.
+struct Result {
+  /// \brief Benchmark name.
+  std::string name;
+
+  /// \brief Points processed by each operation, 0 when it processes none.
+  std::size_t points;
+
+  /// \brief Operations per measured run.
+  std::size_t iterations;
+
+  /// \brief Best observed cost of an operation, in nanoseconds.
+  double ns_per_op;
+};
+
+/**
+ * This class runs the benchmarks and collects their results.
+ *
+ * Each benchmark is calibrated to run for at least the minimum run time, then
+ * measured a fixed number of times, and the fastest run is reported, which is
+ * the least affected by scheduling and frequency noise.
+ */
+class Suite {
+ public:
+  /// \brief Constructs a suite.
+  /// \param filter Only benchmarks whose name contains it are run.
+  /// \param min_run_time Minimum duration of a measured run.
+  Suite(const std::string& filter,
+        const std::chrono::nanoseconds min_run_time);
+
+  /// \brief Measures an operation and prints the result to stdout.
+  /// \param name Benchmark name.
+  /// \param points Points processed by each call to `op`, 0 if none.
+  /// \param op Callable performing one operation.
+  template <typename F>
+  void run(const std::string& name, const std::size_t points, F&& op);
+
+  /// \brief Whether a benchmark named `name` would be run.
+  bool enabled(const std::string& name) const;
+
+  /// \brief Writes every result as a JSON document.
+  /// \param os Stream to write to.
+  void writeJson(std::ostream& os) const;
+
+  /// \brief Results collected so far.
+  const std::vector<Result>& results() const { return results_; }
+
+ private:
+  /// \brief Number of measured runs per benchmark.
+  static constexpr int kRuns{5};
+
+  /// \brief Prints a result as a table row and stores it.
+  void report(const Result& result);
+
+  std::string filter_;
+  std::chrono::nanoseconds min_run_time_;
+  std::vector<Result> results_;
+};
+
+/// \brief Times `iterations` calls to `op`.
+/// \returns Elapsed time in nanoseconds.
+template <typename F>
+inline double timeIterations(F& op, const std::size_t iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    op();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+template <typename F>
+void Suite::run(const std::string& name, const std::size_t points, F&& op) {
+  if (!enabled(name)) {
+    return;
+  }
+  // Doubles the iteration count until a run lasts long enough to be timed
+  // accurately, which also warms up caches and branch predictors.
+  const double min_run_ns = static_cast<double>(min_run_time_.count());
+  std::size_t iterations{1};
+  while (timeIterations(op, iterations) < min_run_ns) {
+    iterations *= 2;
+  }
+  double best{0.};
+  for (int run = 0; run < kRuns; ++run) {
+    const double elapsed = timeIterations(op, iterations);
+    if (run == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  report(Result{name, points, iterations,
+                best / static_cast<double>(iterations)});
+}
+
+}  // namespace bench
+}  // namespace math
+}  // namespace ekumen
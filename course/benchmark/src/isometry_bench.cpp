@@ -0,0 +1,928 @@
+/*
+ * Isometry library benchmarks
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <isometry/binary.hpp>
+#include <isometry/frame_graph.hpp>
+#include <isometry/isometry.hpp>
+#include <isometry/isometry_q.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/parallel_scan.hpp>
+#include <isometry/parallel_transform.hpp>
+#include <isometry/point_cloud.hpp>
+#include <isometry/point_file.hpp>
+#include <isometry/point_stream.hpp>
+#include <isometry/quaternion.hpp>
+#include <isometry/seqlock.hpp>
+#include <isometry/text.hpp>
+#include <isometry/thread_pool.hpp>
+#include <isometry/transform_buffer.hpp>
+#include <isometry/vector3.hpp>
+
+#include "harness.hpp"
+
+namespace ekumen {
+namespace math {
+namespace bench {
+namespace {
+
+// Batch sizes of the point transform benchmarks, from a single point to 10M.
+constexpr std::size_t kBatchSizes[] = {1,     10,     100,     1000,
+                                       10000, 100000, 1000000, 10000000};
+
+/// \brief Measures a unary operation. The operand is reloaded every
+/// iteration, so that the operation cannot be hoisted out of the loop.
+template <typename A, typename F>
+void runUnary(Suite* suite, const std::string& name, const std::size_t points,
+              A a, F op) {
+  suite->run(name, points, [&] {
+    doNotOptimize(a);
+    auto result = op(a);
+    doNotOptimize(result);
+  });
+}
+
+/// \brief Measures a binary operation. The operands are reloaded every
+/// iteration, so that the operation cannot be hoisted out of the loop.
+template <typename A, typename B, typename F>
+void runBinary(Suite* suite, const std::string& name, const std::size_t points,
+               A a, B b, F op) {
+  suite->run(name, points, [&] {
+    doNotOptimize(a);
+    doNotOptimize(b);
+    auto result = op(a, b);
+    doNotOptimize(result);
+  });
+}
+
+void benchVector3(Suite* suite) {
+  const Vector3 a(1.5, -2.25, 3.125);
+  const Vector3 b(-0.5, 4., 2.5);
+  const double s{1.0001};
+  const auto add = [](const auto& x, const auto& y) { return x + y; };
+  const auto sub = [](const auto& x, const auto& y) { return x - y; };
+  const auto mul = [](const auto& x, const auto& y) { return x * y; };
+  const auto div = [](const auto& x, const auto& y) { return x / y; };
+  runBinary(suite, "Vector3::operator+", 0, a, b, add);
+  runBinary(suite, "Vector3::operator-", 0, a, b, sub);
+  runBinary(suite, "Vector3::operator*(Vector3)", 0, a, b, mul);
+  runBinary(suite, "Vector3::operator*(scalar)", 0, a, s, mul);
+  runBinary(suite, "operator*(scalar, Vector3)", 0, s, a, mul);
+  runBinary(suite, "Vector3::operator/(Vector3)", 0, a, b, div);
+  runBinary(suite, "Vector3::operator/(scalar)", 0, a, s, div);
+  runBinary(suite, "Vector3::operator+=", 0, a, b,
+            [](Vector3 x, const Vector3& y) { return x += y; });
+  runBinary(suite, "Vector3::operator-=", 0, a, b,
+            [](Vector3 x, const Vector3& y) { return x -= y; });
+  runBinary(suite, "Vector3::operator*=(Vector3)", 0, a, b,
+            [](Vector3 x, const Vector3& y) { return x *= y; });
+  runBinary(suite, "Vector3::operator*=(scalar)", 0, a, s,
+            [](Vector3 x, const double y) { return x *= y; });
+  runBinary(suite, "Vector3::operator/=(Vector3)", 0, a, b,
+            [](Vector3 x, const Vector3& y) { return x /= y; });
+  runBinary(suite, "Vector3::operator/=(scalar)", 0, a, s,
+            [](Vector3 x, const double y) { return x /= y; });
+  runBinary(suite, "Vector3::operator==", 0, a, b,
+            [](const Vector3& x, const Vector3& y) { return x == y; });
+  runBinary(suite, "Vector3::operator!=", 0, a, b,
+            [](const Vector3& x, const Vector3& y) { return x != y; });
+  runUnary(suite, "Vector3::operator[]", 0, a,
+           [](const Vector3& x) { return x[0] + x[1] + x[2]; });
+  runUnary(suite, "Vector3::at", 0, a,
+           [](const Vector3& x) { return x.at(0) + x.at(1) + x.at(2); });
+  runBinary(suite, "Vector3::dot", 0, a, b,
+            [](const Vector3& x, const Vector3& y) { return x.dot(y); });
+  runBinary(suite, "Vector3::cross", 0, a, b,
+            [](const Vector3& x, const Vector3& y) { return x.cross(y); });
+  runUnary(suite, "Vector3::norm", 0, a,
+           [](const Vector3& x) { return x.norm(); });
+}
+
+void benchMatrix3(Suite* suite) {
+  const Matrix3 a(1., 2., 3., 0.5, -4., 6., 7., 8., -9.);
+  const Matrix3 b(-2., 0.25, 1., 3., 5., -1.5, 2., -7., 4.);
+  const Vector3 v(1.5, -2.25, 3.125);
+  const double s{1.0001};
+  const auto add = [](const auto& x, const auto& y) { return x + y; };
+  const auto sub = [](const auto& x, const auto& y) { return x - y; };
+  const auto mul = [](const auto& x, const auto& y) { return x * y; };
+  const auto div = [](const auto& x, const auto& y) { return x / y; };
+  runBinary(suite, "Matrix3::operator+", 0, a, b, add);
+  runBinary(suite, "Matrix3::operator-", 0, a, b, sub);
+  runBinary(suite, "Matrix3::operator*(Matrix3)", 0, a, b, mul);
+  runBinary(suite, "Matrix3::operator*(Vector3)", 0, a, v, mul);
+  runBinary(suite, "Matrix3::operator*(scalar)", 0, a, s, mul);
+  runBinary(suite, "operator*(scalar, Matrix3)", 0, s, a, mul);
+  runBinary(suite, "Matrix3::operator/(Matrix3)", 0, a, b, div);
+  runBinary(suite, "Matrix3::operator/(scalar)", 0, a, s, div);
+  runBinary(suite, "Matrix3::operator+=", 0, a, b,
+            [](Matrix3 x, const Matrix3& y) { return x += y; });
+  runBinary(suite, "Matrix3::operator-=", 0, a, b,
+            [](Matrix3 x, const Matrix3& y) { return x -= y; });
+  runBinary(suite, "Matrix3::operator*=(Matrix3)", 0, a, b,
+            [](Matrix3 x, const Matrix3& y) { return x *= y; });
+  runBinary(suite, "Matrix3::operator*=(scalar)", 0, a, s,
+            [](Matrix3 x, const double y) { return x *= y; });
+  runBinary(suite, "Matrix3::operator/=(Matrix3)", 0, a, b,
+            [](Matrix3 x, const Matrix3& y) { return x /= y; });
+  runBinary(suite, "Matrix3::operator/=(scalar)", 0, a, s,
+            [](Matrix3 x, const double y) { return x /= y; });
+  runBinary(suite, "Matrix3::operator==", 0, a, b,
+            [](const Matrix3& x, const Matrix3& y) { return x == y; });
+  runBinary(suite, "Matrix3::operator!=", 0, a, b,
+            [](const Matrix3& x, const Matrix3& y) { return x != y; });
+  runUnary(suite, "Matrix3::operator[]", 0, a,
+           [](const Matrix3& x) { return x[0] + x[1] + x[2]; });
+  runUnary(suite, "Matrix3::operator()", 0, a,
+           [](const Matrix3& x) { return x(0, 0) + x(1, 1) + x(2, 2); });
+  runUnary(suite, "Matrix3::row", 0, a,
+           [](const Matrix3& x) { return x.row(1); });
+  runUnary(suite, "Matrix3::col", 0, a,
+           [](const Matrix3& x) { return x.col(1); });
+  runUnary(suite, "Matrix3::det", 0, a,
+           [](const Matrix3& x) { return x.det(); });
+  runUnary(suite, "Matrix3::inverse", 0, a,
+           [](const Matrix3& x) { return x.inverse(); });
+  runUnary(suite, "Matrix3::transpose", 0, a,
+           [](const Matrix3& x) { return x.transpose(); });
+  runBinary(suite, "Matrix3::product(Matrix3)", 0, a, b,
+            [](const Matrix3& x, const Matrix3& y) { return x.product(y); });
+  runBinary(suite, "Matrix3::product(Vector3)", 0, a, v,
+            [](const Matrix3& x, const Vector3& y) { return x.product(y); });
+  runBinary(suite, "Matrix3::transposeProduct", 0, a, v,
+            [](const Matrix3& x, const Vector3& y) {
+              return x.transposeProduct(y);
+            });
+}
+
+void benchIsometry(Suite* suite) {
+  const Isometry a{Vector3(1., 2., 3.),
+                   Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  const Isometry b{
+      Vector3(-4., 0.5, 2.),
+      Isometry::rotateAround(Vector3(1., 2., 3.), 0.7).rotation()};
+  const Vector3 v(1.5, -2.25, 3.125);
+  const Vector3 axis(1., 2., 3.);
+  const double angle{0.7};
+  runUnary(suite, "Isometry::fromTranslation", 0, v,
+           [](const Vector3& x) { return Isometry::fromTranslation(x); });
+  runBinary(suite, "Isometry::rotateAround", 0, axis, angle,
+            [](const Vector3& x, const double y) {
+              return Isometry::rotateAround(x, y);
+            });
+  runUnary(suite, "Isometry::fromEulerAngles", 0, v, [](const Vector3& x) {
+    return Isometry::fromEulerAngles(x.x(), x.y(), x.z());
+  });
+  runBinary(suite, "Isometry::fromUnitAxisAngle", 0, axis / axis.norm(),
+            angle, [](const Vector3& x, const double y) {
+              return Isometry::fromUnitAxisAngle(x, y);
+            });
+  runBinary(suite, "Isometry::compose", 0, a, b,
+            [](const Isometry& x, const Isometry& y) { return x.compose(y); });
+  runBinary(suite, "Isometry::operator*(Isometry)", 0, a, b,
+            [](const Isometry& x, const Isometry& y) { return x * y; });
+  runBinary(suite, "Isometry::operator*=", 0, a, b,
+            [](Isometry x, const Isometry& y) { return x *= y; });
+  runBinary(suite, "Isometry::operator=", 0, a, b,
+            [](Isometry x, const Isometry& y) { return x = y; });
+  runBinary(suite, "Isometry::operator==", 0, a, b,
+            [](const Isometry& x, const Isometry& y) { return x == y; });
+  runUnary(suite, "Isometry::inverse", 0, a,
+           [](const Isometry& x) { return x.inverse(); });
+  runBinary(suite, "Isometry::transform", 1, a, v,
+            [](const Isometry& x, const Vector3& y) { return x.transform(y); });
+  runBinary(suite, "Isometry::operator*(Vector3)", 1, a, v,
+            [](const Isometry& x, const Vector3& y) { return x * y; });
+  runBinary(suite, "Isometry::inverseTransform", 1, a, v,
+            [](const Isometry& x, const Vector3& y) {
+              return x.inverseTransform(y);
+            });
+
+  // Each composition depends on the previous one, which measures latency
+  // rather than throughput.
+  Isometry chain = a;
+  suite->run("Isometry::operator*= (chained)", 0, [&] {
+    doNotOptimize(b);
+    chain *= b;
+  });
+  doNotOptimize(chain);
+}
+
+void benchIsometryQ(Suite* suite) {
+  const IsometryQ a{
+      Isometry{Vector3(1., 2., 3.),
+               Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()}};
+  const IsometryQ b{Isometry{
+      Vector3(-4., 0.5, 2.),
+      Isometry::rotateAround(Vector3(1., 2., 3.), 0.7).rotation()}};
+  const Matrix3 rotation = a.toIsometry().rotation();
+  const Vector3 v(1.5, -2.25, 3.125);
+  runUnary(suite, "Quaternion::fromRotationMatrix", 0, rotation,
+           [](const Matrix3& x) { return Quaternion::fromRotationMatrix(x); });
+  runUnary(suite, "Quaternion::toRotationMatrix", 0, a.rotation(),
+           [](const Quaternion& x) { return x.toRotationMatrix(); });
+  runBinary(suite, "Quaternion::operator*(Quaternion)", 0, a.rotation(),
+            b.rotation(),
+            [](const Quaternion& x, const Quaternion& y) { return x * y; });
+  runBinary(suite, "Quaternion::rotate", 0, a.rotation(), v,
+            [](const Quaternion& x, const Vector3& y) { return x.rotate(y); });
+  runUnary(suite, "Quaternion::normalized", 0, a.rotation(),
+           [](const Quaternion& x) { return x.normalized(); });
+  runBinary(suite, "IsometryQ::operator*(IsometryQ)", 0, a, b,
+            [](const IsometryQ& x, const IsometryQ& y) { return x * y; });
+  runUnary(suite, "IsometryQ::inverse", 0, a,
+           [](const IsometryQ& x) { return x.inverse(); });
+  runBinary(suite, "IsometryQ::transform", 1, a, v,
+            [](const IsometryQ& x, const Vector3& y) {
+              return x.transform(y);
+            });
+  runUnary(suite, "IsometryQ::toIsometry", 0, a,
+           [](const IsometryQ& x) { return x.toIsometry(); });
+
+  IsometryQ chain = a;
+  suite->run("IsometryQ::operator*= (chained)", 0, [&] {
+    doNotOptimize(b);
+    chain *= b;
+  });
+  doNotOptimize(chain);
+}
+
+void benchSerialization(Suite* suite) {
+  const std::size_t kCount{1000};
+  std::vector<Isometry> isometries;
+  std::vector<IsometryQ> compact;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    const double value = 0.001 * static_cast<double>(i);
+    isometries.push_back(
+        Isometry{Vector3(value, -value, 1.),
+                 Isometry::fromEulerAngles(value, 0.2, -value).rotation()});
+    compact.emplace_back(isometries.back());
+  }
+  std::vector<std::uint8_t> buffer(kCount * binary::Codec<Isometry>::kSize);
+  std::vector<Isometry> decoded(kCount);
+  const std::string suffix = "/" + std::to_string(kCount);
+
+  suite->run("binary::encode(Isometry*)" + suffix, kCount, [&] {
+    binary::encode(isometries.data(), kCount, buffer.data());
+    doNotOptimize(buffer.front());
+  });
+  suite->run("binary::decode(Isometry*)" + suffix, kCount, [&] {
+    binary::decode(buffer.data(), kCount, decoded.data());
+    doNotOptimize(decoded.front());
+  });
+  suite->run("binary::ArrayView<Isometry> translation sum" + suffix, kCount,
+             [&] {
+               const binary::ArrayView<Isometry> view{buffer.data(),
+                                                      buffer.size()};
+               double sum{0.};
+               for (std::size_t i = 0; i < view.size(); ++i) {
+                 sum += view[i].translation().x();
+               }
+               doNotOptimize(sum);
+             });
+  suite->run("binary::encode(IsometryQ*)" + suffix, kCount, [&] {
+    binary::encode(compact.data(), kCount, buffer.data());
+    doNotOptimize(buffer.front());
+  });
+  suite->run("operator<<(Isometry) text" + suffix, kCount, [&] {
+    std::ostringstream os;
+    for (const Isometry& isometry : isometries) {
+      os << isometry << '\n';
+    }
+    doNotOptimize(os);
+  });
+
+  // Points are bytes of text here, so that points/s reads as bytes/s.
+  std::vector<char> text(kCount * text::kMaxIsometryLength);
+  char* text_end = text.data();
+  for (const Isometry& isometry : isometries) {
+    text_end = text::format(isometry, text_end, text.data() + text.size());
+    *text_end++ = '\n';
+  }
+  const std::size_t text_bytes = text_end - text.data();
+  suite->run("text::format(Isometry) bytes" + suffix, text_bytes, [&] {
+    char* out = text.data();
+    for (const Isometry& isometry : isometries) {
+      out = text::format(isometry, out, text.data() + text.size());
+      *out++ = '\n';
+    }
+    doNotOptimize(out);
+  });
+  suite->run("text::parse(Isometry) bytes" + suffix, text_bytes, [&] {
+    const char* in = text.data();
+    for (Isometry& isometry : decoded) {
+      in = text::parse(in, text_end, &isometry);
+    }
+    doNotOptimize(decoded.front());
+  });
+}
+
+void benchFrameGraph(Suite* suite) {
+  // A robot-like tree of 43 frames: map -> odom -> base, then four chains of
+  // 10 frames each hanging from base.
+  FrameGraph graph;
+  const FrameGraph::FrameId map = graph.addFrame("map");
+  const FrameGraph::FrameId odom = graph.addFrame(
+      "odom", map, Isometry::fromTranslation(Vector3(10., -3., 0.)));
+  const FrameGraph::FrameId base =
+      graph.addFrame("base", odom, Isometry::fromEulerAngles(0., 0., 0.5));
+  std::vector<FrameGraph::FrameId> leaves;
+  for (int chain = 0; chain < 4; ++chain) {
+    FrameGraph::FrameId frame = base;
+    for (int i = 0; i < 10; ++i) {
+      const double value = 0.1 * (chain + 1) * (i + 1);
+      frame = graph.addFrame(
+          "chain_" + std::to_string(chain) + "_" + std::to_string(i), frame,
+          Isometry{Vector3(value, -value, 0.5),
+                   Isometry::fromEulerAngles(value, 0.1, -value).rotation()});
+    }
+    leaves.push_back(frame);
+  }
+
+  runBinary(suite, "FrameGraph::lookup(leaf, map)", 0, leaves[0], map,
+            [&graph](const FrameGraph::FrameId source,
+                     const FrameGraph::FrameId target) {
+              return graph.lookup(source, target);
+            });
+  runBinary(suite, "FrameGraph::lookup(leaf, leaf)", 0, leaves[0], leaves[3],
+            [&graph](const FrameGraph::FrameId source,
+                     const FrameGraph::FrameId target) {
+              return graph.lookup(source, target);
+            });
+  runBinary(suite, "FrameGraph::lookup(name, name)", 0,
+            std::string("chain_0_9"), std::string("chain_3_9"),
+            [&graph](const std::string& source, const std::string& target) {
+              return graph.lookup(source, target);
+            });
+  // Names too long for the small string buffer of std::string.
+  graph.addFrame("camera_depth_optical_frame", leaves[0],
+                 Isometry::fromTranslation(Vector3::kUnitZ));
+  graph.addFrame("gripper_palm_center_link", leaves[3],
+                 Isometry::fromTranslation(Vector3::kUnitX));
+  // Literals are passed as arrays, runBinary would decay them to pointers.
+  suite->run("FrameGraph::lookup(long name, long name)", 0, [&graph] {
+    auto result =
+        graph.lookup("camera_depth_optical_frame", "gripper_palm_center_link");
+    doNotOptimize(result);
+  });
+}
+
+void benchTransformBuffer(Suite* suite) {
+  // 10k samples at 100 Hz, after the ring has wrapped around once.
+  const std::size_t kCapacity{10000};
+  TransformBuffer buffer{kCapacity};
+  for (std::size_t i = 0; i < 2 * kCapacity; ++i) {
+    const double time = 0.01 * static_cast<double>(i);
+    buffer.insert(time, Isometry{Vector3(time, -time, 1.),
+                                 Isometry::fromEulerAngles(0.1, 0.2, time)
+                                     .rotation()});
+  }
+  // Query times spread over the whole history, visited in a scrambled order
+  // so that the binary search branches cannot be learned.
+  std::vector<double> times;
+  for (std::size_t i = 0; i < 1024; ++i) {
+    const std::size_t sample = (i * 7919) % (kCapacity - 1);
+    times.push_back(buffer.oldestTime() + 0.01 * sample + 0.0037);
+  }
+  std::size_t next{0};
+  suite->run("TransformBuffer::lookup(10k samples)", 0, [&] {
+    const double time = times[next++ & 1023];
+    Isometry result = buffer.lookup(time);
+    doNotOptimize(result);
+  });
+  double time = buffer.newestTime();
+  suite->run("TransformBuffer::insert", 0, [&] {
+    time += 0.01;
+    buffer.insert(time, buffer.latest());
+  });
+}
+
+/// \brief Measures `read` on this thread while `readers` - 1 other threads
+/// call it in a loop and one more thread calls `write` at 200 Hz, the rate of a
+/// typical localization update.
+template <typename Read, typename Write>
+void runContended(Suite* suite, const std::string& name, const int readers,
+                  Read read, Write write) {
+  if (!suite->enabled(name)) {
+    return;
+  }
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int i = 1; i < readers; ++i) {
+    threads.emplace_back([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto result = read();
+        doNotOptimize(result);
+      }
+    });
+  }
+  threads.emplace_back([&] {
+    for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+      write(i);
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  });
+  suite->run(name, 0, [&] {
+    auto result = read();
+    doNotOptimize(result);
+  });
+  stop = true;
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void benchPublication(Suite* suite) {
+  const auto makePose = [](const int i) {
+    return Isometry{Vector3(i, -i, 0.),
+                    Isometry::fromEulerAngles(0., 0., 0.001 * i).rotation()};
+  };
+  SeqLock<Isometry> seqlock{makePose(0)};
+  std::mutex mutex;
+  Isometry guarded{makePose(0)};
+  for (const int readers : {1, 4, 30}) {
+    const std::string suffix = " (" + std::to_string(readers) + " readers)";
+    runContended(
+        suite, "SeqLock<Isometry>::load" + suffix, readers,
+        [&seqlock] { return seqlock.load(); },
+        [&](const int i) { seqlock.store(makePose(i)); });
+    runContended(
+        suite, "std::mutex Isometry copy" + suffix, readers,
+        [&] {
+          std::lock_guard<std::mutex> lock{mutex};
+          return guarded;
+        },
+        [&](const int i) {
+          const Isometry pose = makePose(i);
+          std::lock_guard<std::mutex> lock{mutex};
+          guarded = pose;
+        });
+  }
+}
+
+/// \brief Builds `count` points with distinct, non trivial coordinates.
+template <typename P>
+std::vector<Vector3T<P>> makePoints(const std::size_t count) {
+  std::vector<Vector3T<P>> points;
+  points.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const P value = static_cast<P>(i % 1000);
+    points.emplace_back(value, P{2} * value, P{-3} * value);
+  }
+  return points;
+}
+
+void benchBatchTransform(Suite* suite) {
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  for (const std::size_t size : kBatchSizes) {
+    const std::string suffix = "/" + std::to_string(size);
+
+    // Points are only allocated for the enabled benchmarks, the largest
+    // batches take hundreds of megabytes.
+    if (suite->enabled("Isometry::transform(Vector3*)" + suffix)) {
+      const std::vector<Vector3> points = makePoints<double>(size);
+      std::vector<Vector3> output(size);
+      suite->run("Isometry::transform(Vector3*)" + suffix, size, [&] {
+        isometry.transform(points.data(), size, output.data());
+        doNotOptimize(output.front());
+      });
+    }
+    if (suite->enabled("Isometry::transform(Vector3f*)" + suffix)) {
+      const std::vector<Vector3f> points = makePoints<float>(size);
+      std::vector<Vector3f> output(size);
+      suite->run("Isometry::transform(Vector3f*)" + suffix, size, [&] {
+        isometry.transform(points.data(), size, output.data());
+        doNotOptimize(output.front());
+      });
+    }
+    if (suite->enabled("Isometry::transform(PointCloud)" + suffix)) {
+      const PointCloud cloud{makePoints<double>(size)};
+      PointCloud output(size);
+      suite->run("Isometry::transform(PointCloud)" + suffix, size, [&] {
+        isometry.transform(cloud, &output);
+        doNotOptimize(output.x()[0]);
+      });
+    }
+    if (suite->enabled("Isometry::transform(PointCloudf)" + suffix)) {
+      const PointCloudf cloud{makePoints<float>(size)};
+      PointCloudf output(size);
+      suite->run("Isometry::transform(PointCloudf)" + suffix, size, [&] {
+        isometry.transform(cloud, &output);
+        doNotOptimize(output.x()[0]);
+      });
+    }
+  }
+}
+
+void benchBulkCopy(Suite* suite) {
+  const std::size_t kCount{100000};
+  const std::vector<Isometry> poses(
+      kCount, Isometry{Vector3(1., 2., 3.),
+                       Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()});
+  std::vector<Isometry> copies(kCount);
+  const std::string suffix = "/" + std::to_string(kCount);
+  suite->run("std::copy(Isometry)" + suffix, kCount, [&] {
+    std::copy(poses.begin(), poses.end(), copies.begin());
+    doNotOptimize(copies.front());
+  });
+  // Growth from empty relocates every element already stored, about once
+  // more in total.
+  suite->run("std::vector<Isometry>::push_back (growth)" + suffix, kCount,
+             [&] {
+               std::vector<Isometry> grown;
+               for (const Isometry& pose : poses) {
+                 grown.push_back(pose);
+               }
+               doNotOptimize(grown.back());
+             });
+}
+
+void benchBatchBuilders(Suite* suite) {
+  // IMU-like angles: small rolls and pitches, yaws over a full turn.
+  const std::size_t kCount{4096};
+  std::vector<double> roll(kCount);
+  std::vector<double> pitch(kCount);
+  std::vector<double> yaw(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    roll[i] = 0.1 * std::sin(0.01 * i);
+    pitch[i] = 0.05 * std::cos(0.02 * i);
+    yaw[i] = 6.28 * static_cast<double>(i) / kCount - 3.14;
+  }
+  std::vector<Isometry> output(kCount);
+  const std::string suffix = "/" + std::to_string(kCount);
+  suite->run("Isometry::fromEulerAngles (loop)" + suffix, kCount, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      output[i] = Isometry::fromEulerAngles(roll[i], pitch[i], yaw[i]);
+    }
+    doNotOptimize(output.front());
+  });
+  suite->run("Isometry::fromEulerAngles(double*)" + suffix, kCount, [&] {
+    Isometry::fromEulerAngles(roll.data(), pitch.data(), yaw.data(), kCount,
+                              output.data());
+    doNotOptimize(output.front());
+  });
+}
+
+void benchExpLog(Suite* suite) {
+  // Pose increments of an odometry: small rotations and translations.
+  const std::size_t kCount{4096};
+  std::vector<Twist> twists(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    twists[i] = Twist{Vector3(0.1, 0.01 * std::sin(0.1 * i), 0.),
+                      Vector3(0.01 * std::cos(0.03 * i), 0.02,
+                              0.3 * std::sin(0.01 * i))};
+  }
+  std::vector<Isometry> isometries(kCount);
+  std::vector<Twist> logs(kCount);
+  const std::string suffix = "/" + std::to_string(kCount);
+  suite->run("Isometry::exp (loop)" + suffix, kCount, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      isometries[i] = Isometry::exp(twists[i]);
+    }
+    doNotOptimize(isometries.front());
+  });
+  suite->run("Isometry::exp(Twist*)" + suffix, kCount, [&] {
+    Isometry::exp(twists.data(), kCount, isometries.data());
+    doNotOptimize(isometries.front());
+  });
+  suite->run("Isometry::log(Isometry*)" + suffix, kCount, [&] {
+    Isometry::log(isometries.data(), kCount, logs.data());
+    doNotOptimize(logs.front());
+  });
+  // The textbook logarithm of the rotation, with acos of the trace, which
+  // loses half the digits of small angles.
+  std::vector<Vector3> rotations(kCount);
+  suite->run("Matrix3 acos log (loop)" + suffix, kCount, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      const Matrix3& r = isometries[i].rotation();
+      const double theta =
+          std::acos(std::max(-1., std::min(1., 0.5 * (r[0][0] + r[1][1] +
+                                                      r[2][2] - 1.))));
+      const double scale = theta > 0. ? 0.5 * theta / std::sin(theta) : 0.5;
+      rotations[i] = Vector3(r[2][1] - r[1][2], r[0][2] - r[2][0],
+                             r[1][0] - r[0][1]) *
+                     scale;
+    }
+    doNotOptimize(rotations.front());
+  });
+  suite->run("Matrix3::log (loop)" + suffix, kCount, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      rotations[i] = isometries[i].rotation().log();
+    }
+    doNotOptimize(rotations.front());
+  });
+}
+
+void benchPointFile(Suite* suite) {
+  const std::size_t kCount{2000000};
+  const std::string read_name{"read() + Isometry::transform(Vector3f*)/" +
+                              std::to_string(kCount)};
+  const std::string map_name{"PointFile + Isometry::transform(PointViewf)/" +
+                             std::to_string(kCount)};
+  if (!suite->enabled(read_name) && !suite->enabled(map_name)) {
+    return;
+  }
+  // A PLY file of float points with an intensity, the common lidar layout,
+  // so that reading in place has to skip a field of every record.
+  const char* directory = std::getenv("TMPDIR");
+  const std::string path = std::string(directory != nullptr ? directory
+                                                            : "/tmp") +
+                           "/isometry_bench_cloud.ply";
+  {
+    std::ofstream file{path, std::ios::binary};
+    file << "ply\nformat binary_little_endian 1.0\nelement vertex " << kCount
+         << "\nproperty float x\nproperty float y\nproperty float z\n"
+            "property float intensity\nend_header\n";
+    const std::vector<Vector3f> points = makePoints<float>(kCount);
+    for (const Vector3f& point : points) {
+      const float record[4] = {point.x(), point.y(), point.z(), 1.f};
+      file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+  }
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  std::vector<Vector3f> output(kCount);
+
+  // The baseline reads the whole file, then copies the points out of it, as
+  // tools without a reader in place do.
+  suite->run(read_name, kCount, [&] {
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    std::vector<char> bytes(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(bytes.data(), bytes.size());
+    const char* records = bytes.data() + bytes.size() - 16 * kCount;
+    std::vector<Vector3f> points(kCount);
+    for (std::size_t i = 0; i < kCount; ++i) {
+      std::memcpy(&points[i], records + 16 * i, sizeof(Vector3f));
+    }
+    isometry.transform(points.data(), kCount, output.data());
+    doNotOptimize(output.front());
+  });
+  suite->run(map_name, kCount, [&] {
+    const PointFile file{path};
+    isometry.transform(file.points<float>(), output.data());
+    doNotOptimize(output.front());
+  });
+  std::remove(path.c_str());
+}
+
+void benchStreamTransform(Suite* suite) {
+  const std::size_t kCount{4000000};
+  const std::size_t kStride{4 * sizeof(float)};
+  const std::string loop_name{"read() + transform + write() loop/" +
+                              std::to_string(kCount)};
+  const std::string stream_name{"streamTransform<float>/" +
+                                std::to_string(kCount)};
+  if (!suite->enabled(loop_name) && !suite->enabled(stream_name)) {
+    return;
+  }
+  // 64 MB of float points with an intensity, copied from a file to another.
+  const char* directory = std::getenv("TMPDIR");
+  const std::string path = std::string(directory != nullptr ? directory
+                                                            : "/tmp") +
+                           "/isometry_bench_stream";
+  const std::string input_path = path + ".in";
+  const std::string output_path = path + ".out";
+  {
+    std::ofstream file{input_path, std::ios::binary};
+    for (const Vector3f& point : makePoints<float>(kCount)) {
+      const float record[4] = {point.x(), point.y(), point.z(), 1.f};
+      file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+  }
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  const auto open_files = [&](int* input, int* output) {
+    *input = ::open(input_path.c_str(), O_RDONLY);
+    *output = ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  };
+
+  // The baseline is the serialized loop that the pipeline replaces, with
+  // buffers of the same size and the same kernel.
+  const std::size_t buffer_points = StreamOptions{}.buffer_size / kStride;
+  std::vector<std::uint8_t> buffer(buffer_points * kStride);
+  std::vector<Vector3f> points(buffer_points);
+  suite->run(loop_name, kCount, [&] {
+    int input;
+    int output;
+    open_files(&input, &output);
+    ssize_t size;
+    while ((size = ::read(input, buffer.data(), buffer.size())) > 0) {
+      const std::size_t count = static_cast<std::size_t>(size) / kStride;
+      isometry.transform(PointViewf(buffer.data(), count, kStride),
+                         points.data());
+      for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(&buffer[i * kStride], &points[i], sizeof(Vector3f));
+      }
+      if (::write(output, buffer.data(), count * kStride) < 0) {
+        break;
+      }
+    }
+    ::close(input);
+    ::close(output);
+  });
+  suite->run(stream_name, kCount, [&] {
+    int input;
+    int output;
+    open_files(&input, &output);
+    const std::size_t count =
+        streamTransform<float>(isometry, input, output, kStride);
+    doNotOptimize(count);
+    ::close(input);
+    ::close(output);
+  });
+  std::remove(input_path.c_str());
+  std::remove(output_path.c_str());
+}
+
+/// \brief Thread counts of the scaling benchmarks: 1, 2, 4, ... up to one
+/// per hardware thread.
+std::vector<std::size_t> threadCounts() {
+  const std::size_t max_threads =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  std::vector<std::size_t> thread_counts;
+  for (std::size_t threads = 1; threads < max_threads; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(max_threads);
+  return thread_counts;
+}
+
+void benchParallelTransform(Suite* suite) {
+  // A 2M-point cloud, the size of a dense lidar sweep, on 1, 2, 4, ...
+  // threads up to one per hardware thread.
+  const std::size_t kSize{2000000};
+  const std::vector<std::size_t> thread_counts = threadCounts();
+  const auto name = [kSize](const std::string& function,
+                            const std::size_t threads) {
+    return function + "/" + std::to_string(kSize) + "/" +
+           std::to_string(threads) + "t";
+  };
+  // The clouds take over 100 MB, so they are only built when needed.
+  bool enabled{false};
+  for (const std::size_t threads : thread_counts) {
+    enabled = enabled ||
+              suite->enabled(name("parallelTransform(PointCloud)", threads)) ||
+              suite->enabled(name("parallelTransform(PointCloudf)", threads));
+  }
+  if (!enabled) {
+    return;
+  }
+
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  const PointCloud cloud{makePoints<double>(kSize)};
+  PointCloud output(kSize);
+  const PointCloudf cloud_float{makePoints<float>(kSize)};
+  PointCloudf output_float(kSize);
+  for (const std::size_t threads : thread_counts) {
+    ThreadPool pool{threads};
+    suite->run(name("parallelTransform(PointCloud)", threads), kSize, [&] {
+      parallelTransform(isometry, cloud, &output, &pool);
+      doNotOptimize(output.x()[0]);
+    });
+    suite->run(name("parallelTransform(PointCloudf)", threads), kSize, [&] {
+      parallelTransform(isometry, cloud_float, &output_float, &pool);
+      doNotOptimize(output_float.x()[0]);
+    });
+  }
+}
+
+void benchCompositionScan(Suite* suite) {
+  // 1M odometry deltas, folded serially and scanned on 1, 2, 4, ... threads
+  // up to one per hardware thread.
+  const std::size_t kSize{1000000};
+  const std::vector<std::size_t> thread_counts = threadCounts();
+  const std::string serial_name =
+      "serial Isometry::operator*= fold/" + std::to_string(kSize);
+  const auto parallel_name = [kSize](const std::size_t threads) {
+    return "parallelInclusiveScan(Isometry)/" + std::to_string(kSize) + "/" +
+           std::to_string(threads) + "t";
+  };
+  bool enabled = suite->enabled(serial_name);
+  for (const std::size_t threads : thread_counts) {
+    enabled = enabled || suite->enabled(parallel_name(threads));
+  }
+  if (!enabled) {
+    return;
+  }
+  std::vector<Isometry> deltas;
+  deltas.reserve(kSize);
+  for (std::size_t i = 0; i < kSize; ++i) {
+    const double turn = 0.01 * static_cast<double>(i % 100) - 0.5;
+    deltas.emplace_back(Vector3(0.1, 0., 0.),
+                        Isometry::fromEulerAngles(0., 0., turn).rotation());
+  }
+  std::vector<Isometry> poses(kSize);
+
+  suite->run(serial_name, kSize, [&] {
+    Isometry pose = deltas[0];
+    poses[0] = pose;
+    for (std::size_t i = 1; i < kSize; ++i) {
+      pose *= deltas[i];
+      poses[i] = pose;
+    }
+    doNotOptimize(poses.back());
+  });
+  for (const std::size_t threads : thread_counts) {
+    ThreadPool pool{threads};
+    suite->run(parallel_name(threads), kSize, [&] {
+      parallelInclusiveScan(deltas.data(), kSize, poses.data(), &pool);
+      doNotOptimize(poses.back());
+    });
+  }
+}
+
+void printUsage(const char* program) {
+  std::cerr << "Usage: " << program
+            << " [--filter <substring>] [--json <path>]"
+               " [--min-time-ms <milliseconds>]\n"
+               "  --filter       Only runs the benchmarks whose name contains "
+               "the substring.\n"
+               "  --json         Writes the results as JSON to the path.\n"
+               "  --min-time-ms  Minimum duration of each measured run, 20 by "
+               "default.\n";
+}
+
+}  // namespace
+}  // namespace bench
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char** argv) {
+  namespace bench = ekumen::math::bench;
+  std::string filter;
+  std::string json_path;
+  long min_time_ms{20};
+  for (int i = 1; i < argc; i += 2) {
+    const std::string arg{argv[i]};
+    if (i + 1 >= argc) {
+      bench::printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    if (arg == "--filter") {
+      filter = argv[i + 1];
+    } else if (arg == "--json") {
+      json_path = argv[i + 1];
+    } else if (arg == "--min-time-ms") {
+      min_time_ms = std::strtol(argv[i + 1], nullptr, 10);
+    } else {
+      bench::printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (min_time_ms <= 0) {
+    bench::printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bench::Suite suite{filter, std::chrono::milliseconds(min_time_ms)};
+  bench::benchVector3(&suite);
+  bench::benchMatrix3(&suite);
+  bench::benchIsometry(&suite);
+  bench::benchIsometryQ(&suite);
+  bench::benchBatchBuilders(&suite);
+  bench::benchBulkCopy(&suite);
+  bench::benchExpLog(&suite);
+  bench::benchSerialization(&suite);
+  bench::benchFrameGraph(&suite);
+  bench::benchTransformBuffer(&suite);
+  bench::benchPublication(&suite);
+  bench::benchBatchTransform(&suite);
+  bench::benchPointFile(&suite);
+  bench::benchStreamTransform(&suite);
+  bench::benchParallelTransform(&suite);
+  bench::benchCompositionScan(&suite);
+
+  if (!json_path.empty()) {
+    std::ofstream json{json_path};
+    suite.writeJson(json);
+    if (!json) {
+      std::cerr << "Could not write " << json_path << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
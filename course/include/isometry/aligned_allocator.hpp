@@ -0,0 +1,76 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <isometry/error.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * Standard allocator that returns storage aligned to a given boundary, so
+ * that containers using it can be loaded with aligned SIMD instructions.
+ */
+template <typename T, std::size_t Alignment>
+class AlignedAllocator {
+ public:
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two not smaller than alignof(T)");
+
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  /// \brief Default constructor.
+  AlignedAllocator() = default;
+
+  /// \brief Converting constructor from an allocator of another type.
+  template <typename U>
+  explicit AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  /// \brief Allocates storage for `count` elements.
+  /// \throw std::bad_alloc When the allocation fails, which aborts in
+  /// builds without exceptions.
+  T* allocate(const std::size_t count) {
+    void* ptr{nullptr};
+    if (posix_memalign(&ptr, Alignment, count * sizeof(T)) != 0) {
+#if ISOMETRY_HAS_EXCEPTIONS
+      throw std::bad_alloc();
+#else
+      std::abort();
+#endif
+    }
+    return static_cast<T*>(ptr);
+  }
+
+  /// \brief Releases storage obtained from allocate().
+  void deallocate(T* ptr, const std::size_t) { std::free(ptr); }
+};
+
+/// \brief All aligned allocators with the same alignment are interchangeable.
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+
+/// \brief All aligned allocators with the same alignment are interchangeable.
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,345 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <isometry/error.hpp>
+#include <isometry/isometry.hpp>
+#include <isometry/isometry_q.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/quaternion.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * Fixed-layout binary encoding of the double precision types.
+ *
+ * Every value is stored as consecutive little-endian IEEE 754 doubles, with
+ * no header nor padding, so encoding is lossless and records can be read in
+ * place:
+ *
+ * - Vector3, 24 bytes: x, y, z.
+ * - Matrix3, 72 bytes: the 9 elements in row-major order.
+ * - Isometry, 96 bytes: the translation as a Vector3, then the rotation as a
+ *   Matrix3.
+ * - IsometryQ, 56 bytes: the translation as a Vector3, then the rotation
+ *   quaternion as w, x, y, z. This is the compact form of an isometry, see
+ *   IsometryQ(const Isometry&).
+ */
+namespace binary {
+
+static_assert(std::numeric_limits<double>::is_iec559 && sizeof(double) == 8,
+              "The binary encoding requires IEEE 754 doubles");
+
+namespace internal {
+
+/// \brief Stores a double as 8 little-endian bytes.
+inline void storeDouble(const double value, std::uint8_t* out) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  bits = __builtin_bswap64(bits);
+#endif
+  std::memcpy(out, &bits, sizeof(bits));
+}
+
+/// \brief Loads a double from 8 little-endian bytes.
+inline double loadDouble(const std::uint8_t* in) {
+  std::uint64_t bits;
+  std::memcpy(&bits, in, sizeof(bits));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  bits = __builtin_bswap64(bits);
+#endif
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace internal
+
+/// \brief Encoding of a type, specialized for every encodable type.
+template <typename T>
+struct Codec;
+
+/// \brief Encoding of a Vector3.
+template <>
+struct Codec<Vector3> {
+  /// \brief Encoded size in bytes.
+  static constexpr std::size_t kSize{24};
+
+  static void encode(const Vector3& value, std::uint8_t* out) {
+    for (int i = 0; i < 3; ++i) {
+      internal::storeDouble(value[i], out + 8 * i);
+    }
+  }
+
+  static Vector3 decode(const std::uint8_t* in) {
+    return Vector3(internal::loadDouble(in), internal::loadDouble(in + 8),
+                   internal::loadDouble(in + 16));
+  }
+};
+
+/// \brief Encoding of a Matrix3.
+template <>
+struct Codec<Matrix3> {
+  /// \brief Encoded size in bytes.
+  static constexpr std::size_t kSize{72};
+
+  static void encode(const Matrix3& value, std::uint8_t* out) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        internal::storeDouble(value(r, c), out + 8 * (3 * r + c));
+      }
+    }
+  }
+
+  static Matrix3 decode(const std::uint8_t* in) {
+    using internal::loadDouble;
+    return Matrix3(loadDouble(in), loadDouble(in + 8), loadDouble(in + 16),
+                   loadDouble(in + 24), loadDouble(in + 32),
+                   loadDouble(in + 40), loadDouble(in + 48),
+                   loadDouble(in + 56), loadDouble(in + 64));
+  }
+};
+
+/// \brief Encoding of an Isometry.
+template <>
+struct Codec<Isometry> {
+  /// \brief Encoded size in bytes.
+  static constexpr std::size_t kSize{96};
+
+  static void encode(const Isometry& value, std::uint8_t* out) {
+    Codec<Vector3>::encode(value.translation(), out);
+    Codec<Matrix3>::encode(value.rotation(), out + Codec<Vector3>::kSize);
+  }
+
+  static Isometry decode(const std::uint8_t* in) {
+    return Isometry(Codec<Vector3>::decode(in),
+                    Codec<Matrix3>::decode(in + Codec<Vector3>::kSize));
+  }
+};
+
+/// \brief Encoding of an IsometryQ, the compact form of an isometry.
+template <>
+struct Codec<IsometryQ> {
+  /// \brief Encoded size in bytes.
+  static constexpr std::size_t kSize{56};
+
+  static void encode(const IsometryQ& value, std::uint8_t* out) {
+    Codec<Vector3>::encode(value.translation(), out);
+    const Quaternion& rotation = value.rotation();
+    internal::storeDouble(rotation.w(), out + 24);
+    internal::storeDouble(rotation.x(), out + 32);
+    internal::storeDouble(rotation.y(), out + 40);
+    internal::storeDouble(rotation.z(), out + 48);
+  }
+
+  static IsometryQ decode(const std::uint8_t* in) {
+    return IsometryQ(Codec<Vector3>::decode(in),
+                     Quaternion(internal::loadDouble(in + 24),
+                                internal::loadDouble(in + 32),
+                                internal::loadDouble(in + 40),
+                                internal::loadDouble(in + 48)));
+  }
+};
+
+/// \brief Encodes a value.
+/// \param value Value to encode.
+/// \param out Storage for Codec<T>::kSize bytes.
+template <typename T>
+inline void encode(const T& value, std::uint8_t* out) {
+  Codec<T>::encode(value, out);
+}
+
+/// \brief Encodes an array of values back to back.
+/// \param values Pointer to the first of `count` values.
+/// \param count Number of values.
+/// \param out Storage for `count` * Codec<T>::kSize bytes.
+template <typename T>
+inline void encode(const T* values, const std::size_t count,
+                   std::uint8_t* out) {
+  for (std::size_t i = 0; i < count; ++i) {
+    Codec<T>::encode(values[i], out + i * Codec<T>::kSize);
+  }
+}
+
+/// \brief Decodes a value.
+/// \param in Pointer to Codec<T>::kSize bytes.
+/// \returns The decoded value.
+template <typename T>
+inline T decode(const std::uint8_t* in) {
+  return Codec<T>::decode(in);
+}
+
+/// \brief Decodes an array of values stored back to back.
+/// \param in Pointer to `count` * Codec<T>::kSize bytes.
+/// \param count Number of values.
+/// \param values Storage for `count` values.
+template <typename T>
+inline void decode(const std::uint8_t* in, const std::size_t count,
+                   T* values) {
+  for (std::size_t i = 0; i < count; ++i) {
+    values[i] = Codec<T>::decode(in + i * Codec<T>::kSize);
+  }
+}
+
+/// \brief Read-only view of an encoded value, which decodes only the elements
+/// that are read. Specialized for every encodable type.
+template <typename T>
+class View;
+
+/// \brief View of an encoded Vector3.
+template <>
+class View<Vector3> {
+ public:
+  /// \brief Constructs a view of Codec<Vector3>::kSize bytes at `data`, which
+  /// must outlive it.
+  explicit View(const std::uint8_t* data) : data_(data) {}
+
+  double x() const { return internal::loadDouble(data_); }
+  double y() const { return internal::loadDouble(data_ + 8); }
+  double z() const { return internal::loadDouble(data_ + 16); }
+
+  /// \brief Coordinate `index`, 0 to 2.
+  double operator[](const int index) const {
+    return internal::loadDouble(data_ + 8 * index);
+  }
+
+  /// \brief Decodes the whole vector.
+  Vector3 value() const { return Codec<Vector3>::decode(data_); }
+
+ private:
+  const std::uint8_t* data_;
+};
+
+/// \brief View of an encoded Matrix3.
+template <>
+class View<Matrix3> {
+ public:
+  /// \brief Constructs a view of Codec<Matrix3>::kSize bytes at `data`, which
+  /// must outlive it.
+  explicit View(const std::uint8_t* data) : data_(data) {}
+
+  /// \brief Element at `row` and `col`, 0 to 2.
+  double operator()(const int row, const int col) const {
+    return internal::loadDouble(data_ + 8 * (3 * row + col));
+  }
+
+  /// \brief Decodes the whole matrix.
+  Matrix3 value() const { return Codec<Matrix3>::decode(data_); }
+
+ private:
+  const std::uint8_t* data_;
+};
+
+/// \brief View of an encoded Isometry.
+template <>
+class View<Isometry> {
+ public:
+  /// \brief Constructs a view of Codec<Isometry>::kSize bytes at `data`,
+  /// which must outlive it.
+  explicit View(const std::uint8_t* data) : data_(data) {}
+
+  View<Vector3> translation() const { return View<Vector3>(data_); }
+
+  View<Matrix3> rotation() const {
+    return View<Matrix3>(data_ + Codec<Vector3>::kSize);
+  }
+
+  /// \brief Decodes the whole isometry.
+  Isometry value() const { return Codec<Isometry>::decode(data_); }
+
+ private:
+  const std::uint8_t* data_;
+};
+
+/// \brief View of an encoded IsometryQ.
+template <>
+class View<IsometryQ> {
+ public:
+  /// \brief Constructs a view of Codec<IsometryQ>::kSize bytes at `data`,
+  /// which must outlive it.
+  explicit View(const std::uint8_t* data) : data_(data) {}
+
+  View<Vector3> translation() const { return View<Vector3>(data_); }
+
+  /// \brief Decodes the rotation.
+  Quaternion rotation() const {
+    return Quaternion(internal::loadDouble(data_ + 24),
+                      internal::loadDouble(data_ + 32),
+                      internal::loadDouble(data_ + 40),
+                      internal::loadDouble(data_ + 48));
+  }
+
+  /// \brief Decodes the whole isometry.
+  IsometryQ value() const { return Codec<IsometryQ>::decode(data_); }
+
+ private:
+  const std::uint8_t* data_;
+};
+
+/**
+ * This class is used to read an array of encoded values in place, for
+ * instance from a file mapped in memory, without decoding it up front.
+ */
+template <typename T>
+class ArrayView {
+ public:
+  /// \brief Constructs a view of a buffer of values stored back to back.
+  /// \param data Pointer to the buffer, which must outlive the view.
+  /// \param bytes Size of the buffer in bytes.
+  /// \throw std::invalid_argument When `bytes` is not a multiple of
+  /// Codec<T>::kSize.
+  ArrayView(const std::uint8_t* data, const std::size_t bytes)
+      : data_(data), size_(bytes / Codec<T>::kSize) {
+    if (bytes % Codec<T>::kSize != 0) {
+      math::internal::fail<std::invalid_argument>(
+          "Buffer of " + std::to_string(bytes) +
+          " bytes does not hold a whole number of " +
+          std::to_string(Codec<T>::kSize) + " byte records");
+    }
+  }
+
+  /// \brief Number of values.
+  std::size_t size() const { return size_; }
+
+  /// \brief Whether the view holds no values.
+  bool empty() const { return size_ == 0; }
+
+  /// \brief View of a value.
+  /// \pre `index` is less than size(), it is not checked.
+  View<T> operator[](const std::size_t index) const {
+    return View<T>(data_ + index * Codec<T>::kSize);
+  }
+
+  /// \brief View of a value.
+  /// \throw std::out_of_range When `index` is not less than size().
+  View<T> at(const std::size_t index) const {
+    if (index >= size_) {
+      math::internal::fail<std::out_of_range>(
+          "Index " + std::to_string(index) + " is out of range for a view of " +
+          std::to_string(size_) + " values");
+    }
+    return (*this)[index];
+  }
+
+ private:
+  const std::uint8_t* data_;
+  std::size_t size_;
+};
+
+}  // namespace binary
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,43 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Whether exceptions are enabled, which they are not with -fno-exceptions
+// (see the ISOMETRY_NO_EXCEPTIONS CMake option).
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define ISOMETRY_HAS_EXCEPTIONS 1
+#else
+#define ISOMETRY_HAS_EXCEPTIONS 0
+#endif
+
+namespace ekumen {
+namespace math {
+namespace internal {
+
+/// \brief Reports an error of the throwing API.
+///
+/// Throws an `E` with `message`, or, in builds without exceptions, prints
+/// `message` to stderr and aborts. Code that must not abort uses the noexcept
+/// alternatives instead, such as Matrix3T::tryInverse().
+/// \param message Description of the error.
+template <typename E>
+[[noreturn]] void fail(const std::string& message) {
+#if ISOMETRY_HAS_EXCEPTIONS
+  throw E(message);
+#else
+  std::fprintf(stderr, "%s\n", message.c_str());
+  std::abort();
+#endif
+}
+
+}  // namespace internal
+}  // namespace math
+}  // namespace ekumen
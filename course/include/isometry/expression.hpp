@@ -0,0 +1,583 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * Opt-in expression templates for Vector3T and Matrix3T arithmetic.
+ *
+ * Wrapping any operand with lazy() turns the whole expression it belongs to
+ * into a tree of lightweight nodes instead of one temporary per operator:
+ *
+ *   const Vector3 p = lazy(rotation) * vector + translation;
+ *
+ * The tree is evaluated one element at a time, in a single pass, when it is
+ * converted to a Vector3T or a Matrix3T. Operators keep the meaning they have
+ * on the plain types: `*` between matrices is element-wise, `*` between a
+ * matrix and a vector is the matrix product. product(), transpose(), dot()
+ * and cross() provide the remaining operations.
+ *
+ * The nodes hold references to the wrapped vectors and matrices, so an
+ * expression must be converted before the end of the full expression it was
+ * built in: do not store it in an `auto` variable. Operands of products and of
+ * cross() which are not plain vectors or matrices are evaluated once into a
+ * value, so that they are not recomputed for every element of the result.
+ */
+namespace expr {
+
+/// \brief Tag base of every vector expression.
+struct VectorExprTag {};
+
+/// \brief Tag base of every matrix expression.
+struct MatrixExprTag {};
+
+/// \brief Base of the vector expression nodes.
+/// \tparam E The node type, which provides `T coeff(int i) const`.
+/// \tparam T Scalar type of the elements.
+template <typename E, typename T>
+class VectorExpr : public VectorExprTag {
+ public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
+  /// \brief Evaluates the expression.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> eval() const {
+    const E& self = static_cast<const E&>(*this);
+    return Vector3T<T>(self.coeff(0), self.coeff(1), self.coeff(2));
+  }
+
+  /// \brief Implicit evaluation, which makes an expression usable wherever a
+  /// Vector3T is.
+  constexpr operator Vector3T<T>() const {  // NOLINT
+    return eval();
+  }
+};
+
+/// \brief Base of the matrix expression nodes.
+/// \tparam E The node type, which provides `T coeff(int row, int col) const`.
+/// \tparam T Scalar type of the elements.
+template <typename E, typename T>
+class MatrixExpr : public MatrixExprTag {
+ public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
+  /// \brief Evaluates the expression.
+  /// \returns A new Matrix3T.
+  constexpr Matrix3T<T> eval() const {
+    const E& self = static_cast<const E&>(*this);
+    return Matrix3T<T>(self.coeff(0, 0), self.coeff(0, 1), self.coeff(0, 2),
+                       self.coeff(1, 0), self.coeff(1, 1), self.coeff(1, 2),
+                       self.coeff(2, 0), self.coeff(2, 1), self.coeff(2, 2));
+  }
+
+  /// \brief Implicit evaluation, which makes an expression usable wherever a
+  /// Matrix3T is.
+  constexpr operator Matrix3T<T>() const {  // NOLINT
+    return eval();
+  }
+};
+
+// Element-wise operations applied by the binary and scalar nodes.
+
+struct Add {
+  template <typename T>
+  static constexpr T apply(const T lhs, const T rhs) {
+    return lhs + rhs;
+  }
+};
+
+struct Sub {
+  template <typename T>
+  static constexpr T apply(const T lhs, const T rhs) {
+    return lhs - rhs;
+  }
+};
+
+struct Mul {
+  template <typename T>
+  static constexpr T apply(const T lhs, const T rhs) {
+    return lhs * rhs;
+  }
+};
+
+struct Div {
+  template <typename T>
+  static constexpr T apply(const T lhs, const T rhs) {
+    return lhs / rhs;
+  }
+};
+
+/// \brief Leaf referencing an existing vector.
+template <typename T>
+class VectorRef : public VectorExpr<VectorRef<T>, T> {
+ public:
+  constexpr explicit VectorRef(const Vector3T<T>& vector) : vector_(vector) {}
+
+  constexpr T coeff(const int i) const { return vector_.at(i); }
+
+ private:
+  const Vector3T<T>& vector_;
+};
+
+/// \brief Leaf holding an evaluated vector.
+template <typename T>
+class VectorValue : public VectorExpr<VectorValue<T>, T> {
+ public:
+  constexpr explicit VectorValue(const Vector3T<T>& vector) : vector_(vector) {}
+
+  constexpr T coeff(const int i) const { return vector_.at(i); }
+
+ private:
+  Vector3T<T> vector_;
+};
+
+/// \brief Leaf referencing an existing matrix.
+template <typename T>
+class MatrixRef : public MatrixExpr<MatrixRef<T>, T> {
+ public:
+  constexpr explicit MatrixRef(const Matrix3T<T>& matrix) : matrix_(matrix) {}
+
+  constexpr T coeff(const int row, const int col) const {
+    return matrix_(row, col);
+  }
+
+ private:
+  const Matrix3T<T>& matrix_;
+};
+
+/// \brief Leaf holding an evaluated matrix.
+template <typename T>
+class MatrixValue : public MatrixExpr<MatrixValue<T>, T> {
+ public:
+  constexpr explicit MatrixValue(const Matrix3T<T>& matrix) : matrix_(matrix) {}
+
+  constexpr T coeff(const int row, const int col) const {
+    return matrix_(row, col);
+  }
+
+ private:
+  Matrix3T<T> matrix_;
+};
+
+/// \brief Element-wise operation between two vector expressions.
+template <typename L, typename R, typename Op>
+class VectorBinary
+    : public VectorExpr<VectorBinary<L, R, Op>, typename L::Scalar> {
+ public:
+  constexpr VectorBinary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+  constexpr typename L::Scalar coeff(const int i) const {
+    return Op::apply(lhs_.coeff(i), rhs_.coeff(i));
+  }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+/// \brief Operation between every element of a vector expression and a
+/// scalar.
+template <typename E, typename Op>
+class VectorScalar
+    : public VectorExpr<VectorScalar<E, Op>, typename E::Scalar> {
+ public:
+  constexpr VectorScalar(const E& expression,
+                         const typename E::Scalar scalar)
+      : expression_(expression), scalar_(scalar) {}
+
+  constexpr typename E::Scalar coeff(const int i) const {
+    return Op::apply(expression_.coeff(i), scalar_);
+  }
+
+ private:
+  E expression_;
+  typename E::Scalar scalar_;
+};
+
+/// \brief Cross product between two vector expressions.
+template <typename L, typename R>
+class VectorCross : public VectorExpr<VectorCross<L, R>, typename L::Scalar> {
+ public:
+  constexpr VectorCross(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+  constexpr typename L::Scalar coeff(const int i) const {
+    return lhs_.coeff((i + 1) % 3) * rhs_.coeff((i + 2) % 3) -
+           lhs_.coeff((i + 2) % 3) * rhs_.coeff((i + 1) % 3);
+  }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+/// \brief Matrix product between a matrix and a column vector expression.
+template <typename M, typename V>
+class MatrixVectorProduct
+    : public VectorExpr<MatrixVectorProduct<M, V>, typename M::Scalar> {
+ public:
+  constexpr MatrixVectorProduct(const M& matrix, const V& vector)
+      : matrix_(matrix), vector_(vector) {}
+
+  constexpr typename M::Scalar coeff(const int i) const {
+    return matrix_.coeff(i, 0) * vector_.coeff(0) +
+           matrix_.coeff(i, 1) * vector_.coeff(1) +
+           matrix_.coeff(i, 2) * vector_.coeff(2);
+  }
+
+ private:
+  M matrix_;
+  V vector_;
+};
+
+/// \brief Element-wise operation between two matrix expressions.
+template <typename L, typename R, typename Op>
+class MatrixBinary
+    : public MatrixExpr<MatrixBinary<L, R, Op>, typename L::Scalar> {
+ public:
+  constexpr MatrixBinary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+  constexpr typename L::Scalar coeff(const int row, const int col) const {
+    return Op::apply(lhs_.coeff(row, col), rhs_.coeff(row, col));
+  }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+/// \brief Operation between every element of a matrix expression and a
+/// scalar.
+template <typename E, typename Op>
+class MatrixScalar
+    : public MatrixExpr<MatrixScalar<E, Op>, typename E::Scalar> {
+ public:
+  constexpr MatrixScalar(const E& expression,
+                         const typename E::Scalar scalar)
+      : expression_(expression), scalar_(scalar) {}
+
+  constexpr typename E::Scalar coeff(const int row, const int col) const {
+    return Op::apply(expression_.coeff(row, col), scalar_);
+  }
+
+ private:
+  E expression_;
+  typename E::Scalar scalar_;
+};
+
+/// \brief Transpose of a matrix expression, a pure index remapping.
+template <typename E>
+class MatrixTranspose
+    : public MatrixExpr<MatrixTranspose<E>, typename E::Scalar> {
+ public:
+  constexpr explicit MatrixTranspose(const E& expression)
+      : expression_(expression) {}
+
+  constexpr typename E::Scalar coeff(const int row, const int col) const {
+    return expression_.coeff(col, row);
+  }
+
+ private:
+  E expression_;
+};
+
+/// \brief Matrix product between two matrix expressions.
+template <typename L, typename R>
+class MatrixProduct
+    : public MatrixExpr<MatrixProduct<L, R>, typename L::Scalar> {
+ public:
+  constexpr MatrixProduct(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+  constexpr typename L::Scalar coeff(const int row, const int col) const {
+    return lhs_.coeff(row, 0) * rhs_.coeff(0, col) +
+           lhs_.coeff(row, 1) * rhs_.coeff(1, col) +
+           lhs_.coeff(row, 2) * rhs_.coeff(2, col);
+  }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+// Type traits used to constrain the operators below, so that they only take
+// part in overload resolution when at least one operand is an expression.
+
+template <typename X>
+struct IsVectorExpr : std::is_base_of<VectorExprTag, X> {};
+
+template <typename X>
+struct IsMatrixExpr : std::is_base_of<MatrixExprTag, X> {};
+
+template <typename X>
+struct IsVector : IsVectorExpr<X> {};
+
+template <typename T>
+struct IsVector<Vector3T<T>> : std::true_type {};
+
+template <typename X>
+struct IsMatrix : IsMatrixExpr<X> {};
+
+template <typename T>
+struct IsMatrix<Matrix3T<T>> : std::true_type {};
+
+template <typename L, typename R>
+struct IsVectorOperation
+    : std::integral_constant<bool, IsVector<L>::value && IsVector<R>::value &&
+                                       (IsVectorExpr<L>::value ||
+                                        IsVectorExpr<R>::value)> {};
+
+template <typename L, typename R>
+struct IsMatrixOperation
+    : std::integral_constant<bool, IsMatrix<L>::value && IsMatrix<R>::value &&
+                                       (IsMatrixExpr<L>::value ||
+                                        IsMatrixExpr<R>::value)> {};
+
+template <typename M, typename V>
+struct IsMatrixVectorOperation
+    : std::integral_constant<bool, IsMatrix<M>::value && IsVector<V>::value &&
+                                       (IsMatrixExpr<M>::value ||
+                                        IsVectorExpr<V>::value)> {};
+
+/// \brief Maps an operand to the node that represents it in a tree: plain
+/// vectors and matrices become references, expressions stay as they are.
+template <typename X>
+struct Node {
+  using type = X;
+  static constexpr const X& make(const X& x) { return x; }
+};
+
+template <typename T>
+struct Node<Vector3T<T>> {
+  using type = VectorRef<T>;
+  static constexpr VectorRef<T> make(const Vector3T<T>& vector) {
+    return VectorRef<T>(vector);
+  }
+};
+
+template <typename T>
+struct Node<Matrix3T<T>> {
+  using type = MatrixRef<T>;
+  static constexpr MatrixRef<T> make(const Matrix3T<T>& matrix) {
+    return MatrixRef<T>(matrix);
+  }
+};
+
+/// \brief Maps the operand of a product or a cross product to the node that
+/// represents it: leaves and transposed leaves, which are cheap to read many
+/// times, are kept and any other expression is evaluated into a value.
+template <typename X>
+struct Operand {
+  using Leaf = typename Node<X>::type;
+  using type = typename std::conditional<
+      IsVectorExpr<Leaf>::value, VectorValue<typename Leaf::Scalar>,
+      MatrixValue<typename Leaf::Scalar>>::type;
+  static constexpr type make(const X& x) { return type(Node<X>::make(x)); }
+};
+
+template <typename T>
+struct Operand<Vector3T<T>> : Node<Vector3T<T>> {};
+
+template <typename T>
+struct Operand<VectorRef<T>> : Node<VectorRef<T>> {};
+
+template <typename T>
+struct Operand<VectorValue<T>> : Node<VectorValue<T>> {};
+
+template <typename T>
+struct Operand<Matrix3T<T>> : Node<Matrix3T<T>> {};
+
+template <typename T>
+struct Operand<MatrixRef<T>> : Node<MatrixRef<T>> {};
+
+template <typename T>
+struct Operand<MatrixValue<T>> : Node<MatrixValue<T>> {};
+
+template <typename T>
+struct Operand<MatrixTranspose<MatrixRef<T>>>
+    : Node<MatrixTranspose<MatrixRef<T>>> {};
+
+template <typename X>
+using NodeType = typename Node<X>::type;
+
+template <typename X>
+using OperandType = typename Operand<X>::type;
+
+/// \brief Starts an expression from a vector.
+/// \param vector Vector to reference, it must outlive the expression.
+template <typename T>
+constexpr VectorRef<T> lazy(const Vector3T<T>& vector) {
+  return VectorRef<T>(vector);
+}
+
+/// \brief Starts an expression from a matrix.
+/// \param matrix Matrix to reference, it must outlive the expression.
+template <typename T>
+constexpr MatrixRef<T> lazy(const Matrix3T<T>& matrix) {
+  return MatrixRef<T>(matrix);
+}
+
+// Temporaries would not outlive the expression that references them.
+template <typename T>
+void lazy(const Vector3T<T>&& vector) = delete;
+template <typename T>
+void lazy(const Matrix3T<T>&& matrix) = delete;
+
+// Vector operators.
+
+template <typename L, typename R,
+          std::enable_if_t<IsVectorOperation<L, R>::value, int> = 0>
+constexpr VectorBinary<NodeType<L>, NodeType<R>, Add> operator+(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsVectorOperation<L, R>::value, int> = 0>
+constexpr VectorBinary<NodeType<L>, NodeType<R>, Sub> operator-(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsVectorOperation<L, R>::value, int> = 0>
+constexpr VectorBinary<NodeType<L>, NodeType<R>, Mul> operator*(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsVectorOperation<L, R>::value, int> = 0>
+constexpr VectorBinary<NodeType<L>, NodeType<R>, Div> operator/(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename E, std::enable_if_t<IsVectorExpr<E>::value, int> = 0>
+constexpr VectorScalar<E, Mul> operator*(const E& lhs,
+                                         const typename E::Scalar scalar) {
+  return {lhs, scalar};
+}
+
+template <typename E, std::enable_if_t<IsVectorExpr<E>::value, int> = 0>
+constexpr VectorScalar<E, Mul> operator*(const typename E::Scalar scalar,
+                                         const E& rhs) {
+  return {rhs, scalar};
+}
+
+template <typename E, std::enable_if_t<IsVectorExpr<E>::value, int> = 0>
+constexpr VectorScalar<E, Div> operator/(const E& lhs,
+                                         const typename E::Scalar scalar) {
+  return {lhs, scalar};
+}
+
+/// \brief Cross product between two vectors or vector expressions.
+template <typename L, typename R,
+          std::enable_if_t<IsVector<L>::value && IsVector<R>::value, int> = 0>
+constexpr VectorCross<OperandType<L>, OperandType<R>> cross(const L& lhs,
+                                                            const R& rhs) {
+  return {Operand<L>::make(lhs), Operand<R>::make(rhs)};
+}
+
+/// \brief Dot product between two vectors or vector expressions.
+template <typename L, typename R,
+          std::enable_if_t<IsVector<L>::value && IsVector<R>::value, int> = 0>
+constexpr typename NodeType<L>::Scalar dot(const L& lhs, const R& rhs) {
+  return Node<L>::make(lhs).coeff(0) * Node<R>::make(rhs).coeff(0) +
+         Node<L>::make(lhs).coeff(1) * Node<R>::make(rhs).coeff(1) +
+         Node<L>::make(lhs).coeff(2) * Node<R>::make(rhs).coeff(2);
+}
+
+// Matrix operators.
+
+template <typename L, typename R,
+          std::enable_if_t<IsMatrixOperation<L, R>::value, int> = 0>
+constexpr MatrixBinary<NodeType<L>, NodeType<R>, Add> operator+(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsMatrixOperation<L, R>::value, int> = 0>
+constexpr MatrixBinary<NodeType<L>, NodeType<R>, Sub> operator-(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsMatrixOperation<L, R>::value, int> = 0>
+constexpr MatrixBinary<NodeType<L>, NodeType<R>, Mul> operator*(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename L, typename R,
+          std::enable_if_t<IsMatrixOperation<L, R>::value, int> = 0>
+constexpr MatrixBinary<NodeType<L>, NodeType<R>, Div> operator/(
+    const L& lhs, const R& rhs) {
+  return {Node<L>::make(lhs), Node<R>::make(rhs)};
+}
+
+template <typename E, std::enable_if_t<IsMatrixExpr<E>::value, int> = 0>
+constexpr MatrixScalar<E, Mul> operator*(const E& lhs,
+                                         const typename E::Scalar scalar) {
+  return {lhs, scalar};
+}
+
+template <typename E, std::enable_if_t<IsMatrixExpr<E>::value, int> = 0>
+constexpr MatrixScalar<E, Mul> operator*(const typename E::Scalar scalar,
+                                         const E& rhs) {
+  return {rhs, scalar};
+}
+
+template <typename E, std::enable_if_t<IsMatrixExpr<E>::value, int> = 0>
+constexpr MatrixScalar<E, Div> operator/(const E& lhs,
+                                         const typename E::Scalar scalar) {
+  return {lhs, scalar};
+}
+
+template <typename M, typename V,
+          std::enable_if_t<IsMatrixVectorOperation<M, V>::value, int> = 0>
+constexpr MatrixVectorProduct<OperandType<M>, OperandType<V>> operator*(
+    const M& matrix, const V& vector) {
+  return {Operand<M>::make(matrix), Operand<V>::make(vector)};
+}
+
+/// \brief Matrix product between a matrix and a column vector, either of
+/// which may be an expression.
+template <typename M, typename V,
+          std::enable_if_t<IsMatrix<M>::value && IsVector<V>::value, int> = 0>
+constexpr MatrixVectorProduct<OperandType<M>, OperandType<V>> product(
+    const M& matrix, const V& vector) {
+  return {Operand<M>::make(matrix), Operand<V>::make(vector)};
+}
+
+/// \brief Matrix product between two matrices, either of which may be an
+/// expression.
+template <typename L, typename R,
+          std::enable_if_t<IsMatrix<L>::value && IsMatrix<R>::value, int> = 0>
+constexpr MatrixProduct<OperandType<L>, OperandType<R>> product(const L& lhs,
+                                                                const R& rhs) {
+  return {Operand<L>::make(lhs), Operand<R>::make(rhs)};
+}
+
+/// \brief Transpose of a matrix or a matrix expression.
+template <typename M, std::enable_if_t<IsMatrix<M>::value, int> = 0>
+constexpr MatrixTranspose<NodeType<M>> transpose(const M& matrix) {
+  return MatrixTranspose<NodeType<M>>(Node<M>::make(matrix));
+}
+
+}  // namespace expr
+}  // namespace math
+}  // namespace ekumen
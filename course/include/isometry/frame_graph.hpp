@@ -0,0 +1,199 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to represent a tree of named coordinate frames, where
+ * every frame but the roots is linked to its parent by an Isometry.
+ *
+ * Frames are added once and then referred to either by name or, on hot paths,
+ * by the FrameId returned when they were added. Lookups walk from both frames
+ * up to their closest common ancestor, so they cost O(depth) compositions, and
+ * they never allocate memory. Names are resolved by hashing them, and every
+ * member taking a name also takes a character array, so that a call with
+ * literals like lookup("camera_depth_optical_frame", "map") does not build
+ * std::string temporaries, which allocate for names longer than 15
+ * characters. Pointers are not accepted as names, which keeps a literal 0
+ * meaning the first FrameId.
+ */
+class FrameGraph {
+ public:
+  /// \brief Identifier of a frame, valid for the lifetime of the graph.
+  using FrameId = std::size_t;
+
+  /// \brief Parent of the root frames.
+  static constexpr FrameId kNoParent{std::numeric_limits<FrameId>::max()};
+
+  /// \brief Adds a root frame.
+  /// \param name Frame name.
+  /// \returns The identifier of the new frame.
+  /// \throw std::invalid_argument When a frame named `name` already exists.
+  FrameId addFrame(const std::string& name);
+
+  /// \brief Adds a frame as the child of an existing one.
+  /// \param name Frame name.
+  /// \param parent Parent frame.
+  /// \param transform Transform from the new frame to its parent, it maps
+  /// coordinates in `name` to coordinates in `parent`.
+  /// \returns The identifier of the new frame.
+  /// \throw std::invalid_argument When a frame named `name` already exists.
+  /// \throw std::out_of_range When `parent` does not exist.
+  FrameId addFrame(const std::string& name, const FrameId parent,
+                   const Isometry& transform);
+
+  /// \brief Adds a frame as the child of an existing one.
+  /// \see addFrame(const std::string&, FrameId, const Isometry&)
+  FrameId addFrame(const std::string& name, const std::string& parent,
+                   const Isometry& transform);
+
+  /// \brief Replaces the transform from a frame to its parent.
+  /// \param frame Frame to update, which must not be a root.
+  /// \param transform New transform from `frame` to its parent.
+  /// \throw std::out_of_range When `frame` does not exist.
+  /// \throw std::invalid_argument When `frame` is a root.
+  void setTransform(const FrameId frame, const Isometry& transform);
+
+  /// \brief Replaces the transform from a frame to its parent.
+  /// \see setTransform(FrameId, const Isometry&)
+  void setTransform(const std::string& frame, const Isometry& transform);
+
+  /// \brief Replaces the transform from a frame to its parent.
+  /// \see setTransform(FrameId, const Isometry&)
+  template <std::size_t N>
+  void setTransform(const char (&frame)[N], const Isometry& transform);
+
+  /// \brief Computes the transform between two frames.
+  /// \param source Frame the coordinates are expressed in.
+  /// \param target Frame to express the coordinates in.
+  /// \returns The transform that maps coordinates in `source` to coordinates
+  /// in `target`.
+  /// \throw std::out_of_range When either frame does not exist.
+  /// \throw std::runtime_error When the frames are in different trees.
+  Isometry lookup(const FrameId source, const FrameId target) const;
+
+  /// \brief Computes the transform between two frames.
+  /// \see lookup(FrameId, FrameId)
+  Isometry lookup(const std::string& source, const std::string& target) const;
+
+  /// \brief Computes the transform between two frames.
+  /// \see lookup(FrameId, FrameId)
+  template <std::size_t N, std::size_t M>
+  Isometry lookup(const char (&source)[N], const char (&target)[M]) const;
+
+  /// \brief Identifier of a frame.
+  /// \throw std::out_of_range When no frame is named `name`.
+  FrameId id(const std::string& name) const;
+
+  /// \brief Identifier of a frame.
+  /// \see id(const std::string&)
+  template <std::size_t N>
+  FrameId id(const char (&name)[N]) const;
+
+  /// \brief Whether a frame named `name` exists.
+  bool contains(const std::string& name) const;
+
+  /// \brief Whether a frame named `name` exists.
+  template <std::size_t N>
+  bool contains(const char (&name)[N]) const;
+
+  /// \brief Name of a frame.
+  /// \throw std::out_of_range When `frame` does not exist.
+  const std::string& name(const FrameId frame) const;
+
+  /// \brief Parent of a frame, kNoParent for roots.
+  /// \throw std::out_of_range When `frame` does not exist.
+  FrameId parent(const FrameId frame) const;
+
+  /// \brief Transform from a frame to its parent, the identity for roots.
+  /// \throw std::out_of_range When `frame` does not exist.
+  const Isometry& transform(const FrameId frame) const;
+
+  /// \brief Number of frames.
+  std::size_t size() const;
+
+ private:
+  // Data read by lookups, kept apart from the names so that walking the tree
+  // touches as few cache lines as possible.
+  struct Node {
+    // Transform from this frame to its parent.
+    Isometry transform;
+    // Parent frame, kNoParent for roots.
+    FrameId parent;
+    // Number of edges between this frame and its root.
+    std::size_t depth;
+  };
+
+  /// \brief Length of the name in an array of `capacity` characters, up to
+  /// its first null character.
+  static std::size_t nameLength(const char* name, const std::size_t capacity);
+
+  /// \brief Throws std::out_of_range if `frame` does not exist.
+  void checkFrame(const FrameId frame) const;
+
+  /// \brief Frame named by the `length` characters at `name`, kNoParent when
+  /// there is none.
+  FrameId find(const char* name, const std::size_t length) const;
+
+  /// \brief Identifier of a frame, throwing std::out_of_range when there is
+  /// none.
+  FrameId findOrFail(const char* name, const std::size_t length) const;
+
+  /// \brief Adds a frame after its arguments have been validated.
+  FrameId insert(const std::string& name, const FrameId parent,
+                 const Isometry& transform, const std::size_t depth);
+
+  /// \brief Stores `frame` in the first empty slot from the hash of its name.
+  void place(const FrameId frame);
+
+  std::vector<Node> nodes_;
+  std::vector<std::string> names_;
+  // Open addressing hash table of the frames by name, with linear probing. Its
+  // size is a power of two at least twice the number of frames, and empty
+  // slots hold kNoParent.
+  std::vector<FrameId> slots_;
+};
+
+template <std::size_t N>
+void FrameGraph::setTransform(const char (&frame)[N],
+                              const Isometry& transform) {
+  setTransform(id(frame), transform);
+}
+
+template <std::size_t N, std::size_t M>
+Isometry FrameGraph::lookup(const char (&source)[N],
+                            const char (&target)[M]) const {
+  return lookup(id(source), id(target));
+}
+
+template <std::size_t N>
+FrameGraph::FrameId FrameGraph::id(const char (&name)[N]) const {
+  return findOrFail(name, nameLength(name, N));
+}
+
+template <std::size_t N>
+bool FrameGraph::contains(const char (&name)[N]) const {
+  return find(name, nameLength(name, N)) != kNoParent;
+}
+
+inline std::size_t FrameGraph::nameLength(const char* name,
+                                          const std::size_t capacity) {
+  return std::find(name, name + capacity, '\0') - name;
+}
+
+}  // namespace math
+}  // namespace ekumen
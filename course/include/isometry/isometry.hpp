@@ -7,111 +7,562 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
-#include <iostream>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <isometry/matrix3.hpp>
+#include <isometry/twist.hpp>
 #include <isometry/vector3.hpp>
 
 namespace ekumen {
 
 namespace math {
 
+template <typename T>
+class PointCloudT;
+
+template <typename T>
+class PointViewT;
+
+namespace internal {
+
+/// \brief Batch transform kernel over interleaved x, y, z coordinates.
+///
+/// Compiled in the isometry library for float and double, once per
+/// SimdLevel, and runs the copy of activeSimdLevel().
+/// \param rotation Rotation to apply.
+/// \param translation Translation to apply.
+/// \param input Pointer to the first of `3 * count` scalars.
+/// \param count Number of points.
+/// \param output Pointer to storage for `3 * count` scalars, either equal to
+/// `input` or not overlapping it.
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const T* input,
+                     const std::size_t count, T* output);
+
+/// \brief Batch transform kernel over separate x, y and z arrays.
+///
+/// Compiled in the isometry library for float and double, once per
+/// SimdLevel, and runs the copy of activeSimdLevel().
+/// \param rotation Rotation to apply.
+/// \param translation Translation to apply.
+/// \param x Pointer to the first of `count` x coordinates.
+/// \param y Pointer to the first of `count` y coordinates.
+/// \param z Pointer to the first of `count` z coordinates.
+/// \param count Number of points.
+/// \param out_x Storage for `count` x coordinates.
+/// \param out_y Storage for `count` y coordinates.
+/// \param out_z Storage for `count` z coordinates.
+/// \pre Every array is aligned to PointCloudT<T>::kAlignment bytes and each
+/// output array is either equal to its input array or does not overlap it.
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const T* x, const T* y,
+                     const T* z, const std::size_t count, T* out_x, T* out_y,
+                     T* out_z);
+
+/// \brief Batch transform kernel over x, y, z coordinates stored at a fixed
+/// stride, with no alignment requirement.
+///
+/// Compiled in the isometry library for float and double, once per
+/// SimdLevel, and runs the copy of activeSimdLevel().
+/// \param rotation Rotation to apply.
+/// \param translation Translation to apply.
+/// \param input Pointer to the x coordinate of the first point.
+/// \param stride Distance in bytes between consecutive points of `input`.
+/// \param count Number of points.
+/// \param output Pointer to storage for `3 * count` interleaved scalars, not
+/// overlapping `input`.
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const std::uint8_t* input,
+                     const std::size_t stride, const std::size_t count,
+                     T* output);
+
+}  // namespace internal
+
 /**
  * This class is used to represent isometric transformations among vectors and
  * matrices.
+ *
+ * It is explicitly instantiated for double (Isometry) and float (Isometryf).
+ * The batch transforms accept points of either scalar type, so a double
+ * precision pose can be applied to float points. In that case the pose is
+ * rounded to float once per call and the points are processed at float
+ * SIMD width.
+ *
+ * Construction from a translation and a rotation matrix, composition and
+ * inversion are constexpr, so fixed calibrations such as sensor extrinsics
+ * can be computed at compile time and stored as read-only data:
+ *
+ *     constexpr Isometry kBaseToLidar{
+ *         Vector3(0.2, 0., 1.1),
+ *         Quaternion(0.9238795, 0., 0., 0.3826834).toRotationMatrix()};
+ *     constexpr Isometry kLidarToBase = kBaseToLidar.inverse();
+ *
+ * The builders that take angles, like fromEulerAngles(), need std::sin and
+ * std::cos, which are not constexpr, so they run when called.
  */
-class Isometry {
+template <typename T>
+class IsometryT {
  public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
   /// \brief Default constructor
-  Isometry();
+  constexpr IsometryT() noexcept;
 
   /// \brief Constructs an Isometry object from a translation vector and a
   /// rotation matrix.
   /// \param translation A translation vector.
   /// \param rotation A rotation matrix.
-  Isometry(const Vector3& translation, const Matrix3& rotation);
+  constexpr IsometryT(const Vector3T<T>& translation,
+                      const Matrix3T<T>& rotation) noexcept;
 
   /// \brief Constructs an Isometry object based on an existing instance.
-  /// \param obj A reference to an existing Isometry object.
-  Isometry(const Isometry& obj);
+  ///
+  /// Copies are trivial, so arrays of isometries are copied and relocated
+  /// with memcpy.
+  IsometryT(const IsometryT&) = default;
+
+  /// \brief Converting constructor from an isometry of another scalar type.
+  template <typename U>
+  constexpr explicit IsometryT(const IsometryT<U>& isometry) noexcept;
 
   /// \brief Creates an Isometry object from within a translation vector.
   /// \param vector A translation vector.
   /// \returns An new Isometry object.
-  static Isometry fromTranslation(const Vector3& vector);
+  static constexpr IsometryT fromTranslation(
+      const Vector3T<T>& vector) noexcept;
 
   /// \brief Creates an Isometry object from a rotation around a vector.
   /// \param vector Axis vector.
   /// \param radians Number of radians to rotate along the given vector.
   /// \returns An new Isometry object.
-  static Isometry rotateAround(const Vector3& vector, const double radians);
+  static IsometryT rotateAround(const Vector3T<T>& vector,
+                                const T radians) noexcept;
+
+  /// \brief Creates an Isometry object from a rotation around a unit vector,
+  /// skipping the normalization done by rotateAround().
+  /// \param axis Axis vector, of norm 1.
+  /// \param radians Number of radians to rotate along the given vector.
+  /// \returns An new Isometry object.
+  static IsometryT fromUnitAxisAngle(const Vector3T<T>& axis,
+                                     const T radians) noexcept;
 
   /// \brief Creates an Isometry object from given euler angles.
+  ///
+  /// The rotation is the product of the rotations around x by `roll`, around
+  /// y by `pitch` and around z by `yaw`, in that order.
   /// \param roll Roll angle in radians.
   /// \param pitch Pitch angle in radians.
   /// \param yaw Yaw angle in radians.
   /// \returns An new Isometry object.
-  static Isometry fromEulerAngles(const double roll, const double pitch,
-                                  const double yaw);
+  static IsometryT fromEulerAngles(const T roll, const T pitch,
+                                   const T yaw) noexcept;
+
+  /// \brief Creates Isometry objects from arrays of euler angles, as
+  /// fromEulerAngles() does for each of them.
+  ///
+  /// The sines and cosines are computed by a polynomial kernel that the
+  /// compiler vectorizes. It matches std::sin and std::cos to within a few
+  /// ulps for angles up to 1e5 radians, and larger angles go through them.
+  /// \param roll Pointer to the first of `count` roll angles.
+  /// \param pitch Pointer to the first of `count` pitch angles.
+  /// \param yaw Pointer to the first of `count` yaw angles.
+  /// \param count Number of isometries.
+  /// \param output Storage for `count` isometries.
+  static void fromEulerAngles(const T* roll, const T* pitch, const T* yaw,
+                              const std::size_t count,
+                              IsometryT* output) noexcept;
+
+  /// \brief Creates Isometry objects from arrays of rotations around unit
+  /// vectors, as fromUnitAxisAngle() does for each of them.
+  /// \see fromEulerAngles(const T*, const T*, const T*, std::size_t,
+  /// IsometryT*)
+  /// \param axes Pointer to the first of `count` axis vectors, of norm 1.
+  /// \param radians Pointer to the first of `count` angles.
+  /// \param count Number of isometries.
+  /// \param output Storage for `count` isometries.
+  static void fromUnitAxisAngle(const Vector3T<T>* axes, const T* radians,
+                                const std::size_t count,
+                                IsometryT* output) noexcept;
+
+  /// \brief Exponential map of SE(3), the isometry reached by moving with a
+  /// constant twist for a unit of time.
+  ///
+  /// The translation follows the screw motion of the twist rather than being
+  /// `twist.linear` itself. Small angles use Taylor expansions, so the result
+  /// is accurate down to the null rotation.
+  /// \param twist Twist to integrate.
+  /// \returns A new Isometry object.
+  static IsometryT exp(const TwistT<T>& twist) noexcept;
+
+  /// \brief Exponential map of SE(3) of an array of twists, with the sines
+  /// and cosines computed by the kernel of fromEulerAngles(const T*,
+  /// const T*, const T*, std::size_t, IsometryT*).
+  /// \param twists Pointer to the first of `count` twists.
+  /// \param count Number of twists.
+  /// \param output Storage for `count` isometries.
+  static void exp(const TwistT<T>* twists, const std::size_t count,
+                  IsometryT* output) noexcept;
+
+  /// \brief Logarithm map of SE(3), the inverse of exp().
+  /// \returns The twist whose rotation angle is in [0, pi].
+  /// \pre The rotation is orthonormal.
+  TwistT<T> log() const noexcept;
+
+  /// \brief Logarithm map of SE(3) of an array of isometries, with the sines
+  /// and cosines computed by the same kernel as the batch exp().
+  /// \param isometries Pointer to the first of `count` isometries.
+  /// \param count Number of isometries.
+  /// \param output Storage for `count` twists.
+  static void log(const IsometryT* isometries, const std::size_t count,
+                  TwistT<T>* output) noexcept;
 
   /// \brief Applies an isometric transformation to a given vector.
-  /// \param vector A Vector3.
-  /// \returns A new Vector3.
-  Vector3 transform(const Vector3& vector) const;
+  /// \param vector A Vector3T.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> transform(const Vector3T<T>& vector) const noexcept;
+
+  /// \brief Applies an isometric transformation to a range of vectors.
+  /// \param input Pointer to the first of `count` contiguous vectors.
+  /// \param count Number of vectors to transform.
+  /// \param output Pointer to storage for `count` vectors. It may be equal to
+  /// `input`, but the two ranges must not partially overlap.
+  template <typename P>
+  inline void transform(const Vector3T<P>* input, const std::size_t count,
+                        Vector3T<P>* output) const noexcept;
+
+  /// \brief Applies an isometric transformation in place to a range of
+  /// vectors.
+  /// \param points Pointer to the first of `count` contiguous vectors.
+  /// \param count Number of vectors to transform.
+  template <typename P>
+  inline void transform(Vector3T<P>* points,
+                        const std::size_t count) const noexcept;
+
+  /// \brief Applies an isometric transformation to a range of interleaved
+  /// x, y, z coordinates.
+  /// \param input Pointer to the first of `3 * count` scalars.
+  /// \param count Number of points to transform.
+  /// \param output Pointer to storage for `3 * count` scalars. It may be equal
+  /// to `input`, but the two ranges must not partially overlap.
+  template <typename P>
+  inline void transform(const P* input, const std::size_t count,
+                        P* output) const noexcept;
+
+  /// \brief Applies an isometric transformation in place to a range of
+  /// interleaved x, y, z coordinates.
+  /// \param xyz Pointer to the first of `3 * count` scalars.
+  /// \param count Number of points to transform.
+  template <typename P>
+  inline void transform(P* xyz, const std::size_t count) const noexcept;
+
+  /// \brief Applies an isometric transformation to a point cloud.
+  /// \param input Cloud to transform.
+  /// \param output Cloud to write the result to, resized to match `input`.
+  /// It may be the same object as `input`.
+  template <typename P>
+  inline void transform(const PointCloudT<P>& input,
+                        PointCloudT<P>* output) const;
+
+  /// \brief Applies an isometric transformation in place to a point cloud.
+  /// \param cloud Cloud to transform.
+  template <typename P>
+  inline void transform(PointCloudT<P>* cloud) const;
+
+  /// \brief Applies an isometric transformation to points read in place,
+  /// for instance from a file mapped in memory.
+  /// \param input View of the points to transform.
+  /// \param output Pointer to storage for `input.size()` vectors, not
+  /// overlapping the viewed buffer.
+  template <typename P>
+  inline void transform(const PointViewT<P>& input,
+                        Vector3T<P>* output) const noexcept;
 
   /// \brief Translation getter.
-  Vector3& translation();
+  constexpr Vector3T<T>& translation() noexcept;
 
   /// \brief Const implementation of the translation getter.
-  const Vector3& translation() const;
+  constexpr const Vector3T<T>& translation() const noexcept;
 
   /// \brief Rotation getter.
-  Matrix3& rotation();
+  constexpr Matrix3T<T>& rotation() noexcept;
 
   /// \brief Const implementation of the rotation getter.
-  const Matrix3& rotation() const;
+  constexpr const Matrix3T<T>& rotation() const noexcept;
 
   /// \brief Calculates the inverse of the current Isometry.
+  ///
+  /// The rotation is assumed to be orthonormal, so the inverse is built from
+  /// its transpose as [R^T, -R^T t] and no determinant is computed.
   /// \returns A new Isometry object.
-  Isometry inverse() const;
+  constexpr IsometryT inverse() const noexcept;
+
+  /// \brief Applies the inverse isometric transformation to a given vector,
+  /// without building the inverse Isometry.
+  ///
+  /// The rotation is assumed to be orthonormal, the result is R^T (v - t).
+  /// \param vector A Vector3T.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> inverseTransform(
+      const Vector3T<T>& vector) const noexcept;
 
   /// \brief Calculates a new Isometry based on two others.
   /// \param isometry Isometry to compose with.
   /// \returns The newly composed Isometry object.
-  Isometry compose(const Isometry& isometry) const;
+  constexpr IsometryT compose(const IsometryT& isometry) const noexcept;
 
-  /// \brief Assignement operator.
-  Isometry& operator=(const Isometry& isometry);
+  /// \brief Assignement operator, trivial like the copy constructor.
+  IsometryT& operator=(const IsometryT&) = default;
 
   /// \brief Equality operator.
-  bool operator==(const Isometry& isometry) const;
+  bool operator==(const IsometryT& isometry) const;
 
   /// \brief Product-equal operator.
-  Isometry& operator*=(const Isometry& isometry);
+  constexpr IsometryT& operator*=(const IsometryT& isometry) noexcept;
 
   /// \brief Product operator between Isometry and vector.
-  /// \returns A new Vector3.
-  Vector3 operator*(const Vector3& vector) const;
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> operator*(const Vector3T<T>& vector) const noexcept;
 
   /// \brief Product operator.
   /// \returns A new Isometry.
-  Isometry operator*(const Isometry& isometry) const;
+  constexpr IsometryT operator*(const IsometryT& isometry) const noexcept;
 
  private:
+  /// \brief Composition kernel shared by compose(), operator*() and
+  /// operator*=().
+  ///
+  /// Computes lhs * rhs as [Ra Rb, Ra tb + ta] with 27 multiply-adds for the
+  /// rotation and 9 for the translation, straight into the returned object.
+  /// \param lhs Left hand side isometry.
+  /// \param rhs Right hand side isometry.
+  /// \returns The composed isometry.
+  static constexpr IsometryT composed(const IsometryT& lhs,
+                                      const IsometryT& rhs) noexcept;
+
+  /// \brief Exponential map kernel shared by the scalar and batch exp().
+  /// \param twist Twist to integrate.
+  /// \param theta2 Squared rotation angle of the twist.
+  /// \param sine Sine of the rotation angle, unused for small angles.
+  /// \param cosine Cosine of the rotation angle, unused for small angles.
+  static IsometryT expMap(const TwistT<T>& twist, const T theta2,
+                          const T sine, const T cosine) noexcept;
+
+  /// \brief Logarithm map kernel shared by the scalar and batch log().
+  /// \param w Logarithm of the rotation.
+  /// \param theta2 Squared rotation angle.
+  /// \param sine Sine of the rotation angle, unused for small angles.
+  /// \param cosine Cosine of the rotation angle, unused for small angles.
+  TwistT<T> logMap(const Vector3T<T>& w, const T theta2, const T sine,
+                   const T cosine) const noexcept;
+
   /// \brief Rotation matrix.
-  Matrix3 rotation_;
+  Matrix3T<T> rotation_;
 
   /// \brief Translation vector.
-  Vector3 translation_;
+  Vector3T<T> translation_;
 };
 
+/// \brief Isometry of doubles.
+using Isometry = IsometryT<double>;
+
+/// \brief Isometry of floats.
+using Isometryf = IsometryT<float>;
+
+// Trivially copyable and standard layout like Vector3T, which requires the
+// copy constructor and assignment to stay defaulted.
+static_assert(std::is_trivially_copyable<Isometry>::value &&
+                  std::is_trivially_copyable<Isometryf>::value,
+              "IsometryT must be trivially copyable");
+static_assert(std::is_standard_layout<Isometry>::value &&
+                  std::is_standard_layout<Isometryf>::value,
+              "IsometryT must be standard layout");
+
 /// \brief Free function implementation of the output stream operator.
 /// \param os ToDo.
 /// \param isometry ToDo.
-std::ostream& operator<<(std::ostream& os, const Isometry& isometry);
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const IsometryT<T>& isometry);
+
+// Inline implementations of the hot paths, kept in the header so that callers
+// in other translation units can inline them.
+
+template <typename T>
+constexpr IsometryT<T>::IsometryT() noexcept : rotation_(), translation_() {}
+
+template <typename T>
+constexpr IsometryT<T>::IsometryT(const Vector3T<T>& translation,
+                                  const Matrix3T<T>& rotation) noexcept
+    : rotation_(rotation), translation_(translation) {}
+
+template <typename T>
+template <typename U>
+constexpr IsometryT<T>::IsometryT(const IsometryT<U>& isometry) noexcept
+    : rotation_(isometry.rotation()), translation_(isometry.translation()) {}
+
+template <typename T>
+constexpr IsometryT<T> IsometryT<T>::fromTranslation(
+    const Vector3T<T>& vector) noexcept {
+  return IsometryT{vector, Matrix3T<T>::kIdentity};
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryT<T>::transform(
+    const Vector3T<T>& vector) const noexcept {
+  return rotation_ * vector + translation_;
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(const Vector3T<P>* input,
+                                    const std::size_t count,
+                                    Vector3T<P>* output) const noexcept {
+  transform(reinterpret_cast<const P*>(input), count,
+            reinterpret_cast<P*>(output));
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(Vector3T<P>* points,
+                                    const std::size_t count) const noexcept {
+  transform(points, count, points);
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(const P* input, const std::size_t count,
+                                    P* output) const noexcept {
+  internal::transformPoints(Matrix3T<P>(rotation_), Vector3T<P>(translation_),
+                            input, count, output);
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(P* xyz,
+                                    const std::size_t count) const noexcept {
+  transform(xyz, count, xyz);
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(const PointCloudT<P>& input,
+                                    PointCloudT<P>* output) const {
+  output->resize(input.size());
+  internal::transformPoints(Matrix3T<P>(rotation_), Vector3T<P>(translation_),
+                            input.x(), input.y(), input.z(), input.size(),
+                            output->x(), output->y(), output->z());
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(PointCloudT<P>* cloud) const {
+  transform(*cloud, cloud);
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryT<T>::transform(const PointViewT<P>& input,
+                                    Vector3T<P>* output) const noexcept {
+  internal::transformPoints(Matrix3T<P>(rotation_), Vector3T<P>(translation_),
+                            input.data(), input.stride(), input.size(),
+                            reinterpret_cast<P*>(output));
+}
+
+template <typename T>
+constexpr Vector3T<T>& IsometryT<T>::translation() noexcept {
+  return translation_;
+}
+
+template <typename T>
+constexpr const Vector3T<T>& IsometryT<T>::translation() const noexcept {
+  return translation_;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& IsometryT<T>::rotation() noexcept {
+  return rotation_;
+}
+
+template <typename T>
+constexpr const Matrix3T<T>& IsometryT<T>::rotation() const noexcept {
+  return rotation_;
+}
+
+template <typename T>
+constexpr IsometryT<T> IsometryT<T>::inverse() const noexcept {
+  return IsometryT(T{-1} * rotation_.transposeProduct(translation_),
+                   rotation_.transpose());
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryT<T>::inverseTransform(
+    const Vector3T<T>& vector) const noexcept {
+  return rotation_.transposeProduct(vector - translation_);
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryT<T>::operator*(
+    const Vector3T<T>& vector) const noexcept {
+  return rotation_.product(vector) + translation_;
+}
+
+template <typename T>
+constexpr IsometryT<T> IsometryT<T>::composed(const IsometryT& lhs,
+                                             const IsometryT& rhs) noexcept {
+  const T* ra = lhs.rotation_.data();
+  const T* ta = lhs.translation_.data();
+  const T* rb = rhs.rotation_.data();
+  const T* tb = rhs.translation_.data();
+  IsometryT result;
+  T* r = result.rotation_.data();
+  T* t = result.translation_.data();
+  for (int i = 0; i < 3; ++i) {
+    const T a0 = ra[3 * i];
+    const T a1 = ra[3 * i + 1];
+    const T a2 = ra[3 * i + 2];
+    r[3 * i] = a0 * rb[0] + a1 * rb[3] + a2 * rb[6];
+    r[3 * i + 1] = a0 * rb[1] + a1 * rb[4] + a2 * rb[7];
+    r[3 * i + 2] = a0 * rb[2] + a1 * rb[5] + a2 * rb[8];
+    t[i] = a0 * tb[0] + a1 * tb[1] + a2 * tb[2] + ta[i];
+  }
+  return result;
+}
+
+template <typename T>
+constexpr IsometryT<T> IsometryT<T>::compose(
+    const IsometryT& isometry) const noexcept {
+  return composed(*this, isometry);
+}
+
+template <typename T>
+constexpr IsometryT<T>& IsometryT<T>::operator*=(
+    const IsometryT& isometry) noexcept {
+  *this = composed(*this, isometry);
+  return *this;
+}
+
+template <typename T>
+constexpr IsometryT<T> IsometryT<T>::operator*(
+    const IsometryT& isometry) const noexcept {
+  return composed(*this, isometry);
+}
+
+// The non-inline members are compiled once in the isometry library.
+extern template class IsometryT<double>;
+extern template class IsometryT<float>;
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const IsometryT<double>& isometry);
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const IsometryT<float>& isometry);
 
 }  // namespace math
 }  // namespace ekumen
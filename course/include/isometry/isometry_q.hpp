@@ -0,0 +1,277 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+#include <isometry/isometry.hpp>
+#include <isometry/quaternion.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to represent isometric transformations as a unit
+ * quaternion plus a translation vector.
+ *
+ * It holds 7 scalars instead of the 12 of Isometry (56 bytes instead of 96
+ * with doubles) and composes with a Hamilton product instead of a 3x3 matrix
+ * product, which makes it the better fit to store many poses or to chain
+ * many compositions. Single point transforms are more expensive than with
+ * Isometry, so batch transforms convert the rotation to a matrix once and use
+ * the Isometry kernels.
+ *
+ * It is explicitly instantiated for double (IsometryQ) and float (IsometryQf).
+ */
+template <typename T>
+class IsometryQT {
+ public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
+  /// \brief Default constructor, creates the identity transformation.
+  constexpr IsometryQT();
+
+  /// \brief Constructs an IsometryQ object from a translation vector and a
+  /// rotation quaternion.
+  /// \param translation A translation vector.
+  /// \param rotation A unit quaternion.
+  constexpr IsometryQT(const Vector3T<T>& translation,
+                       const QuaternionT<T>& rotation);
+
+  /// \brief Constructs an IsometryQ object from an Isometry.
+  /// \param isometry An isometry with an orthonormal rotation.
+  explicit IsometryQT(const IsometryT<T>& isometry);
+
+  /// \brief Converting constructor from an isometry of another scalar type.
+  template <typename U>
+  constexpr explicit IsometryQT(const IsometryQT<U>& isometry);
+
+  /// \brief Creates an IsometryQ object from within a translation vector.
+  /// \param vector A translation vector.
+  /// \returns An new IsometryQ object.
+  static IsometryQT fromTranslation(const Vector3T<T>& vector);
+
+  /// \brief Creates an IsometryQ object from a rotation around a vector.
+  /// \param vector Axis vector.
+  /// \param radians Number of radians to rotate along the given vector.
+  /// \returns An new IsometryQ object.
+  static IsometryQT rotateAround(const Vector3T<T>& vector, const T radians);
+
+  /// \brief Creates an IsometryQ object from given euler angles, with the
+  /// same convention as Isometry::fromEulerAngles().
+  /// \param roll Roll angle in radians.
+  /// \param pitch Pitch angle in radians.
+  /// \param yaw Yaw angle in radians.
+  /// \returns An new IsometryQ object.
+  static IsometryQT fromEulerAngles(const T roll, const T pitch, const T yaw);
+
+  /// \brief Converts this transformation to an Isometry.
+  /// \returns A new Isometry with the equivalent rotation matrix.
+  inline IsometryT<T> toIsometry() const;
+
+  /// \brief Applies an isometric transformation to a given vector.
+  /// \param vector A Vector3T.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> transform(const Vector3T<T>& vector) const;
+
+  /// \brief Applies an isometric transformation to a range of vectors.
+  /// \see IsometryT::transform()
+  template <typename P>
+  inline void transform(const Vector3T<P>* input, const std::size_t count,
+                        Vector3T<P>* output) const;
+
+  /// \brief Applies an isometric transformation to a point cloud.
+  /// \see IsometryT::transform()
+  template <typename P>
+  inline void transform(const PointCloudT<P>& input,
+                        PointCloudT<P>* output) const;
+
+  /// \brief Applies the inverse isometric transformation to a given vector,
+  /// without building the inverse IsometryQ.
+  /// \param vector A Vector3T.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> inverseTransform(const Vector3T<T>& vector) const;
+
+  /// \brief Calculates the inverse of the current IsometryQ as
+  /// [q*, -(q* t)].
+  /// \returns A new IsometryQ object.
+  constexpr IsometryQT inverse() const;
+
+  /// \brief Calculates a new IsometryQ based on two others.
+  /// \param isometry IsometryQ to compose with.
+  /// \returns The newly composed IsometryQ object.
+  constexpr IsometryQT compose(const IsometryQT& isometry) const;
+
+  /// \brief Product-equal operator.
+  constexpr IsometryQT& operator*=(const IsometryQT& isometry);
+
+  /// \brief Product operator between IsometryQ and vector.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> operator*(const Vector3T<T>& vector) const;
+
+  /// \brief Product operator.
+  /// \returns A new IsometryQ.
+  constexpr IsometryQT operator*(const IsometryQT& isometry) const;
+
+  /// \brief Equality operator.
+  bool operator==(const IsometryQT& isometry) const;
+
+  /// \brief Non-equality operator.
+  bool operator!=(const IsometryQT& isometry) const;
+
+  /// \brief Translation getter.
+  constexpr Vector3T<T>& translation();
+
+  /// \brief Const implementation of the translation getter.
+  constexpr const Vector3T<T>& translation() const;
+
+  /// \brief Rotation getter.
+  constexpr QuaternionT<T>& rotation();
+
+  /// \brief Const implementation of the rotation getter.
+  constexpr const QuaternionT<T>& rotation() const;
+
+ private:
+  /// \brief Translation vector.
+  Vector3T<T> translation_;
+
+  /// \brief Rotation quaternion.
+  QuaternionT<T> rotation_;
+};
+
+/// \brief Quaternion-backed isometry of doubles.
+using IsometryQ = IsometryQT<double>;
+
+/// \brief Quaternion-backed isometry of floats.
+using IsometryQf = IsometryQT<float>;
+
+// Trivially copyable and standard layout like Vector3T.
+static_assert(std::is_trivially_copyable<IsometryQ>::value &&
+                  std::is_trivially_copyable<IsometryQf>::value,
+              "IsometryQT must be trivially copyable");
+static_assert(std::is_standard_layout<IsometryQ>::value &&
+                  std::is_standard_layout<IsometryQf>::value,
+              "IsometryQT must be standard layout");
+
+/// \brief Free function implementation of the output stream operator.
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const IsometryQT<T>& isometry);
+
+// Inline implementations of the hot paths, kept in the header so that callers
+// in other translation units can inline them.
+
+template <typename T>
+constexpr IsometryQT<T>::IsometryQT() : translation_(), rotation_() {}
+
+template <typename T>
+constexpr IsometryQT<T>::IsometryQT(const Vector3T<T>& translation,
+                                    const QuaternionT<T>& rotation)
+    : translation_(translation), rotation_(rotation) {}
+
+template <typename T>
+template <typename U>
+constexpr IsometryQT<T>::IsometryQT(const IsometryQT<U>& isometry)
+    : translation_(isometry.translation()), rotation_(isometry.rotation()) {}
+
+template <typename T>
+inline IsometryT<T> IsometryQT<T>::toIsometry() const {
+  return IsometryT<T>(translation_, rotation_.toRotationMatrix());
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryQT<T>::transform(
+    const Vector3T<T>& vector) const {
+  return rotation_.rotate(vector) + translation_;
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryQT<T>::transform(const Vector3T<P>* input,
+                                     const std::size_t count,
+                                     Vector3T<P>* output) const {
+  toIsometry().transform(input, count, output);
+}
+
+template <typename T>
+template <typename P>
+inline void IsometryQT<T>::transform(const PointCloudT<P>& input,
+                                     PointCloudT<P>* output) const {
+  toIsometry().transform(input, output);
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryQT<T>::inverseTransform(
+    const Vector3T<T>& vector) const {
+  return rotation_.conjugate().rotate(vector - translation_);
+}
+
+template <typename T>
+constexpr IsometryQT<T> IsometryQT<T>::inverse() const {
+  const QuaternionT<T> conjugate = rotation_.conjugate();
+  return IsometryQT(conjugate.rotate(translation_) * T{-1}, conjugate);
+}
+
+template <typename T>
+constexpr IsometryQT<T> IsometryQT<T>::compose(
+    const IsometryQT& isometry) const {
+  return IsometryQT(rotation_.rotate(isometry.translation_) + translation_,
+                    rotation_ * isometry.rotation_);
+}
+
+template <typename T>
+constexpr IsometryQT<T>& IsometryQT<T>::operator*=(
+    const IsometryQT& isometry) {
+  *this = compose(isometry);
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T> IsometryQT<T>::operator*(
+    const Vector3T<T>& vector) const {
+  return transform(vector);
+}
+
+template <typename T>
+constexpr IsometryQT<T> IsometryQT<T>::operator*(
+    const IsometryQT& isometry) const {
+  return compose(isometry);
+}
+
+template <typename T>
+constexpr Vector3T<T>& IsometryQT<T>::translation() {
+  return translation_;
+}
+
+template <typename T>
+constexpr const Vector3T<T>& IsometryQT<T>::translation() const {
+  return translation_;
+}
+
+template <typename T>
+constexpr QuaternionT<T>& IsometryQT<T>::rotation() {
+  return rotation_;
+}
+
+template <typename T>
+constexpr const QuaternionT<T>& IsometryQT<T>::rotation() const {
+  return rotation_;
+}
+
+// The non-inline members are compiled once in the isometry library.
+extern template class IsometryQT<double>;
+extern template class IsometryQT<float>;
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const IsometryQT<double>& isometry);
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const IsometryQT<float>& isometry);
+
+}  // namespace math
+}  // namespace ekumen
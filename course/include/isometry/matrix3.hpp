@@ -6,20 +6,87 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include <isometry/error.hpp>
 #include <isometry/vector3.hpp>
 
 namespace ekumen {
 namespace math {
 
 /**
- * This class is used to represent a 3x3 matrix of doubles.
+ * This class is used to represent a 3x3 matrix of scalars.
+ *
+ * It is explicitly instantiated for double (Matrix3) and float (Matrix3f).
  */
-class Matrix3 {
+template <typename T>
+class Matrix3T {
  public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
+  /// \brief Mutable view of a row, returned by the non-const row accessors.
+  ///
+  /// The matrix stores its elements as 9 contiguous scalars rather than as
+  /// Vector3T objects, so a row is written through this view instead of a
+  /// Vector3T reference. It is only valid while the matrix is.
+  class RowReference {
+   public:
+    /// \brief Assigns the elements of a vector to the row.
+    constexpr RowReference& operator=(const Vector3T<T>& vector) noexcept {
+      data_[0] = vector.x();
+      data_[1] = vector.y();
+      data_[2] = vector.z();
+      return *this;
+    }
+
+    /// \brief Assigns the elements of another row, not the view itself.
+    constexpr RowReference& operator=(const RowReference& row) noexcept {
+      return *this = Vector3T<T>(row);
+    }
+
+    /// \brief Copy of the row.
+    constexpr operator Vector3T<T>() const noexcept {
+      return Vector3T<T>(data_[0], data_[1], data_[2]);
+    }
+
+    /// \brief Mutable reference to an element of the row.
+    /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
+    constexpr T& operator[](const int index) const {
+      if (index < 0 || index > 2) {
+        internal::fail<std::out_of_range>("Vector3 has only 3 elements");
+      }
+      return data_[index];
+    }
+
+    /// \brief Mutable reference to an element of the row.
+    /// \pre `index` is in the range [0, 2], it is not checked.
+    constexpr T& at(const int index) const noexcept { return data_[index]; }
+
+    /// \brief Mutable reference to the first element.
+    constexpr T& x() const noexcept { return data_[0]; }
+
+    /// \brief Mutable reference to the second element.
+    constexpr T& y() const noexcept { return data_[1]; }
+
+    /// \brief Mutable reference to the third element.
+    constexpr T& z() const noexcept { return data_[2]; }
+
+   private:
+    friend class Matrix3T;
+
+    constexpr explicit RowReference(T* data) noexcept : data_(data) {}
+
+    // First element of the row within the matrix.
+    T* data_;
+  };
+
   /// \brief Default constructor.
-  Matrix3();
+  constexpr Matrix3T() noexcept;
 
-  /// Constructs a 3-dimensional matrix from a list of doubles.
+  /// Constructs a 3-dimensional matrix from a list of scalars.
   /// \param a1 First row, first column element.
   /// \param a2 First row, second column element.
   /// \param a3 First row, third column element.
@@ -29,117 +96,567 @@ class Matrix3 {
   /// \param c1 Third row, first column element.
   /// \param c2 Third row, second column element.
   /// \param c3 Third row, third column element.
-  Matrix3(const double a1, const double a2, const double a3, const double b1,
-          const double b2, const double b3, const double c1, const double c2,
-          const double c3);
+  constexpr Matrix3T(const T a1, const T a2, const T a3, const T b1,
+                     const T b2, const T b3, const T c1, const T c2,
+                     const T c3) noexcept;
 
-  // Constant matrices
-  static const Matrix3 kIdentity;
-  static const Matrix3 kOnes;
-  static const Matrix3 kZero;
+  /// \brief Converting constructor from a matrix of another scalar type.
+  template <typename U>
+  constexpr explicit Matrix3T(const Matrix3T<U>& matrix) noexcept;
+
+  // Constant matrices, defined constexpr below.
+  static const Matrix3T kIdentity;
+  static const Matrix3T kOnes;
+  static const Matrix3T kZero;
 
   /// \brief Equals to operator.
   /// \returns A bool indicating equality.
-  bool operator==(const Matrix3& matrix) const;
+  bool operator==(const Matrix3T& matrix) const;
 
   /// \brief Non-equals to operator.
   /// \returns A bool indicating non equality.
-  bool operator!=(const Matrix3& matrix) const;
+  bool operator!=(const Matrix3T& matrix) const;
 
   /// \brief Const implementation of the [] accessor.
   /// \returns An rval copy of the requested row vector.
   ///
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  Vector3 operator[](const int index) const;
+  constexpr Vector3T<T> operator[](const int index) const;
 
   /// \brief Non-const implementation of the [] accessor.
-  /// \returns A mutable reference to the requested row vector.
+  /// \returns A mutable view of the requested row.
   ///
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  Vector3& operator[](const int index);
+  constexpr RowReference operator[](const int index);
+
+  /// \brief Const implementation of the unchecked element accessor.
+  /// \param row Row number.
+  /// \param col Column number.
+  /// \returns An rval copy of the requested element.
+  /// \pre `row` and `col` are in the range [0, 2], they are not checked.
+  constexpr T operator()(const int row, const int col) const noexcept;
+
+  /// \brief Non-const implementation of the unchecked element accessor.
+  /// \param row Row number.
+  /// \param col Column number.
+  /// \returns A mutable reference to the requested element.
+  /// \pre `row` and `col` are in the range [0, 2], they are not checked.
+  constexpr T& operator()(const int row, const int col) noexcept;
+
+  /// \brief Const access to the contiguous row-major storage.
+  /// \returns A pointer to the first of the 9 elements.
+  constexpr const T* data() const noexcept;
+
+  /// \brief Mutable access to the contiguous row-major storage.
+  /// \returns A pointer to the first of the 9 elements.
+  constexpr T* data() noexcept;
 
   /// \brief Non const implementation of the plus assign operator.
-  Matrix3& operator+=(const Matrix3& matrix);
+  constexpr Matrix3T& operator+=(const Matrix3T& matrix) noexcept;
 
   /// \brief Non const implementation of the minus assign operator.
-  Matrix3& operator-=(const Matrix3& matrix);
+  constexpr Matrix3T& operator-=(const Matrix3T& matrix) noexcept;
 
   /// \brief Non const implementation of the mult times matrix assign operator.
-  Matrix3& operator*=(const Matrix3& matrix);
+  constexpr Matrix3T& operator*=(const Matrix3T& matrix) noexcept;
 
-  /// \brief Non const implementation of the mult times double assign operator.
-  Matrix3& operator*=(const double scalar);
+  /// \brief Non const implementation of the mult times scalar assign operator.
+  constexpr Matrix3T& operator*=(const T scalar) noexcept;
 
   /// \brief Non const implementation of the divide over matrix assign operator.
-  Matrix3& operator/=(const Matrix3& matrix);
+  constexpr Matrix3T& operator/=(const Matrix3T& matrix) noexcept;
 
-  /// \brief Non const implementation of the divide over double assign operator.
-  Matrix3& operator/=(const double scalar);
+  /// \brief Non const implementation of the divide over scalar assign operator.
+  constexpr Matrix3T& operator/=(const T scalar) noexcept;
 
   /// \brief Const implementation of the sum operator.
-  Matrix3 operator+(const Matrix3& matrix) const;
+  constexpr Matrix3T operator+(const Matrix3T& matrix) const noexcept;
 
   /// \brief Const implementation of the sub operator.
-  Matrix3 operator-(const Matrix3& matrix) const;
+  constexpr Matrix3T operator-(const Matrix3T& matrix) const noexcept;
 
   /// \brief Const implementation of the mult times matrix operator.
-  Matrix3 operator*(const Matrix3& matrix) const;
+  constexpr Matrix3T operator*(const Matrix3T& matrix) const noexcept;
 
   /// \brief Const implementation of the mult times vector operator.
-  Vector3 operator*(const Vector3& vector) const;
+  constexpr Vector3T<T> operator*(const Vector3T<T>& vector) const noexcept;
 
-  /// \brief Const implementation of the mult times double operator.
-  Matrix3 operator*(const double scalar) const;
+  /// \brief Const implementation of the mult times scalar operator.
+  constexpr Matrix3T operator*(const T scalar) const noexcept;
 
-  /// \brief Const implementation of the over integer operator.
-  Matrix3 operator/(const Matrix3& matrix) const;
+  /// \brief Const implementation of the over matrix operator.
+  constexpr Matrix3T operator/(const Matrix3T& matrix) const noexcept;
 
-  /// \brief Const implementation of the mult times double operator.
-  Matrix3 operator/(const double scalar) const;
+  /// \brief Const implementation of the over scalar operator.
+  constexpr Matrix3T operator/(const T scalar) const noexcept;
 
   /// \brief Returns the determinant of the matrix.
-  /// \returns A double with value of the matrix' determinant.
-  double det() const;
+  /// \returns A scalar with value of the matrix' determinant.
+  constexpr T det() const noexcept;
 
   /// \brief Returns the inverse of the matrix.
   /// \returns A new matrix with the inverse.
-  Matrix3 inverse() const;
-
-  Matrix3 product(const Matrix3& matrix) const;
-  Vector3 product(const Vector3& vector) const;
-
-  /// \brief Returns a reference to a row.
+  /// \throw std::runtime_error When the matrix is singular.
+  /// \see tryInverse() for a version that does not throw.
+  Matrix3T inverse() const;
+
+  /// \brief Computes the inverse of the matrix, reporting a singular matrix
+  /// instead of throwing.
+  /// \param inverse Storage for the inverse, untouched when the matrix is
+  /// singular. It may point to this matrix.
+  /// \returns Whether the matrix is invertible, by the same test on the
+  /// determinant as inverse().
+  bool tryInverse(Matrix3T* inverse) const noexcept;
+
+  /// \brief Exponential map of SO(3), the rotation matrix of a rotation
+  /// vector.
+  /// \param rotation Rotation vector: the rotation axis scaled by the angle
+  /// in radians.
+  /// \returns A rotation matrix, computed with Taylor expansions for small
+  /// angles so that it is accurate down to the null rotation.
+  static Matrix3T exp(const Vector3T<T>& rotation) noexcept;
+
+  /// \brief Exponential map of SO(3) of an array of rotation vectors, with
+  /// the sines and cosines computed by a vectorized kernel.
+  /// \param rotations Pointer to the first of `count` rotation vectors.
+  /// \param count Number of rotation vectors.
+  /// \param output Storage for `count` matrices.
+  static void exp(const Vector3T<T>* rotations, const std::size_t count,
+                  Matrix3T* output) noexcept;
+
+  /// \brief Logarithm map of SO(3), the inverse of exp().
+  ///
+  /// The angle is recovered with atan2 from both the symmetric and the
+  /// skew-symmetric parts of the matrix, which keeps it accurate near 0 and
+  /// near pi, where acos of the trace is not.
+  /// \returns The rotation vector, whose norm is the angle in [0, pi].
+  /// \pre The matrix is a rotation matrix.
+  Vector3T<T> log() const noexcept;
+
+  /// \brief Logarithm map of SO(3) of an array of rotation matrices.
+  /// \param rotations Pointer to the first of `count` rotation matrices.
+  /// \param count Number of matrices.
+  /// \param output Storage for `count` rotation vectors.
+  static void log(const Matrix3T* rotations, const std::size_t count,
+                  Vector3T<T>* output) noexcept;
+
+  /// \brief Matrix product between this and a given matrix.
+  constexpr Matrix3T product(const Matrix3T& matrix) const noexcept;
+
+  /// \brief Matrix product between this and a given column vector.
+  constexpr Vector3T<T> product(const Vector3T<T>& vector) const noexcept;
+
+  /// \brief Returns the transpose of the matrix.
+  /// \returns A new matrix with rows and columns swapped.
+  constexpr Matrix3T transpose() const noexcept;
+
+  /// \brief Product between the transpose of this and a given column vector,
+  /// computed without building the transpose.
+  constexpr Vector3T<T> transposeProduct(
+      const Vector3T<T>& vector) const noexcept;
+
+  /// \brief Returns a mutable view of a row.
   /// \param index Row number.
-  /// \returns A Vector3.
+  /// \returns A RowReference.
   ///
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  Vector3& row(const int index);
+  constexpr RowReference row(const int index);
 
   /// \brief Const implementation of the row accessor.
   /// \param index Row number.
-  /// \returns A Vector3.
+  /// \returns A Vector3T.
   ///
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  Vector3 row(const int index) const;
+  constexpr Vector3T<T> row(const int index) const;
 
   /// \brief Const implementation of the column accessor.
   /// \param index Column number.
-  /// \returns A Vector3.
+  /// \returns A Vector3T.
   ///
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  Vector3 col(const int index) const;
+  constexpr Vector3T<T> col(const int index) const;
+
+  /// \brief Unchecked implementation of the row accessor.
+  /// \param index Row number.
+  /// \returns A mutable view of the row.
+  /// \pre `index` is in the range [0, 2], it is not checked.
+  constexpr RowReference rowAt(const int index) noexcept;
+
+  /// \brief Const unchecked implementation of the row accessor.
+  /// \param index Row number.
+  /// \returns A Vector3T.
+  /// \pre `index` is in the range [0, 2], it is not checked.
+  constexpr Vector3T<T> rowAt(const int index) const noexcept;
+
+  /// \brief Const unchecked implementation of the column accessor.
+  /// \param index Column number.
+  /// \returns A Vector3T.
+  /// \pre `index` is in the range [0, 2], it is not checked.
+  constexpr Vector3T<T> colAt(const int index) const noexcept;
 
  private:
-  Vector3 row_0_;
-  Vector3 row_1_;
-  Vector3 row_2_;
+  // Elements in row-major order.
+  T data_[9];
 };
 
+// Defined constexpr once the class is complete, before it is instantiated.
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kIdentity{
+    Matrix3T(T{1}, T{0}, T{0}, T{0}, T{1}, T{0}, T{0}, T{0}, T{1})};
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kOnes{
+    Matrix3T(T{1}, T{1}, T{1}, T{1}, T{1}, T{1}, T{1}, T{1}, T{1})};
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kZero{
+    Matrix3T(T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0})};
+
+/// \brief Matrix of doubles.
+using Matrix3 = Matrix3T<double>;
+
+/// \brief Matrix of floats.
+using Matrix3f = Matrix3T<float>;
+
+// Trivially copyable and standard layout like Vector3T.
+static_assert(std::is_trivially_copyable<Matrix3>::value &&
+                  std::is_trivially_copyable<Matrix3f>::value,
+              "Matrix3T must be trivially copyable");
+static_assert(std::is_standard_layout<Matrix3>::value &&
+                  std::is_standard_layout<Matrix3f>::value,
+              "Matrix3T must be standard layout");
+
 /// \brief Free function implementation of the operator*
-Matrix3 operator*(double scalar, const Matrix3& matrix);
+template <typename T>
+constexpr Matrix3T<T> operator*(typename Matrix3T<T>::Scalar scalar,
+                                const Matrix3T<T>& matrix) noexcept;
 
 /// \brief Free function implementation of the operator<<
-std::ostream& operator<<(std::ostream& os, const Matrix3& matrix);
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Matrix3T<T>& matrix);
+
+// Inline implementations of the hot paths, kept in the header so that callers
+// in other translation units can inline them.
+
+template <typename T>
+constexpr Matrix3T<T>::Matrix3T() noexcept
+    : data_{T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0}, T{0}} {}
+
+template <typename T>
+constexpr Matrix3T<T>::Matrix3T(const T a1, const T a2, const T a3,
+                                const T b1, const T b2, const T b3,
+                                const T c1, const T c2, const T c3) noexcept
+    : data_{a1, a2, a3, b1, b2, b3, c1, c2, c3} {}
+
+template <typename T>
+template <typename U>
+constexpr Matrix3T<T>::Matrix3T(const Matrix3T<U>& matrix) noexcept : data_{} {
+  for (int i = 0; i < 9; ++i) {
+    data_[i] = static_cast<T>(matrix.data()[i]);
+  }
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::operator[](const int index) const {
+  if (index < 0 || index > 2) {
+    internal::fail<std::out_of_range>("Matrix3 has only 3 elements");
+  }
+  return Vector3T<T>(data_[3 * index], data_[3 * index + 1],
+                     data_[3 * index + 2]);
+}
+
+template <typename T>
+constexpr typename Matrix3T<T>::RowReference Matrix3T<T>::operator[](
+    const int index) {
+  if (index < 0 || index > 2) {
+    internal::fail<std::out_of_range>("Matrix3 has only 3 elements");
+  }
+  return RowReference(data_ + 3 * index);
+}
+
+template <typename T>
+constexpr T Matrix3T<T>::operator()(const int row,
+                                    const int col) const noexcept {
+  return data_[3 * row + col];
+}
+
+template <typename T>
+constexpr T& Matrix3T<T>::operator()(const int row, const int col) noexcept {
+  return data_[3 * row + col];
+}
+
+template <typename T>
+constexpr const T* Matrix3T<T>::data() const noexcept {
+  return data_;
+}
+
+template <typename T>
+constexpr T* Matrix3T<T>::data() noexcept {
+  return data_;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator+=(
+    const Matrix3T& matrix) noexcept {
+  for (int i = 0; i < 9; ++i) {
+    data_[i] += matrix.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator-=(
+    const Matrix3T& matrix) noexcept {
+  for (int i = 0; i < 9; ++i) {
+    data_[i] -= matrix.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator*=(
+    const Matrix3T& matrix) noexcept {
+  for (int i = 0; i < 9; ++i) {
+    data_[i] *= matrix.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator*=(const T scalar) noexcept {
+  for (T& value : data_) {
+    value *= scalar;
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator/=(
+    const Matrix3T& matrix) noexcept {
+  for (int i = 0; i < 9; ++i) {
+    data_[i] /= matrix.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T>& Matrix3T<T>::operator/=(const T scalar) noexcept {
+  for (T& value : data_) {
+    value /= scalar;
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator+(
+    const Matrix3T& matrix) const noexcept {
+  Matrix3T aux{*this};
+  aux += matrix;
+  return aux;
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator-(
+    const Matrix3T& matrix) const noexcept {
+  Matrix3T aux{*this};
+  aux -= matrix;
+  return aux;
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator*(
+    const Matrix3T& matrix) const noexcept {
+  Matrix3T aux{*this};
+  aux *= matrix;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::operator*(
+    const Vector3T<T>& vector) const noexcept {
+  return product(vector);
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator*(const T scalar) const noexcept {
+  Matrix3T aux{*this};
+  aux *= scalar;
+  return aux;
+}
+
+template <typename T>
+constexpr Matrix3T<T> operator*(typename Matrix3T<T>::Scalar scalar,
+                                const Matrix3T<T>& matrix) noexcept {
+  return matrix * scalar;
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator/(
+    const Matrix3T& matrix) const noexcept {
+  Matrix3T aux{*this};
+  aux /= matrix;
+  return aux;
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::operator/(const T scalar) const noexcept {
+  Matrix3T aux{*this};
+  aux /= scalar;
+  return aux;
+}
+
+template <typename T>
+constexpr T Matrix3T<T>::det() const noexcept {
+  return data_[0] * (data_[4] * data_[8] - data_[5] * data_[7]) -
+         data_[1] * (data_[3] * data_[8] - data_[5] * data_[6]) +
+         data_[2] * (data_[3] * data_[7] - data_[4] * data_[6]);
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::product(
+    const Matrix3T& matrix) const noexcept {
+  Matrix3T result;
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      result.data_[3 * r + c] = data_[3 * r] * matrix.data_[c] +
+                                data_[3 * r + 1] * matrix.data_[3 + c] +
+                                data_[3 * r + 2] * matrix.data_[6 + c];
+    }
+  }
+  return result;
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::product(
+    const Vector3T<T>& vector) const noexcept {
+  return Vector3T<T>(
+      data_[0] * vector.x() + data_[1] * vector.y() + data_[2] * vector.z(),
+      data_[3] * vector.x() + data_[4] * vector.y() + data_[5] * vector.z(),
+      data_[6] * vector.x() + data_[7] * vector.y() + data_[8] * vector.z());
+}
+
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::transpose() const noexcept {
+  return Matrix3T(data_[0], data_[3], data_[6], data_[1], data_[4], data_[7],
+                  data_[2], data_[5], data_[8]);
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::transposeProduct(
+    const Vector3T<T>& vector) const noexcept {
+  return Vector3T<T>(
+      data_[0] * vector.x() + data_[3] * vector.y() + data_[6] * vector.z(),
+      data_[1] * vector.x() + data_[4] * vector.y() + data_[7] * vector.z(),
+      data_[2] * vector.x() + data_[5] * vector.y() + data_[8] * vector.z());
+}
+
+template <typename T>
+constexpr typename Matrix3T<T>::RowReference Matrix3T<T>::row(
+    const int index) {
+  return (*this)[index];
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::row(const int index) const {
+  return (*this)[index];
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::col(const int index) const {
+  if (index < 0 || index > 2) {
+    internal::fail<std::out_of_range>("Matrix3 has only 3 elements");
+  }
+  return Vector3T<T>(data_[index], data_[3 + index], data_[6 + index]);
+}
+
+template <typename T>
+constexpr typename Matrix3T<T>::RowReference Matrix3T<T>::rowAt(
+    const int index) noexcept {
+  return RowReference(data_ + 3 * index);
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::rowAt(const int index) const noexcept {
+  return Vector3T<T>(data_[3 * index], data_[3 * index + 1],
+                     data_[3 * index + 2]);
+}
+
+template <typename T>
+constexpr Vector3T<T> Matrix3T<T>::colAt(const int index) const noexcept {
+  return Vector3T<T>(data_[index], data_[3 + index], data_[6 + index]);
+}
+
+namespace internal {
+
+/// \brief Squared angle below which the exponential and logarithm maps use
+/// Taylor expansions instead of quotients that cancel out near 0.
+constexpr double kSmallAngleSquared{1e-4};
+
+/// \brief Number of angles whose sines and cosines the batch functions
+/// compute at once, small enough for all of them to stay in the L1 cache.
+constexpr std::size_t kTrigBlock{256};
+
+/// \brief Sine and cosine of an angle. GCC and Clang fuse the two calls into
+/// a single sincos.
+template <typename T>
+inline void sinCos(const T radians, T* sine, T* cosine) {
+  *sine = std::sin(radians);
+  *cosine = std::cos(radians);
+}
+
+/// \brief Sines and cosines of an array of angles, with a kernel that the
+/// compiler vectorizes. It matches std::sin and std::cos to within a few ulps
+/// for angles up to 1e5 radians, and larger angles go through them.
+///
+/// Compiled in the isometry library for float and double.
+/// \param radians Pointer to the first of `count` angles.
+/// \param count Number of angles.
+/// \param sines Storage for `count` sines.
+/// \param cosines Storage for `count` cosines.
+template <typename T>
+void sinCos(const T* radians, const std::size_t count, T* sines,
+            T* cosines);
+
+/// \brief Coefficients of the exponential map of a rotation vector w, whose
+/// angle theta has squared value `theta2`, sine `sine` and cosine `cosine`:
+/// a = sin(theta) / theta and b = (1 - cos(theta)) / theta^2, so that
+/// exp(w) = I + a [w]x + b [w]x^2.
+template <typename T>
+inline void expCoefficients(const T theta2, const T sine, const T cosine,
+                            T* a, T* b) {
+  if (theta2 < static_cast<T>(kSmallAngleSquared)) {
+    *a = T{1} - theta2 / T{6} * (T{1} - theta2 / T{20});
+    *b = T{0.5} - theta2 / T{24} * (T{1} - theta2 / T{30});
+  } else {
+    *a = sine / std::sqrt(theta2);
+    // sin^2 / (1 + cos) does not cancel out like 1 - cos does for small
+    // angles, nor divides by almost 0 near pi.
+    *b = cosine > T{0} ? *a * *a / (T{1} + cosine)
+                       : (T{1} - cosine) / theta2;
+  }
+}
+
+/// \brief Rotation matrix I + a [w]x + b [w]x^2 of a rotation vector w.
+template <typename T>
+inline Matrix3T<T> rodrigues(const Vector3T<T>& w, const T a, const T b) {
+  const T xx = w.x() * w.x();
+  const T yy = w.y() * w.y();
+  const T zz = w.z() * w.z();
+  const T xy = b * w.x() * w.y();
+  const T xz = b * w.x() * w.z();
+  const T yz = b * w.y() * w.z();
+  return Matrix3T<T>(T{1} - b * (yy + zz), xy - a * w.z(), xz + a * w.y(),
+                     xy + a * w.z(), T{1} - b * (xx + zz), yz - a * w.x(),
+                     xz - a * w.y(), yz + a * w.x(), T{1} - b * (xx + yy));
+}
+
+}  // namespace internal
+
+// The non-inline members are compiled once in the isometry library.
+extern template class Matrix3T<double>;
+extern template class Matrix3T<float>;
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const Matrix3T<double>& matrix);
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const Matrix3T<float>& matrix);
 
 }  // namespace math
 }  // namespace ekumen
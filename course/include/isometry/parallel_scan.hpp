@@ -0,0 +1,106 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/thread_pool.hpp>
+
+namespace ekumen {
+namespace math {
+
+/// \brief Default minimum number of isometries per thread of the parallel
+/// scan. Fewer compositions do not amortize waking the pool.
+constexpr std::size_t kDefaultScanGrain{4096};
+
+/// \brief Computes the inclusive scan of a range of isometries,
+/// output[i] = input[0] * input[1] * ... * input[i], which turns relative
+/// motions into absolute poses, splitting the work among the threads of a
+/// pool.
+///
+/// Composition is associative, so the range is scanned in three passes: every
+/// thread scans one contiguous chunk, the chunk totals are folded serially,
+/// and every thread but the first left-multiplies its chunk by the total of
+/// the chunks before it. That is about twice the compositions of a serial
+/// fold, so n threads are up to n / 2 times faster. Rounding makes the result
+/// differ from the serial fold by a few ulps per composition.
+/// \param input Pointer to the first of `count` isometries.
+/// \param count Number of isometries.
+/// \param output Pointer to storage for `count` isometries, either equal to
+/// `input` or not overlapping it.
+/// \param pool Threads to run on.
+/// \param grain Minimum number of isometries per thread.
+template <typename T>
+void parallelInclusiveScan(const IsometryT<T>* input, const std::size_t count,
+                           IsometryT<T>* output, ThreadPool* pool,
+                           const std::size_t grain = kDefaultScanGrain) {
+  if (count == 0) {
+    return;
+  }
+  const std::size_t step = std::max<std::size_t>(grain, 1);
+  const std::size_t threads =
+      std::min((count + step - 1) / step, pool->size());
+  const std::size_t chunk = (count + threads - 1) / threads;
+  const std::size_t chunks = (count + chunk - 1) / chunk;
+  const auto scanChunk = [input, output, count, chunk](const std::size_t k) {
+    const std::size_t begin = k * chunk;
+    const std::size_t end = std::min(begin + chunk, count);
+    output[begin] = input[begin];
+    for (std::size_t i = begin + 1; i < end; ++i) {
+      output[i] = output[i - 1] * input[i];
+    }
+  };
+  if (chunks == 1) {
+    scanChunk(0);
+    return;
+  }
+  // One chunk index per thread, so the chunks are fixed by `chunk` alone.
+  pool->parallelFor(chunks, 1,
+                    [&scanChunk](const std::size_t begin,
+                                 const std::size_t end) {
+                      for (std::size_t k = begin; k < end; ++k) {
+                        scanChunk(k);
+                      }
+                    });
+
+  // carries[k] is the composition of every chunk before chunk k.
+  std::vector<IsometryT<T>> carries(chunks);
+  carries[1] = output[chunk - 1];
+  for (std::size_t k = 2; k < chunks; ++k) {
+    carries[k] = carries[k - 1] * output[k * chunk - 1];
+  }
+
+  pool->parallelFor(chunks - 1, 1,
+                    [&carries, output, count, chunk](const std::size_t first,
+                                                     const std::size_t last) {
+                      for (std::size_t k = first + 1; k < last + 1; ++k) {
+                        const IsometryT<T>& carry = carries[k];
+                        const std::size_t end = std::min((k + 1) * chunk,
+                                                         count);
+                        for (std::size_t i = k * chunk; i < end; ++i) {
+                          output[i] = carry * output[i];
+                        }
+                      }
+                    });
+}
+
+/// \brief Computes the inclusive scan of a vector of isometries in place.
+/// \see parallelInclusiveScan(const IsometryT<T>*, std::size_t, IsometryT<T>*,
+/// ThreadPool*, std::size_t)
+template <typename T>
+void parallelInclusiveScan(std::vector<IsometryT<T>>* isometries,
+                           ThreadPool* pool,
+                           const std::size_t grain = kDefaultScanGrain) {
+  parallelInclusiveScan(isometries->data(), isometries->size(),
+                        isometries->data(), pool, grain);
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,131 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <isometry/isometry.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/point_cloud.hpp>
+#include <isometry/point_view.hpp>
+#include <isometry/thread_pool.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/// \brief Default number of points per chunk of the parallel transforms. It
+/// keeps clouds too small to amortize waking the pool on the calling thread.
+constexpr std::size_t kDefaultTransformGrain{32768};
+
+/// \brief Applies an isometric transformation to a point cloud, splitting the
+/// points among the threads of a pool.
+/// \param isometry Transformation to apply.
+/// \param input Cloud to transform.
+/// \param output Cloud to store the result in, it is resized to the size of
+/// `input` and it may be `input` itself.
+/// \param pool Threads to run on.
+/// \param grain Minimum number of points per thread, it is rounded up so that
+/// every chunk starts at an aligned point.
+template <typename T, typename P>
+void parallelTransform(const IsometryT<T>& isometry,
+                       const PointCloudT<P>& input, PointCloudT<P>* output,
+                       ThreadPool* pool,
+                       const std::size_t grain = kDefaultTransformGrain) {
+  // Number of points in an aligned block of each coordinate array.
+  constexpr std::size_t kBlock{PointCloudT<P>::kAlignment / sizeof(P)};
+  output->resize(input.size());
+  const Matrix3T<P> rotation(isometry.rotation());
+  const Vector3T<P> translation(isometry.translation());
+  const P* x = input.x();
+  const P* y = input.y();
+  const P* z = input.z();
+  P* out_x = output->x();
+  P* out_y = output->y();
+  P* out_z = output->z();
+  pool->parallelFor(
+      input.size(), (grain + kBlock - 1) / kBlock * kBlock,
+      [&](const std::size_t begin, const std::size_t end) {
+        internal::transformPoints(rotation, translation, x + begin, y + begin,
+                                  z + begin, end - begin, out_x + begin,
+                                  out_y + begin, out_z + begin);
+      });
+}
+
+/// \brief Applies an isometric transformation in place to a point cloud,
+/// splitting the points among the threads of a pool.
+/// \see parallelTransform(const IsometryT<T>&, const PointCloudT<P>&,
+/// PointCloudT<P>*, ThreadPool*, std::size_t)
+template <typename T, typename P>
+void parallelTransform(const IsometryT<T>& isometry, PointCloudT<P>* cloud,
+                       ThreadPool* pool,
+                       const std::size_t grain = kDefaultTransformGrain) {
+  parallelTransform(isometry, *cloud, cloud, pool, grain);
+}
+
+/// \brief Applies an isometric transformation to a range of interleaved
+/// x, y, z coordinates, splitting the points among the threads of a pool.
+/// \param isometry Transformation to apply.
+/// \param input Pointer to the first of `3 * count` scalars.
+/// \param count Number of points to transform.
+/// \param output Pointer to storage for `3 * count` scalars, either equal to
+/// `input` or not overlapping it.
+/// \param pool Threads to run on.
+/// \param grain Minimum number of points per thread.
+template <typename T, typename P>
+void parallelTransform(const IsometryT<T>& isometry, const P* input,
+                       const std::size_t count, P* output, ThreadPool* pool,
+                       const std::size_t grain = kDefaultTransformGrain) {
+  const Matrix3T<P> rotation(isometry.rotation());
+  const Vector3T<P> translation(isometry.translation());
+  pool->parallelFor(count, grain,
+                    [&](const std::size_t begin, const std::size_t end) {
+                      internal::transformPoints(rotation, translation,
+                                                input + 3 * begin, end - begin,
+                                                output + 3 * begin);
+                    });
+}
+
+/// \brief Applies an isometric transformation to a range of vectors,
+/// splitting them among the threads of a pool.
+/// \see parallelTransform(const IsometryT<T>&, const P*, std::size_t, P*,
+/// ThreadPool*, std::size_t)
+template <typename T, typename P>
+void parallelTransform(const IsometryT<T>& isometry,
+                       const Vector3T<P>* input, const std::size_t count,
+                       Vector3T<P>* output, ThreadPool* pool,
+                       const std::size_t grain = kDefaultTransformGrain) {
+  parallelTransform(isometry, reinterpret_cast<const P*>(input), count,
+                    reinterpret_cast<P*>(output), pool, grain);
+}
+
+/// \brief Applies an isometric transformation to points read in place,
+/// splitting them among the threads of a pool.
+/// \param isometry Transformation to apply.
+/// \param input View of the points to transform.
+/// \param output Pointer to storage for `input.size()` vectors, not
+/// overlapping the viewed buffer.
+/// \param pool Threads to run on.
+/// \param grain Minimum number of points per thread.
+template <typename T, typename P>
+void parallelTransform(const IsometryT<T>& isometry,
+                       const PointViewT<P>& input, Vector3T<P>* output,
+                       ThreadPool* pool,
+                       const std::size_t grain = kDefaultTransformGrain) {
+  const Matrix3T<P> rotation(isometry.rotation());
+  const Vector3T<P> translation(isometry.translation());
+  pool->parallelFor(
+      input.size(), grain,
+      [&](const std::size_t begin, const std::size_t end) {
+        internal::transformPoints(
+            rotation, translation, input.data() + begin * input.stride(),
+            input.stride(), end - begin, reinterpret_cast<P*>(output + begin));
+      });
+}
+
+}  // namespace math
+}  // namespace ekumen
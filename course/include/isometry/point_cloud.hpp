@@ -0,0 +1,181 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <isometry/aligned_allocator.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to represent a set of 3-dimensional points, stored as
+ * a structure of arrays: all x coordinates, then all y, then all z, each in
+ * its own cache-line aligned array.
+ *
+ * It is explicitly instantiated for double (PointCloud) and float
+ * (PointCloudf).
+ */
+template <typename T>
+class PointCloudT {
+ public:
+  /// \brief Scalar type of the coordinates.
+  using Scalar = T;
+
+  /// \brief Alignment in bytes of each coordinate array.
+  static constexpr std::size_t kAlignment{64};
+
+  /// \brief Storage type of each coordinate array.
+  using Storage = std::vector<T, AlignedAllocator<T, kAlignment>>;
+
+  /// \brief Default constructor, creates an empty cloud.
+  PointCloudT() = default;
+
+  /// \brief Constructs a cloud of `size` points at the origin.
+  /// \param size Number of points.
+  explicit PointCloudT(const std::size_t size);
+
+  /// \brief Constructs a cloud from an array of vectors.
+  /// \param points Points to copy into the cloud.
+  explicit PointCloudT(const std::vector<Vector3T<T>>& points);
+
+  /// \brief Converts the cloud back to an array of vectors.
+  /// \returns A new std::vector with one Vector3T per point.
+  std::vector<Vector3T<T>> toVector() const;
+
+  /// \brief Number of points in the cloud.
+  inline std::size_t size() const;
+
+  /// \brief Whether the cloud has no points.
+  inline bool empty() const;
+
+  /// \brief Changes the number of points, new points are at the origin.
+  /// \param size New number of points.
+  void resize(const std::size_t size);
+
+  /// \brief Reserves storage for at least `size` points.
+  /// \param size Number of points to reserve storage for.
+  void reserve(const std::size_t size);
+
+  /// \brief Removes all points.
+  void clear();
+
+  /// \brief Appends a point at the end of the cloud.
+  /// \param point Point to append.
+  void push_back(const Vector3T<T>& point);
+
+  /// \brief Const implementation of the point accessor.
+  /// \param index Point index.
+  /// \returns A Vector3T copy of the requested point.
+  /// \pre `index` is less than size(), it is not checked.
+  inline Vector3T<T> operator[](const std::size_t index) const;
+
+  /// \brief Replaces a point.
+  /// \param index Point index.
+  /// \param point New value of the point.
+  /// \pre `index` is less than size(), it is not checked.
+  inline void set(const std::size_t index, const Vector3T<T>& point);
+
+  /// \brief Getter of the x coordinates array.
+  inline const T* x() const;
+
+  /// \brief Getter of the y coordinates array.
+  inline const T* y() const;
+
+  /// \brief Getter of the z coordinates array.
+  inline const T* z() const;
+
+  /// \brief Mutable getter of the x coordinates array.
+  inline T* x();
+
+  /// \brief Mutable getter of the y coordinates array.
+  inline T* y();
+
+  /// \brief Mutable getter of the z coordinates array.
+  inline T* z();
+
+ private:
+  // X coordinates.
+  Storage x_;
+
+  // Y coordinates.
+  Storage y_;
+
+  // Z coordinates.
+  Storage z_;
+};
+
+/// \brief Point cloud of doubles.
+using PointCloud = PointCloudT<double>;
+
+/// \brief Point cloud of floats.
+using PointCloudf = PointCloudT<float>;
+
+// Inline implementations of the accessors.
+
+template <typename T>
+inline std::size_t PointCloudT<T>::size() const {
+  return x_.size();
+}
+
+template <typename T>
+inline bool PointCloudT<T>::empty() const {
+  return x_.empty();
+}
+
+template <typename T>
+inline Vector3T<T> PointCloudT<T>::operator[](const std::size_t index) const {
+  return Vector3T<T>(x_[index], y_[index], z_[index]);
+}
+
+template <typename T>
+inline void PointCloudT<T>::set(const std::size_t index,
+                                const Vector3T<T>& point) {
+  x_[index] = point.x();
+  y_[index] = point.y();
+  z_[index] = point.z();
+}
+
+template <typename T>
+inline const T* PointCloudT<T>::x() const {
+  return x_.data();
+}
+
+template <typename T>
+inline const T* PointCloudT<T>::y() const {
+  return y_.data();
+}
+
+template <typename T>
+inline const T* PointCloudT<T>::z() const {
+  return z_.data();
+}
+
+template <typename T>
+inline T* PointCloudT<T>::x() {
+  return x_.data();
+}
+
+template <typename T>
+inline T* PointCloudT<T>::y() {
+  return y_.data();
+}
+
+template <typename T>
+inline T* PointCloudT<T>::z() {
+  return z_.data();
+}
+
+// The non-inline members are compiled once in the isometry library.
+extern template class PointCloudT<double>;
+extern template class PointCloudT<float>;
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,128 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <isometry/error.hpp>
+#include <isometry/point_view.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to read the points of a binary PLY or PCD file in place.
+ *
+ * The file is mapped in memory read-only and only its header is parsed on
+ * construction, so opening a file of any size is cheap: the points are
+ * handed out as a PointViewT over the mapping, which the batch transforms
+ * read directly, and pages are loaded by the kernel as they are touched.
+ *
+ * Supported files store their points as fixed-size little-endian records,
+ * with x, y and z consecutive fields of the same floating point type:
+ *
+ * - PLY with format binary_little_endian, reading the vertex element. The
+ *   elements before it must not have list properties.
+ * - PCD with DATA binary.
+ *
+ * The mapping lives as long as the object, which can be moved but not copied.
+ */
+class PointFile {
+ public:
+  /// \brief Format of a file.
+  enum class Format { kPly, kPcd };
+
+  /// \brief Expected access pattern, passed to the kernel as a hint.
+  enum class Access {
+    /// No particular pattern.
+    kNormal,
+    /// Points read in order, so pages can be read ahead aggressively and
+    /// dropped soon after they are used.
+    kSequential,
+    /// Points read in random order, so reading ahead is useless.
+    kRandom,
+  };
+
+  /// \brief Maps a file and parses its header.
+  /// \param path Path to the file, whose format is told by its contents.
+  /// \param access Expected access pattern.
+  /// \throw std::runtime_error When the file cannot be mapped, or it is not
+  /// a supported file.
+  explicit PointFile(const std::string& path,
+                     const Access access = Access::kSequential);
+
+  PointFile(const PointFile&) = delete;
+  PointFile& operator=(const PointFile&) = delete;
+
+  /// \brief Move constructor, `other` is left without a mapping.
+  PointFile(PointFile&& other) noexcept;
+
+  /// \brief Move assignment, `other` is left without a mapping.
+  PointFile& operator=(PointFile&& other) noexcept;
+
+  /// \brief Unmaps the file, invalidating the views taken from it.
+  ~PointFile();
+
+  /// \brief Format of the file.
+  Format format() const { return format_; }
+
+  /// \brief Number of points.
+  std::size_t size() const { return size_; }
+
+  /// \brief Size in bytes of each coordinate, 4 for float and 8 for double.
+  std::size_t scalarSize() const { return scalar_size_; }
+
+  /// \brief Distance in bytes between the records of consecutive points.
+  std::size_t stride() const { return stride_; }
+
+  /// \brief View of the points, valid while this object lives.
+  /// \throw std::runtime_error When the coordinates are not of type P.
+  template <typename P>
+  PointViewT<P> points() const {
+    if (scalar_size_ != sizeof(P)) {
+      internal::fail<std::runtime_error>(
+          "Points are stored with " + std::to_string(scalar_size_) +
+          " byte coordinates, not " + std::to_string(sizeof(P)));
+    }
+    return PointViewT<P>(points_, size_, stride_);
+  }
+
+  /// \brief Changes the expected access pattern.
+  /// \param access Expected access pattern.
+  void advise(const Access access) const;
+
+ private:
+  // Releases the mapping, if any.
+  void unmap();
+
+  // Start of the mapping.
+  std::uint8_t* map_{nullptr};
+
+  // Size of the mapping in bytes.
+  std::size_t map_size_{0};
+
+  // Format of the file.
+  Format format_{Format::kPly};
+
+  // Pointer to the x coordinate of the first point, within the mapping.
+  const std::uint8_t* points_{nullptr};
+
+  // Number of points.
+  std::size_t size_{0};
+
+  // Distance in bytes between consecutive records.
+  std::size_t stride_{0};
+
+  // Size in bytes of each coordinate.
+  std::size_t scalar_size_{0};
+};
+
+}  // namespace math
+}  // namespace ekumen
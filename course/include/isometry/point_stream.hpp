@@ -0,0 +1,80 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <isometry/isometry.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/// \brief Buffering of streamTransform().
+struct StreamOptions {
+  /// \brief Size in bytes of each buffer, rounded down to whole records.
+  std::size_t buffer_size{std::size_t{4} << 20};
+
+  /// \brief Number of buffers, at least 2. From 3 on reading, transforming
+  /// and writing all overlap, and more buffers absorb stalls of a stage.
+  std::size_t buffers{3};
+};
+
+namespace internal {
+
+/// \brief Pipeline of streamTransform(), with the isometry rounded to the
+/// scalar type of the points.
+///
+/// Compiled in the isometry library for float and double.
+template <typename P>
+std::size_t streamTransform(const Matrix3T<P>& rotation,
+                            const Vector3T<P>& translation, const int input,
+                            const int output, const std::size_t stride,
+                            const std::size_t offset,
+                            const StreamOptions& options);
+
+}  // namespace internal
+
+/// \brief Applies an isometric transformation to a stream of point records,
+/// read from a file descriptor and written to another, for clouds that do not
+/// fit in memory.
+///
+/// Records are read from the current position of `input` to its end, and
+/// written to `output` in the same order with only their coordinates
+/// changed, so a file header is copied or rewritten by the caller. The
+/// calling thread reads, and two threads it starts transform and write,
+/// handing `options.buffers` buffers to each other: the stages overlap, so
+/// the slowest one bounds the throughput, and the memory used is
+/// buffers * buffer_size plus, for records with other fields, a buffer of
+/// coordinates, whatever the length of the stream.
+///
+/// The descriptors can be files, pipes or sockets, and are not closed.
+/// \param isometry Transformation to apply.
+/// \param input Descriptor to read the records from.
+/// \param output Descriptor to write the records to.
+/// \param stride Size in bytes of each record.
+/// \param offset Offset in bytes of the x coordinate within a record, which
+/// is followed by y and z, all of type P.
+/// \param options Buffering of the stream.
+/// \returns Number of points transformed.
+/// \throw std::invalid_argument When a record cannot hold the coordinates,
+/// there are fewer than 2 buffers or they cannot hold a record.
+/// \throw std::runtime_error When reading or writing fails, or the input
+/// ends within a record. The records transformed before are written.
+template <typename P, typename T>
+std::size_t streamTransform(const IsometryT<T>& isometry, const int input,
+                            const int output, const std::size_t stride,
+                            const std::size_t offset = 0,
+                            const StreamOptions& options = StreamOptions{}) {
+  return internal::streamTransform(
+      Matrix3T<P>(isometry.rotation()), Vector3T<P>(isometry.translation()),
+      input, output, stride, offset, options);
+}
+
+}  // namespace math
+}  // namespace ekumen
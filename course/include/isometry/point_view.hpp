@@ -0,0 +1,93 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to read 3-dimensional points in place from a buffer of
+ * fixed-size records, such as the vertices of a binary PLY or PCD file, where
+ * x, y and z are consecutive scalars at the same offset of every record and
+ * the rest of the record holds other fields.
+ *
+ * The view does not own the buffer and makes no assumption on its alignment,
+ * so records can be of any size and start at any byte.
+ */
+template <typename T>
+class PointViewT {
+ public:
+  /// \brief Scalar type of the coordinates.
+  using Scalar = T;
+
+  /// \brief Default constructor, creates an empty view.
+  PointViewT() = default;
+
+  /// \brief Constructs a view of `size` records.
+  /// \param data Pointer to the x coordinate of the first point, the buffer
+  /// must outlive the view.
+  /// \param size Number of points.
+  /// \param stride Distance in bytes between the records of two consecutive
+  /// points, at least 3 * sizeof(T).
+  PointViewT(const std::uint8_t* data, const std::size_t size,
+             const std::size_t stride)
+      : data_(data), size_(size), stride_(stride) {}
+
+  /// \brief Number of points.
+  std::size_t size() const { return size_; }
+
+  /// \brief Whether the view has no points.
+  bool empty() const { return size_ == 0; }
+
+  /// \brief Distance in bytes between the records of consecutive points.
+  std::size_t stride() const { return stride_; }
+
+  /// \brief Pointer to the x coordinate of the first point.
+  const std::uint8_t* data() const { return data_; }
+
+  /// \brief Reads a point.
+  /// \param index Point index.
+  /// \pre `index` is less than size(), it is not checked.
+  Vector3T<T> operator[](const std::size_t index) const {
+    T xyz[3];
+    std::memcpy(xyz, data_ + index * stride_, sizeof(xyz));
+    return Vector3T<T>(xyz[0], xyz[1], xyz[2]);
+  }
+
+  /// \brief View of a range of the points.
+  /// \param begin Index of the first point of the range.
+  /// \param count Number of points in the range.
+  /// \pre The range is within the view, it is not checked.
+  PointViewT subview(const std::size_t begin, const std::size_t count) const {
+    return PointViewT(data_ + begin * stride_, count, stride_);
+  }
+
+ private:
+  // Pointer to the x coordinate of the first point.
+  const std::uint8_t* data_{nullptr};
+
+  // Number of points.
+  std::size_t size_{0};
+
+  // Distance in bytes between consecutive records.
+  std::size_t stride_{3 * sizeof(T)};
+};
+
+/// \brief View of points of doubles.
+using PointView = PointViewT<double>;
+
+/// \brief View of points of floats.
+using PointViewf = PointViewT<float>;
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,359 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to represent a quaternion w + xi + yj + zk, mostly as a
+ * compact (4 scalars) and drift-free encoding of 3D rotations.
+ *
+ * Members documented as rotations assume a unit quaternion. Long chains of
+ * products slowly drift away from unit norm, which normalize() restores at
+ * the cost of a square root.
+ *
+ * It is explicitly instantiated for double (Quaternion) and float
+ * (Quaternionf).
+ */
+template <typename T>
+class QuaternionT {
+ public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
+  /// \brief Default constructor, creates the identity rotation.
+  constexpr QuaternionT();
+
+  /// \brief Constructor parametrized with the 4 components.
+  /// \param w Real part.
+  /// \param x First imaginary component.
+  /// \param y Second imaginary component.
+  /// \param z Third imaginary component.
+  constexpr QuaternionT(const T w, const T x, const T y, const T z);
+
+  /// \brief Converting constructor from a quaternion of another scalar type.
+  template <typename U>
+  constexpr explicit QuaternionT(const QuaternionT<U>& quaternion);
+
+  /// \brief Creates a rotation around an axis.
+  /// \param axis Rotation axis, it does not need to be normalized.
+  /// \param radians Number of radians to rotate around `axis`.
+  /// \returns A unit quaternion.
+  static QuaternionT fromAxisAngle(const Vector3T<T>& axis, const T radians);
+
+  /// \brief Creates the rotation described by a rotation matrix.
+  /// \param matrix An orthonormal matrix with determinant 1.
+  /// \returns A unit quaternion.
+  static QuaternionT fromRotationMatrix(const Matrix3T<T>& matrix);
+
+  /// \brief Converts this rotation to a rotation matrix.
+  /// \returns An orthonormal matrix.
+  constexpr Matrix3T<T> toRotationMatrix() const;
+
+  /// \brief Hamilton product, the composition of two rotations.
+  /// \returns A new quaternion.
+  constexpr QuaternionT operator*(const QuaternionT& quaternion) const;
+
+  /// \brief Hamilton product assign operator.
+  constexpr QuaternionT& operator*=(const QuaternionT& quaternion);
+
+  /// \brief Rotates a vector.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> operator*(const Vector3T<T>& vector) const;
+
+  /// \brief Rotates a vector as v + 2w(u x v) + 2u x (u x v), which is
+  /// cheaper than the two Hamilton products of q v q*.
+  /// \param vector A Vector3T.
+  /// \returns A new Vector3T.
+  constexpr Vector3T<T> rotate(const Vector3T<T>& vector) const;
+
+  /// \brief Calculates the conjugate w - xi - yj - zk.
+  constexpr QuaternionT conjugate() const;
+
+  /// \brief Calculates the inverse rotation.
+  ///
+  /// The quaternion is assumed to be a unit one, so the inverse is its
+  /// conjugate and no division is computed.
+  /// \returns A new quaternion.
+  constexpr QuaternionT inverse() const;
+
+  /// \brief Dot product between this and a given quaternion.
+  constexpr T dot(const QuaternionT& quaternion) const;
+
+  /// \brief Calculates the norm of this quaternion.
+  inline T norm() const;
+
+  /// \brief Calculates a unit quaternion with the direction of this one.
+  /// \returns A new quaternion.
+  inline QuaternionT normalized() const;
+
+  /// \brief Scales this quaternion to unit norm.
+  inline void normalize();
+
+  /// \brief Spherical linear interpolation towards another rotation, at a
+  /// constant angular velocity along the shorter arc.
+  /// \param quaternion Rotation reached at `t` = 1.
+  /// \param t Interpolation parameter, 0 yields this rotation.
+  /// \returns A new unit quaternion.
+  inline QuaternionT slerp(const QuaternionT& quaternion, const T t) const;
+
+  /// \brief Equals to operator.
+  ///
+  /// q and -q describe the same rotation, so they compare equal.
+  bool operator==(const QuaternionT& quaternion) const;
+
+  /// \brief Non-equals to operator.
+  bool operator!=(const QuaternionT& quaternion) const;
+
+  /// \brief Getter of the imaginary part.
+  /// \returns A Vector3T with x, y and z.
+  constexpr Vector3T<T> vec() const;
+
+  /// \brief Getter of w.
+  constexpr T w() const;
+
+  /// \brief Getter of x.
+  constexpr T x() const;
+
+  /// \brief Getter of y.
+  constexpr T y() const;
+
+  /// \brief Getter of z.
+  constexpr T z() const;
+
+  /// \brief Mutable getter of w.
+  constexpr T& w();
+
+  /// \brief Mutable getter of x.
+  constexpr T& x();
+
+  /// \brief Mutable getter of y.
+  constexpr T& y();
+
+  /// \brief Mutable getter of z.
+  constexpr T& z();
+
+  // Identity rotation, defined constexpr below.
+  static const QuaternionT kIdentity;
+
+ private:
+  // W, X, Y and Z values, in that order.
+  T data_[4];
+};
+
+// Defined constexpr once the class is complete, before it is instantiated.
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::kIdentity{
+    QuaternionT(T{1}, T{0}, T{0}, T{0})};
+
+/// \brief Quaternion of doubles.
+using Quaternion = QuaternionT<double>;
+
+/// \brief Quaternion of floats.
+using Quaternionf = QuaternionT<float>;
+
+// Trivially copyable and standard layout like Vector3T.
+static_assert(std::is_trivially_copyable<Quaternion>::value &&
+                  std::is_trivially_copyable<Quaternionf>::value,
+              "QuaternionT must be trivially copyable");
+static_assert(std::is_standard_layout<Quaternion>::value &&
+                  std::is_standard_layout<Quaternionf>::value,
+              "QuaternionT must be standard layout");
+
+/// \brief Free function implementation of the operator<<
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const QuaternionT<T>& quaternion);
+
+// Inline implementations of the hot paths, kept in the header so that callers
+// in other translation units can inline them.
+
+template <typename T>
+constexpr QuaternionT<T>::QuaternionT() : data_{T{1}, T{0}, T{0}, T{0}} {}
+
+template <typename T>
+constexpr QuaternionT<T>::QuaternionT(const T w, const T x, const T y,
+                                      const T z)
+    : data_{w, x, y, z} {}
+
+template <typename T>
+template <typename U>
+constexpr QuaternionT<T>::QuaternionT(const QuaternionT<U>& quaternion)
+    : data_{static_cast<T>(quaternion.w()), static_cast<T>(quaternion.x()),
+            static_cast<T>(quaternion.y()), static_cast<T>(quaternion.z())} {}
+
+template <typename T>
+constexpr Matrix3T<T> QuaternionT<T>::toRotationMatrix() const {
+  const T w = data_[0];
+  const T x = data_[1];
+  const T y = data_[2];
+  const T z = data_[3];
+  const T x2 = x + x;
+  const T y2 = y + y;
+  const T z2 = z + z;
+  return Matrix3T<T>(T{1} - y * y2 - z * z2, x * y2 - w * z2, x * z2 + w * y2,
+                     x * y2 + w * z2, T{1} - x * x2 - z * z2, y * z2 - w * x2,
+                     x * z2 - w * y2, y * z2 + w * x2, T{1} - x * x2 - y * y2);
+}
+
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::operator*(
+    const QuaternionT& quaternion) const {
+  const T* a = data_;
+  const T* b = quaternion.data_;
+  return QuaternionT(a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+                     a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+                     a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+                     a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0]);
+}
+
+template <typename T>
+constexpr QuaternionT<T>& QuaternionT<T>::operator*=(
+    const QuaternionT& quaternion) {
+  *this = *this * quaternion;
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T> QuaternionT<T>::operator*(
+    const Vector3T<T>& vector) const {
+  return rotate(vector);
+}
+
+template <typename T>
+constexpr Vector3T<T> QuaternionT<T>::rotate(const Vector3T<T>& vector) const {
+  const Vector3T<T> u = vec();
+  const Vector3T<T> t = u.cross(vector) * T{2};
+  return vector + t * data_[0] + u.cross(t);
+}
+
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::conjugate() const {
+  return QuaternionT(data_[0], -data_[1], -data_[2], -data_[3]);
+}
+
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::inverse() const {
+  return conjugate();
+}
+
+template <typename T>
+constexpr T QuaternionT<T>::dot(const QuaternionT& quaternion) const {
+  return data_[0] * quaternion.data_[0] + data_[1] * quaternion.data_[1] +
+         data_[2] * quaternion.data_[2] + data_[3] * quaternion.data_[3];
+}
+
+template <typename T>
+inline T QuaternionT<T>::norm() const {
+  return std::sqrt(dot(*this));
+}
+
+template <typename T>
+inline QuaternionT<T> QuaternionT<T>::normalized() const {
+  QuaternionT result{*this};
+  result.normalize();
+  return result;
+}
+
+template <typename T>
+inline void QuaternionT<T>::normalize() {
+  const T inverse_norm = T{1} / norm();
+  for (T& value : data_) {
+    value *= inverse_norm;
+  }
+}
+
+// q and -q are the same rotation, so the sign of `quaternion` is chosen to
+// make the dot product non-negative, which takes the shorter arc. Nearly equal
+// rotations fall back to a normalized linear interpolation, since sin(theta)
+// tends to 0 and the weights lose precision.
+template <typename T>
+inline QuaternionT<T> QuaternionT<T>::slerp(const QuaternionT& quaternion,
+                                            const T t) const {
+  T cos_theta = dot(quaternion);
+  const T sign = cos_theta < T{0} ? T{-1} : T{1};
+  cos_theta *= sign;
+  T a = T{1} - t;
+  T b = t;
+  if (cos_theta < T(0.9995)) {
+    const T theta = std::acos(cos_theta);
+    const T inverse_sin_theta = T{1} / std::sin(theta);
+    a = std::sin(a * theta) * inverse_sin_theta;
+    b = std::sin(b * theta) * inverse_sin_theta;
+  }
+  b *= sign;
+  const T* q = quaternion.data_;
+  QuaternionT result(a * data_[0] + b * q[0], a * data_[1] + b * q[1],
+                     a * data_[2] + b * q[2], a * data_[3] + b * q[3]);
+  if (cos_theta >= T(0.9995)) {
+    result.normalize();
+  }
+  return result;
+}
+
+template <typename T>
+constexpr Vector3T<T> QuaternionT<T>::vec() const {
+  return Vector3T<T>(data_[1], data_[2], data_[3]);
+}
+
+template <typename T>
+constexpr T QuaternionT<T>::w() const {
+  return data_[0];
+}
+
+template <typename T>
+constexpr T QuaternionT<T>::x() const {
+  return data_[1];
+}
+
+template <typename T>
+constexpr T QuaternionT<T>::y() const {
+  return data_[2];
+}
+
+template <typename T>
+constexpr T QuaternionT<T>::z() const {
+  return data_[3];
+}
+
+template <typename T>
+constexpr T& QuaternionT<T>::w() {
+  return data_[0];
+}
+
+template <typename T>
+constexpr T& QuaternionT<T>::x() {
+  return data_[1];
+}
+
+template <typename T>
+constexpr T& QuaternionT<T>::y() {
+  return data_[2];
+}
+
+template <typename T>
+constexpr T& QuaternionT<T>::z() {
+  return data_[3];
+}
+
+// The non-inline members are compiled once in the isometry library.
+extern template class QuaternionT<double>;
+extern template class QuaternionT<float>;
+extern template std::ostream& operator<<(
+    std::ostream& os, const QuaternionT<double>& quaternion);
+extern template std::ostream& operator<<(
+    std::ostream& os, const QuaternionT<float>& quaternion);
+
+}  // namespace math
+}  // namespace ekumen
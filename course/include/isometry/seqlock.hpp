@@ -0,0 +1,151 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <isometry/isometry.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/// \brief Describes how a value is stored in a SeqLock, as a fixed number of
+/// scalars. It is specialized for the types that can be published.
+template <typename T>
+struct SeqLockTraits;
+
+/// \brief SeqLock storage of a Vector3T, its 3 coordinates.
+template <typename S>
+struct SeqLockTraits<Vector3T<S>> {
+  using Scalar = S;
+  static constexpr std::size_t kSize{3};
+
+  static void pack(const Vector3T<S>& value, Scalar* scalars) {
+    for (std::size_t i = 0; i < kSize; ++i) {
+      scalars[i] = value[i];
+    }
+  }
+
+  static Vector3T<S> unpack(const Scalar* scalars) {
+    return Vector3T<S>(scalars[0], scalars[1], scalars[2]);
+  }
+};
+
+/// \brief SeqLock storage of an IsometryT, its translation followed by its
+/// rotation in row-major order.
+template <typename S>
+struct SeqLockTraits<IsometryT<S>> {
+  using Scalar = S;
+  static constexpr std::size_t kSize{12};
+
+  static void pack(const IsometryT<S>& value, Scalar* scalars) {
+    for (std::size_t r = 0; r < 3; ++r) {
+      scalars[r] = value.translation()[r];
+      for (std::size_t c = 0; c < 3; ++c) {
+        scalars[3 + 3 * r + c] = value.rotation()(r, c);
+      }
+    }
+  }
+
+  static IsometryT<S> unpack(const Scalar* scalars) {
+    return IsometryT<S>(
+        Vector3T<S>(scalars[0], scalars[1], scalars[2]),
+        Matrix3T<S>(scalars[3], scalars[4], scalars[5], scalars[6],
+                    scalars[7], scalars[8], scalars[9], scalars[10],
+                    scalars[11]));
+  }
+};
+
+/**
+ * This class is used to publish the latest value of a Vector3T or an
+ * IsometryT from one writer thread to any number of reader threads, without
+ * locks.
+ *
+ * It is a sequence lock: the writer makes a sequence counter odd, stores the
+ * value and makes the counter even again, while readers copy the value and
+ * retry if the counter was odd or changed meanwhile. Writers never wait, and
+ * readers never block each other nor the writer; a reader only retries when
+ * its copy overlaps a store, which for a writer at a few hundred Hz almost
+ * never happens. Every read returns a value that was stored as a whole, never
+ * a mix of two stores.
+ *
+ * The value is kept as relaxed atomic scalars, so concurrent reads and writes
+ * are well defined, and relaxed atomic loads and stores of doubles compile to
+ * plain moves on the usual 64-bit targets.
+ *
+ * Only one thread may call store() at a time.
+ */
+template <typename T>
+class SeqLock {
+ public:
+  using Traits = SeqLockTraits<T>;
+  using Scalar = typename Traits::Scalar;
+
+  /// \brief Constructs a SeqLock holding `value`.
+  explicit SeqLock(const T& value = T()) { write(value); }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  /// \brief Publishes a new value. It must not be called concurrently with
+  /// itself.
+  /// \param value Value returned by later loads.
+  void store(const T& value) {
+    const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    // Keeps the stores of the value from being seen before the odd counter.
+    std::atomic_thread_fence(std::memory_order_release);
+    write(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /// \brief Reads the latest published value.
+  /// \returns A copy of a value passed to the constructor or to store().
+  T load() const {
+    Scalar scalars[Traits::kSize];
+    std::uint64_t before;
+    std::uint64_t after;
+    do {
+      before = sequence_.load(std::memory_order_acquire);
+      for (std::size_t i = 0; i < Traits::kSize; ++i) {
+        scalars[i] = data_[i].load(std::memory_order_relaxed);
+      }
+      // Keeps the loads of the value from being moved after the counter
+      // check.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    return Traits::unpack(scalars);
+  }
+
+  /// \brief Number of calls to store() so far.
+  std::uint64_t version() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  /// \brief Stores the scalars of `value`, without touching the counter.
+  void write(const T& value) {
+    Scalar scalars[Traits::kSize];
+    Traits::pack(value, scalars);
+    for (std::size_t i = 0; i < Traits::kSize; ++i) {
+      data_[i].store(scalars[i], std::memory_order_relaxed);
+    }
+  }
+
+  // The counter and the value start a cache line of their own, so that
+  // neighbouring data written by other threads does not invalidate them.
+  alignas(64) std::atomic<std::uint64_t> sequence_{0};
+  std::atomic<Scalar> data_[Traits::kSize];
+};
+
+}  // namespace math
+}  // namespace ekumen
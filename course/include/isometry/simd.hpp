@@ -0,0 +1,97 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ekumen {
+namespace math {
+
+template <typename T>
+class Vector3T;
+
+template <typename T>
+class Matrix3T;
+
+/// \brief Instruction sets the batch kernels are compiled for, from the
+/// narrowest to the widest.
+///
+/// Every level computes bit-identical results: the kernels evaluate the same
+/// expressions in the same order and never contract them into fused
+/// multiply-adds, so a fleet of mixed hosts agrees on every output. Builds
+/// with ISOMETRY_ENABLE_AVX2 contract at every level instead, like the code
+/// inlined from the headers.
+enum class SimdLevel {
+  /// Not vectorized. On architectures other than x86 it is the only level,
+  /// and is vectorized for the default instruction set of the target.
+  kScalar,
+  /// 128-bit vectors, the baseline of x86-64.
+  kSse2,
+  /// 256-bit vectors.
+  kAvx2,
+  /// 512-bit vectors, with AVX-512F.
+  kAvx512,
+};
+
+/// \brief Widest level that the host CPU and operating system support.
+SimdLevel supportedSimdLevel();
+
+/// \brief Level that the batch kernels run at, chosen on first use.
+///
+/// It is supportedSimdLevel(), unless the ISOMETRY_SIMD environment variable
+/// names a level (see toString()), which is used instead when it is
+/// supported. A level the host does not support is lowered to
+/// supportedSimdLevel(), and an unknown name is ignored, both with a warning
+/// on stderr.
+SimdLevel activeSimdLevel();
+
+/// \brief Name of a level: "scalar", "sse2", "avx2" or "avx512".
+const char* toString(const SimdLevel level);
+
+/// \brief Reads a level from its name, as returned by toString().
+/// \param name Name of the level.
+/// \param level Storage for the level, untouched when `name` is unknown.
+/// \returns Whether `name` is the name of a level.
+bool parseSimdLevel(const std::string& name, SimdLevel* level);
+
+namespace internal {
+
+/// \brief Batch kernels compiled for one SimdLevel, with the contracts of
+/// the overloads of internal::transformPoints().
+template <typename T>
+struct SimdKernels {
+  void (*transform)(const Matrix3T<T>& rotation,
+                    const Vector3T<T>& translation, const T* input,
+                    const std::size_t count, T* output);
+  void (*transform_planar)(const Matrix3T<T>& rotation,
+                           const Vector3T<T>& translation, const T* x,
+                           const T* y, const T* z, const std::size_t count,
+                           T* out_x, T* out_y, T* out_z);
+  void (*transform_strided)(const Matrix3T<T>& rotation,
+                            const Vector3T<T>& translation,
+                            const std::uint8_t* input,
+                            const std::size_t stride, const std::size_t count,
+                            T* output);
+};
+
+/// \brief Kernels compiled for a level.
+///
+/// Compiled in the isometry library for float and double.
+/// \param level Level of the kernels, lowered to supportedSimdLevel() when
+/// the host does not support it.
+template <typename T>
+const SimdKernels<T>& simdKernels(const SimdLevel level);
+
+/// \brief Kernels of activeSimdLevel(), which the batch operations run.
+template <typename T>
+const SimdKernels<T>& simdKernels();
+
+}  // namespace internal
+}  // namespace math
+}  // namespace ekumen
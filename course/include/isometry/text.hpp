@@ -0,0 +1,115 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+#include <isometry/isometry.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * Round-trip text formatting and parsing of the double precision types, in
+ * the layout of their operator<<:
+ *
+ * - Vector3: (x: 1, y: 2, z: 3)
+ * - Matrix3: [[1, 2, 3], [4, 5, 6], [7, 8, 9]]
+ * - Isometry: [T: (x: 1, y: 2, z: 3), R:[[1, 0, 0], [0, 1, 0], [0, 0, 1]]]
+ *
+ * Numbers are written with the fewest digits that parse back to the same
+ * double, so format() followed by parse() reproduces every value exactly.
+ * Both work on caller buffers, never allocate, and do not depend on the
+ * locale nor on any stream state.
+ */
+namespace text {
+
+/// \brief Maximum length of a formatted double, as in -1.2345678901234567e-308.
+constexpr std::size_t kMaxDoubleLength{24};
+
+/// \brief Maximum length of a formatted Vector3.
+constexpr std::size_t kMaxVector3Length{15 + 3 * kMaxDoubleLength};
+
+/// \brief Maximum length of a formatted Matrix3.
+constexpr std::size_t kMaxMatrix3Length{24 + 9 * kMaxDoubleLength};
+
+/// \brief Maximum length of a formatted Isometry.
+constexpr std::size_t kMaxIsometryLength{9 + kMaxVector3Length +
+                                         kMaxMatrix3Length};
+
+/// \brief Writes the shortest text that parses back to `value`.
+///
+/// Magnitudes in [1e-5, 1e17) are written in fixed notation, others in
+/// scientific notation, as in 1e-300. Infinities and NaN are written as inf,
+/// -inf and nan.
+/// \param value Value to format.
+/// \param first Start of the buffer.
+/// \param last End of the buffer.
+/// \returns One past the last written character, or nullptr if the text does
+/// not fit in the buffer or `first` is nullptr, so that calls can be chained.
+/// Nothing is null-terminated.
+char* format(const double value, char* first, char* last);
+
+/// \brief Writes a Vector3 as (x: 1, y: 2, z: 3).
+/// \see format(double, char*, char*)
+char* format(const Vector3& vector, char* first, char* last);
+
+/// \brief Writes a Matrix3 as [[1, 2, 3], [4, 5, 6], [7, 8, 9]].
+/// \see format(double, char*, char*)
+char* format(const Matrix3& matrix, char* first, char* last);
+
+/// \brief Writes an Isometry as [T: <Vector3>, R:<Matrix3>].
+/// \see format(double, char*, char*)
+char* format(const Isometry& isometry, char* first, char* last);
+
+/// \brief Parses a number written by format(), or any decimal number in
+/// fixed or scientific notation, inf or nan, with an optional sign.
+///
+/// The result is correctly rounded, as with strtod, whatever the number of
+/// digits.
+/// \param first Start of the text.
+/// \param last End of the text.
+/// \param value Output, only written on success.
+/// \returns One past the last parsed character, or nullptr if the text does
+/// not start with a number. Leading whitespace is skipped.
+const char* parse(const char* first, const char* last, double* value);
+
+/// \brief Parses a Vector3 in the format() layout. Whitespace between tokens
+/// is optional.
+/// \see parse(const char*, const char*, double*)
+const char* parse(const char* first, const char* last, Vector3* vector);
+
+/// \brief Parses a Matrix3 in the format() layout. Whitespace between tokens
+/// is optional.
+/// \see parse(const char*, const char*, double*)
+const char* parse(const char* first, const char* last, Matrix3* matrix);
+
+/// \brief Parses an Isometry in the format() layout. Whitespace between
+/// tokens is optional.
+/// \see parse(const char*, const char*, double*)
+const char* parse(const char* first, const char* last, Isometry* isometry);
+
+}  // namespace text
+
+/// \brief Reads a Vector3 in the text::format() layout, setting failbit on
+/// malformed input.
+std::istream& operator>>(std::istream& is, Vector3& vector);
+
+/// \brief Reads a Matrix3 in the text::format() layout, setting failbit on
+/// malformed input.
+std::istream& operator>>(std::istream& is, Matrix3& matrix);
+
+/// \brief Reads an Isometry in the text::format() layout, which is also the
+/// one of operator<<, setting failbit on malformed input.
+std::istream& operator>>(std::istream& is, Isometry& isometry);
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,115 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to run data parallel loops on a fixed set of threads,
+ * which are started once and reused by every loop, so that a loop does not pay
+ * for spawning threads.
+ *
+ * Loops are statically partitioned: the range is split into at most one
+ * contiguous chunk per thread, each a multiple of the requested grain, and
+ * the calling thread processes the first chunk itself.
+ *
+ * Loops may be started from any thread but run one at a time, and a loop body
+ * must not start another loop on the same pool.
+ */
+class ThreadPool {
+ public:
+  /// \brief Constructs a pool and starts its threads.
+  /// \param threads Number of threads that run a loop, counting the calling
+  /// one, so `threads` - 1 threads are started. 0 means one per hardware
+  /// thread.
+  explicit ThreadPool(const std::size_t threads = 0);
+
+  /// \brief Stops and joins the threads.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// \brief Number of threads that run a loop, counting the calling one.
+  std::size_t size() const;
+
+  /// \brief Calls `body` over consecutive chunks of [0, `count`) in parallel
+  /// and waits for all of them to finish.
+  /// \param count Number of indices.
+  /// \param grain Every chunk but the last one holds a multiple of `grain`
+  /// indices, and a range of fewer than 2 * `grain` indices runs on the
+  /// calling thread alone.
+  /// \param body Callable as body(begin, end) for each chunk [begin, end).
+  /// \throw Rethrows the first exception thrown by `body`, after every chunk
+  /// has finished.
+  template <typename F>
+  void parallelFor(const std::size_t count, const std::size_t grain,
+                   F&& body);
+
+ private:
+  /// \brief Runs task(i) for i in [0, `tasks`), task 0 on the calling thread
+  /// and the others on the pool threads, and waits for all of them.
+  /// \pre `tasks` is not greater than size().
+  void run(const std::size_t tasks,
+           const std::function<void(std::size_t)>& task);
+
+  /// \brief Body of the pool thread that runs task `index` of every loop.
+  void work(const std::size_t index);
+
+  std::vector<std::thread> threads_;
+  // Serializes the loops.
+  std::mutex run_mutex_;
+  // Guards every member below, which describe the current loop.
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t)>* task_{nullptr};
+  std::size_t tasks_{0};
+  std::size_t pending_{0};
+  std::size_t generation_{0};
+  std::exception_ptr error_;
+  bool stop_{false};
+};
+
+template <typename F>
+void ThreadPool::parallelFor(const std::size_t count, const std::size_t grain,
+                             F&& body) {
+  if (count == 0) {
+    return;
+  }
+  const std::size_t step = std::max<std::size_t>(grain, 1);
+  // Same as count < 2 * step, without overflowing for huge grains.
+  if (count / 2 < step) {
+    body(std::size_t{0}, count);
+    return;
+  }
+  const std::size_t blocks = (count + step - 1) / step;
+  const std::size_t threads = std::min(blocks, size());
+  const std::size_t chunk = (blocks + threads - 1) / threads * step;
+  const std::size_t chunks = (count + chunk - 1) / chunk;
+  if (chunks == 1) {
+    body(std::size_t{0}, count);
+    return;
+  }
+  run(chunks, [&body, chunk, count](const std::size_t index) {
+    const std::size_t begin = index * chunk;
+    body(begin, std::min(begin + chunk, count));
+  });
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,97 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/quaternion.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This class is used to represent the recent history of a transform, as a
+ * fixed number of time-stamped samples, so that it can be queried at any time
+ * covered by the history and not only at the latest sample.
+ *
+ * Samples live in a ring preallocated on construction: once it is full, every
+ * insertion overwrites the oldest sample, and neither insertions nor lookups
+ * allocate memory. Lookups binary search the sample times and interpolate
+ * between the two samples around the requested time, linearly for the
+ * translation and spherically (slerp) for the rotation.
+ */
+class TransformBuffer {
+ public:
+  /// \brief Constructs an empty buffer.
+  /// \param capacity Maximum number of samples kept.
+  /// \throw std::invalid_argument When `capacity` is 0.
+  explicit TransformBuffer(const std::size_t capacity);
+
+  /// \brief Appends a sample, dropping the oldest one if the buffer is full.
+  /// \param time Time of the sample, it must be later than every stored one.
+  /// \param transform Value of the transform at `time`.
+  /// \throw std::invalid_argument When `time` is not later than newestTime().
+  void insert(const double time, const Isometry& transform);
+
+  /// \brief Computes the transform at a given time.
+  /// \param time Time to query, between oldestTime() and newestTime().
+  /// \returns The stored sample when `time` matches it exactly, otherwise the
+  /// interpolation of the samples before and after `time`.
+  /// \throw std::out_of_range When the buffer is empty or `time` is outside
+  /// the stored history.
+  Isometry lookup(const double time) const;
+
+  /// \brief Latest sample.
+  /// \throw std::out_of_range When the buffer is empty.
+  const Isometry& latest() const;
+
+  /// \brief Time of the oldest sample.
+  /// \throw std::out_of_range When the buffer is empty.
+  double oldestTime() const;
+
+  /// \brief Time of the newest sample.
+  /// \throw std::out_of_range When the buffer is empty.
+  double newestTime() const;
+
+  /// \brief Drops every sample, keeping the allocated storage.
+  void clear();
+
+  /// \brief Number of stored samples.
+  std::size_t size() const;
+
+  /// \brief Maximum number of samples kept.
+  std::size_t capacity() const;
+
+  /// \brief Whether no sample is stored.
+  bool empty() const;
+
+ private:
+  // A stored transform, with its rotation already converted for slerp.
+  struct Sample {
+    Isometry transform;
+    Quaternion rotation;
+  };
+
+  /// \brief Position in the ring of the `index`-th oldest sample.
+  std::size_t slot(const std::size_t index) const;
+
+  /// \brief Throws std::out_of_range if the buffer is empty.
+  void checkNotEmpty() const;
+
+  // Sample times, apart from the samples so that the binary search touches as
+  // few cache lines as possible.
+  std::vector<double> times_;
+  std::vector<Sample> samples_;
+  // Position in the ring of the oldest sample.
+  std::size_t head_{0};
+  std::size_t size_{0};
+};
+
+}  // namespace math
+}  // namespace ekumen
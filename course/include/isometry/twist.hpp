@@ -0,0 +1,53 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include <isometry/vector3.hpp>
+
+namespace ekumen {
+namespace math {
+
+/**
+ * This struct is used to hold an element of the Lie algebra se(3), the
+ * tangent space of rigid transformations: a rotation vector and a translation
+ * velocity, which IsometryT::exp() integrates over a unit of time.
+ *
+ * Twists can be added, scaled and interpolated linearly, unlike isometries,
+ * which makes them the usual parametrization of pose increments in
+ * estimation and control.
+ */
+template <typename T>
+struct TwistT {
+  /// \brief Scalar type of the components.
+  using Scalar = T;
+
+  /// \brief Translation velocity, in the frame the rotation starts from.
+  Vector3T<T> linear;
+
+  /// \brief Rotation vector: the rotation axis scaled by the angle in
+  /// radians.
+  Vector3T<T> angular;
+};
+
+/// \brief Twist of doubles.
+using Twist = TwistT<double>;
+
+/// \brief Twist of floats.
+using Twistf = TwistT<float>;
+
+// Trivially copyable and standard layout like Vector3T.
+static_assert(std::is_trivially_copyable<Twist>::value &&
+                  std::is_trivially_copyable<Twistf>::value,
+              "TwistT must be trivially copyable");
+static_assert(std::is_standard_layout<Twist>::value &&
+                  std::is_standard_layout<Twistf>::value,
+              "TwistT must be standard layout");
+
+}  // namespace math
+}  // namespace ekumen
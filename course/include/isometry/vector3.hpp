@@ -8,139 +8,406 @@
 
 #include <cmath>
 #include <initializer_list>
-#include <iostream>
+#include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+
+#include <isometry/error.hpp>
 
 namespace ekumen {
 
 namespace math {
 
 /**
- * This class is used to represent a 3-dimensional vector of doubles.
+ * This class is used to represent a 3-dimensional vector of scalars.
+ *
+ * It is explicitly instantiated for double (Vector3) and float (Vector3f).
  */
-class Vector3 {
+template <typename T>
+class Vector3T {
  public:
+  /// \brief Scalar type of the elements.
+  using Scalar = T;
+
   /// \brief Default constructor.
-  Vector3();
+  constexpr Vector3T() noexcept;
 
-  /// \brief Constructor parametrized with 3 doubles.
-  Vector3(const double x, const double y, const double z);
+  /// \brief Constructor parametrized with 3 scalars.
+  constexpr Vector3T(const T x, const T y, const T z) noexcept;
 
   /// \brief Constructor parametrized with an initializer list.
   /// \throw std::out_of_range When size of initializer list is different to 3.
-  explicit Vector3(std::initializer_list<double> list);
+  explicit Vector3T(std::initializer_list<T> list);
+
+  /// \brief Converting constructor from a vector of another scalar type.
+  template <typename U>
+  constexpr explicit Vector3T(const Vector3T<U>& vector) noexcept;
 
   /// \brief Const implementation of the sum operator.
-  Vector3 operator+(const Vector3& vector) const;
+  constexpr Vector3T operator+(const Vector3T& vector) const noexcept;
 
   /// \brief Const implementation of the sub operator.
-  Vector3 operator-(const Vector3& vector) const;
+  constexpr Vector3T operator-(const Vector3T& vector) const noexcept;
 
   /// \brief Const implementation of the mult operator.
-  Vector3 operator*(const Vector3& vector) const;
+  constexpr Vector3T operator*(const Vector3T& vector) const noexcept;
 
-  /// \brief Const implementation of the mult times double operator.
-  Vector3 operator*(double scalar) const;
+  /// \brief Const implementation of the mult times scalar operator.
+  constexpr Vector3T operator*(T scalar) const noexcept;
 
-  /// \brief Const implementation of the over integer operator.
-  Vector3 operator/(const Vector3& vector) const;
+  /// \brief Const implementation of the over vector operator.
+  constexpr Vector3T operator/(const Vector3T& vector) const noexcept;
 
-  /// \brief Const implementation of the mult times double operator.
-  Vector3 operator/(double scalar) const;
+  /// \brief Const implementation of the over scalar operator.
+  constexpr Vector3T operator/(T scalar) const noexcept;
 
   /// \brief Non const implementation of the plus assign operator.
-  Vector3& operator+=(const Vector3& vector);
+  constexpr Vector3T& operator+=(const Vector3T& vector) noexcept;
 
   /// \brief Non const implementation of the minus assign operator.
-  Vector3& operator-=(const Vector3& vector);
+  constexpr Vector3T& operator-=(const Vector3T& vector) noexcept;
 
   /// \brief Non const implementation of the mult times vector assign operator.
-  Vector3& operator*=(const Vector3& vector);
+  constexpr Vector3T& operator*=(const Vector3T& vector) noexcept;
 
-  /// \brief Non const implementation of the mult times double assign operator.
-  Vector3& operator*=(const double scalar);
+  /// \brief Non const implementation of the mult times scalar assign operator.
+  constexpr Vector3T& operator*=(const T scalar) noexcept;
 
   /// \brief Non const implementation of the divide over vector assign operator.
-  Vector3& operator/=(const Vector3& vector);
+  constexpr Vector3T& operator/=(const Vector3T& vector) noexcept;
 
-  /// \brief Non const implementation of the divide over double assign operator.
-  Vector3& operator/=(const double scalar);
+  /// \brief Non const implementation of the divide over scalar assign operator.
+  constexpr Vector3T& operator/=(const T scalar) noexcept;
 
   /// \brief Equals to operator.
-  bool operator==(const Vector3& vector) const;
+  bool operator==(const Vector3T& vector) const;
 
   /// \brief Non-equals to operator.
-  bool operator!=(const Vector3& vector) const;
+  bool operator!=(const Vector3T& vector) const;
 
   /// \brief Const implementation of the [] accessor.
   /// \return An rval copy of the requested field.
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  double operator[](const int index) const;
+  constexpr T operator[](const int index) const;
 
   /// \brief Non-const implementation of the [] accessor.
   /// \return A mutable reference to the requested field.
   /// \throw std::out_of_range When `index` is less than 0 or greater than 2.
-  double& operator[](const int index);
+  constexpr T& operator[](const int index);
+
+  /// \brief Const implementation of the unchecked accessor.
+  /// \return An rval copy of the requested field.
+  /// \pre `index` is in the range [0, 2], it is not checked.
+  constexpr T at(const int index) const noexcept;
+
+  /// \brief Non-const implementation of the unchecked accessor.
+  /// \return A mutable reference to the requested field.
+  /// \pre `index` is in the range [0, 2], it is not checked.
+  constexpr T& at(const int index) noexcept;
+
+  /// \brief Const access to the contiguous x, y, z storage.
+  /// \return A pointer to the first of the 3 elements.
+  constexpr const T* data() const noexcept;
+
+  /// \brief Mutable access to the contiguous x, y, z storage.
+  /// \return A pointer to the first of the 3 elements.
+  constexpr T* data() noexcept;
 
   /// \brief Dot product between this and a given vector.
-  double dot(const Vector3& vector) const;
+  constexpr T dot(const Vector3T& vector) const noexcept;
 
   /// \brief Cross product between this and a given vector.
-  Vector3 cross(const Vector3& vector) const;
+  constexpr Vector3T cross(const Vector3T& vector) const noexcept;
 
   /// \brief Calculates the norm of this vector.
   /// \return The norm of the vector.
-  double norm() const;
+  inline T norm() const noexcept;
 
   /// \brief Getter of x.
   /// \return An rval copy of x.
-  double x() const;
+  constexpr T x() const noexcept;
 
   /// \brief Getter of y.
   /// \return An rval copy of y.
-  double y() const;
+  constexpr T y() const noexcept;
 
   /// \brief Getter of z.
   /// \return An rval copy of z.
-  double z() const;
+  constexpr T z() const noexcept;
 
   /// \brief Getter of x.
   /// \return A mutable reference to x.
-  double& x();
+  constexpr T& x() noexcept;
 
   /// \brief Getter of y.
   /// \return A mutable reference to y.
-  double& y();
+  constexpr T& y() noexcept;
 
   /// \brief Getter of z.
   /// \return A mutable reference to z.
-  double& z();
+  constexpr T& z() noexcept;
 
-  // Null vector.
-  static const Vector3 kZero;
+  // Null vector, defined constexpr below like the other constants.
+  static const Vector3T kZero;
 
   // Unit vectors along the 3 axis.
-  static const Vector3 kUnitX;
-  static const Vector3 kUnitY;
-  static const Vector3 kUnitZ;
+  static const Vector3T kUnitX;
+  static const Vector3T kUnitY;
+  static const Vector3T kUnitZ;
 
  private:
-  // X value.
-  double x_;
-
-  // Y value.
-  double y_;
-
-  // Z value.
-  double z_;
+  // X, Y and Z values, in that order.
+  T data_[3];
 };
 
+// The constants can only be constexpr once the class is complete, and must be
+// defined before anything instantiates it, like the assertions below, for
+// GCC to use them in constant expressions.
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::kZero{Vector3T(T{0}, T{0}, T{0})};
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::kUnitX{Vector3T(T{1}, T{0}, T{0})};
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::kUnitY{Vector3T(T{0}, T{1}, T{0})};
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::kUnitZ{Vector3T(T{0}, T{0}, T{1})};
+
+/// \brief Vector of doubles.
+using Vector3 = Vector3T<double>;
+
+/// \brief Vector of floats.
+using Vector3f = Vector3T<float>;
+
+// Value types are trivially copyable, so that containers and std::copy move
+// arrays of them with memcpy, and standard layout, so that they can be
+// placed in shared memory or lock-free slots as raw bytes.
+static_assert(std::is_trivially_copyable<Vector3>::value &&
+                  std::is_trivially_copyable<Vector3f>::value,
+              "Vector3T must be trivially copyable");
+
 /// \brief Free function implementation of the operator*
-Vector3 operator*(double scalar, const Vector3& vector);
+template <typename T>
+constexpr Vector3T<T> operator*(typename Vector3T<T>::Scalar scalar,
+                                const Vector3T<T>& vector) noexcept;
 
 /// \brief Free function implementation of the operator<<
-std::ostream& operator<<(std::ostream& os, const Vector3& vector);
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Vector3T<T>& vector);
+
+// Inline implementations of the hot paths, kept in the header so that callers
+// in other translation units can inline them.
+
+template <typename T>
+constexpr Vector3T<T>::Vector3T() noexcept : data_{T{0}, T{0}, T{0}} {}
+
+template <typename T>
+constexpr Vector3T<T>::Vector3T(const T x, const T y, const T z) noexcept
+    : data_{x, y, z} {}
+
+template <typename T>
+template <typename U>
+constexpr Vector3T<T>::Vector3T(const Vector3T<U>& vector) noexcept
+    : data_{static_cast<T>(vector.x()), static_cast<T>(vector.y()),
+            static_cast<T>(vector.z())} {}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator+(
+    const Vector3T& vector) const noexcept {
+  Vector3T aux{*this};
+  aux += vector;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator-(
+    const Vector3T& vector) const noexcept {
+  Vector3T aux{*this};
+  aux -= vector;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator*(
+    const Vector3T& vector) const noexcept {
+  Vector3T aux{*this};
+  aux *= vector;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator*(T scalar) const noexcept {
+  Vector3T aux{*this};
+  aux *= scalar;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> operator*(typename Vector3T<T>::Scalar scalar,
+                                const Vector3T<T>& vector) noexcept {
+  return vector * scalar;
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator/(
+    const Vector3T& vector) const noexcept {
+  Vector3T aux{*this};
+  aux /= vector;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::operator/(T scalar) const noexcept {
+  Vector3T aux{*this};
+  aux /= scalar;
+  return aux;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator+=(
+    const Vector3T& vector) noexcept {
+  for (int i = 0; i < 3; ++i) {
+    data_[i] += vector.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator-=(
+    const Vector3T& vector) noexcept {
+  for (int i = 0; i < 3; ++i) {
+    data_[i] -= vector.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator*=(
+    const Vector3T& vector) noexcept {
+  for (int i = 0; i < 3; ++i) {
+    data_[i] *= vector.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator*=(const T scalar) noexcept {
+  for (T& value : data_) {
+    value *= scalar;
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator/=(
+    const Vector3T& vector) noexcept {
+  for (int i = 0; i < 3; ++i) {
+    data_[i] /= vector.data_[i];
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr Vector3T<T>& Vector3T<T>::operator/=(const T scalar) noexcept {
+  for (T& value : data_) {
+    value /= scalar;
+  }
+  return *this;
+}
+
+template <typename T>
+constexpr T Vector3T<T>::operator[](const int index) const {
+  if (index < 0 || index > 2) {
+    internal::fail<std::out_of_range>("Vector3 has only 3 elements");
+  }
+  return data_[index];
+}
+
+template <typename T>
+constexpr T& Vector3T<T>::operator[](const int index) {
+  if (index < 0 || index > 2) {
+    internal::fail<std::out_of_range>("Vector3 has only 3 elements");
+  }
+  return data_[index];
+}
+
+template <typename T>
+constexpr T Vector3T<T>::at(const int index) const noexcept {
+  return data_[index];
+}
+
+template <typename T>
+constexpr T& Vector3T<T>::at(const int index) noexcept {
+  return data_[index];
+}
+
+template <typename T>
+constexpr const T* Vector3T<T>::data() const noexcept {
+  return data_;
+}
+
+template <typename T>
+constexpr T* Vector3T<T>::data() noexcept {
+  return data_;
+}
+
+template <typename T>
+constexpr T Vector3T<T>::dot(const Vector3T& vector) const noexcept {
+  return data_[0] * vector.data_[0] + data_[1] * vector.data_[1] +
+         data_[2] * vector.data_[2];
+}
+
+template <typename T>
+constexpr Vector3T<T> Vector3T<T>::cross(
+    const Vector3T& vector) const noexcept {
+  return Vector3T(y() * vector.z() - z() * vector.y(),
+                  z() * vector.x() - x() * vector.z(),
+                  x() * vector.y() - y() * vector.x());
+}
+
+template <typename T>
+inline T Vector3T<T>::norm() const noexcept {
+  return std::sqrt(dot(*this));
+}
+
+template <typename T>
+constexpr T Vector3T<T>::x() const noexcept {
+  return data_[0];
+}
+
+template <typename T>
+constexpr T Vector3T<T>::y() const noexcept {
+  return data_[1];
+}
+
+template <typename T>
+constexpr T Vector3T<T>::z() const noexcept {
+  return data_[2];
+}
+
+template <typename T>
+constexpr T& Vector3T<T>::x() noexcept {
+  return data_[0];
+}
+
+template <typename T>
+constexpr T& Vector3T<T>::y() noexcept {
+  return data_[1];
+}
+
+template <typename T>
+constexpr T& Vector3T<T>::z() noexcept {
+  return data_[2];
+}
+
+// The non-inline members are compiled once in the isometry library.
+extern template class Vector3T<double>;
+extern template class Vector3T<float>;
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const Vector3T<double>& vector);
+extern template std::ostream& operator<<(std::ostream& os,
+                                         const Vector3T<float>& vector);
 
 }  // namespace math
 }  // namespace ekumen
@@ -0,0 +1,196 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <isometry/error.hpp>
+#include <isometry/frame_graph.hpp>
+
+namespace ekumen {
+namespace math {
+
+namespace {
+
+// FNV-1a hash of a name.
+std::uint64_t hashName(const char* name, const std::size_t length) {
+  std::uint64_t hash{14695981039346656037u};
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 1099511628211u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+constexpr FrameGraph::FrameId FrameGraph::kNoParent;
+
+FrameGraph::FrameId FrameGraph::addFrame(const std::string& name) {
+  return insert(name, kNoParent, Isometry(Vector3::kZero, Matrix3::kIdentity),
+                0);
+}
+
+FrameGraph::FrameId FrameGraph::addFrame(const std::string& name,
+                                         const FrameId parent,
+                                         const Isometry& transform) {
+  checkFrame(parent);
+  return insert(name, parent, transform, nodes_[parent].depth + 1);
+}
+
+FrameGraph::FrameId FrameGraph::addFrame(const std::string& name,
+                                         const std::string& parent,
+                                         const Isometry& transform) {
+  return addFrame(name, id(parent), transform);
+}
+
+void FrameGraph::setTransform(const FrameId frame, const Isometry& transform) {
+  checkFrame(frame);
+  if (nodes_[frame].parent == kNoParent) {
+    internal::fail<std::invalid_argument>("Root frame " + names_[frame] +
+                                          " has no parent transform");
+  }
+  nodes_[frame].transform = transform;
+}
+
+void FrameGraph::setTransform(const std::string& frame,
+                              const Isometry& transform) {
+  setTransform(id(frame), transform);
+}
+
+// Both frames are first walked up to the same depth, then together until they
+// meet. Along the way `from_source` accumulates ancestor_T_source and
+// `from_target` accumulates ancestor_T_target, so the result is
+// (ancestor_T_target)^-1 * ancestor_T_source.
+Isometry FrameGraph::lookup(const FrameId source, const FrameId target) const {
+  checkFrame(source);
+  checkFrame(target);
+  Isometry from_source{Vector3::kZero, Matrix3::kIdentity};
+  Isometry from_target{Vector3::kZero, Matrix3::kIdentity};
+  FrameId a = source;
+  FrameId b = target;
+  while (nodes_[a].depth > nodes_[b].depth) {
+    from_source = nodes_[a].transform * from_source;
+    a = nodes_[a].parent;
+  }
+  while (nodes_[b].depth > nodes_[a].depth) {
+    from_target = nodes_[b].transform * from_target;
+    b = nodes_[b].parent;
+  }
+  while (a != b) {
+    if (nodes_[a].parent == kNoParent) {
+      internal::fail<std::runtime_error>("Frames " + names_[source] +
+                                         " and " + names_[target] +
+                                         " are not connected");
+    }
+    from_source = nodes_[a].transform * from_source;
+    from_target = nodes_[b].transform * from_target;
+    a = nodes_[a].parent;
+    b = nodes_[b].parent;
+  }
+  return from_target.inverse() * from_source;
+}
+
+Isometry FrameGraph::lookup(const std::string& source,
+                            const std::string& target) const {
+  return lookup(id(source), id(target));
+}
+
+FrameGraph::FrameId FrameGraph::id(const std::string& name) const {
+  return findOrFail(name.data(), name.size());
+}
+
+bool FrameGraph::contains(const std::string& name) const {
+  return find(name.data(), name.size()) != kNoParent;
+}
+
+const std::string& FrameGraph::name(const FrameId frame) const {
+  checkFrame(frame);
+  return names_[frame];
+}
+
+FrameGraph::FrameId FrameGraph::parent(const FrameId frame) const {
+  checkFrame(frame);
+  return nodes_[frame].parent;
+}
+
+const Isometry& FrameGraph::transform(const FrameId frame) const {
+  checkFrame(frame);
+  return nodes_[frame].transform;
+}
+
+std::size_t FrameGraph::size() const { return nodes_.size(); }
+
+void FrameGraph::checkFrame(const FrameId frame) const {
+  if (frame >= nodes_.size()) {
+    internal::fail<std::out_of_range>("Unknown frame id " +
+                                      std::to_string(frame));
+  }
+}
+
+FrameGraph::FrameId FrameGraph::find(const char* name,
+                                     const std::size_t length) const {
+  if (slots_.empty()) {
+    return kNoParent;
+  }
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t slot = hashName(name, length) & mask;;
+       slot = (slot + 1) & mask) {
+    const FrameId frame = slots_[slot];
+    if (frame == kNoParent ||
+        (names_[frame].size() == length &&
+         std::memcmp(names_[frame].data(), name, length) == 0)) {
+      return frame;
+    }
+  }
+}
+
+FrameGraph::FrameId FrameGraph::findOrFail(const char* name,
+                                           const std::size_t length) const {
+  const FrameId frame = find(name, length);
+  if (frame == kNoParent) {
+    internal::fail<std::out_of_range>("Unknown frame " +
+                                      std::string(name, length));
+  }
+  return frame;
+}
+
+FrameGraph::FrameId FrameGraph::insert(const std::string& name,
+                                       const FrameId parent,
+                                       const Isometry& transform,
+                                       const std::size_t depth) {
+  if (contains(name)) {
+    internal::fail<std::invalid_argument>("Frame " + name +
+                                          " already exists");
+  }
+  const FrameId frame = nodes_.size();
+  nodes_.push_back(Node{transform, parent, depth});
+  names_.push_back(name);
+  // Grows the table to keep at least half of it empty, which keeps probe
+  // sequences short, reinserting every frame.
+  if (2 * nodes_.size() > slots_.size()) {
+    slots_.assign(slots_.empty() ? 16 : 2 * slots_.size(), kNoParent);
+    for (FrameId other = 0; other < frame; ++other) {
+      place(other);
+    }
+  }
+  place(frame);
+  return frame;
+}
+
+void FrameGraph::place(const FrameId frame) {
+  const std::size_t mask = slots_.size() - 1;
+  const std::string& name = names_[frame];
+  std::size_t slot = hashName(name.data(), name.size()) & mask;
+  while (slots_[slot] != kNoParent) {
+    slot = (slot + 1) & mask;
+  }
+  slots_[slot] = frame;
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -4,107 +4,244 @@
  * Author: Alexis Pojomovsky, 2020
  */
 
+#include <algorithm>
 #include <cmath>
-#include <iomanip>
+#include <ostream>
 
 #include <isometry/isometry.hpp>
 
 namespace ekumen {
 namespace math {
+namespace {
+
+// Rotation around x by roll, then y by pitch, then z by yaw, multiplied out
+// from the sines and cosines of the angles.
+template <typename T>
+Matrix3T<T> eulerRotation(const T sin_roll, const T cos_roll,
+                          const T sin_pitch, const T cos_pitch,
+                          const T sin_yaw, const T cos_yaw) {
+  return Matrix3T<T>(
+      cos_pitch * cos_yaw, -cos_pitch * sin_yaw, sin_pitch,
+      sin_roll * sin_pitch * cos_yaw + cos_roll * sin_yaw,
+      cos_roll * cos_yaw - sin_roll * sin_pitch * sin_yaw,
+      -sin_roll * cos_pitch,
+      sin_roll * sin_yaw - cos_roll * sin_pitch * cos_yaw,
+      cos_roll * sin_pitch * sin_yaw + sin_roll * cos_yaw,
+      cos_roll * cos_pitch);
+}
 
-Isometry::Isometry() : rotation_{Matrix3::kZero}, translation_{Vector3()} {}
-
-Isometry::Isometry(const Vector3& translation, const Matrix3& rotation)
-    : rotation_{rotation}, translation_{translation} {}
+// Rodrigues' rotation around a unit axis, from the sine and cosine of the
+// angle.
+template <typename T>
+Matrix3T<T> axisAngleRotation(const Vector3T<T>& axis, const T sine,
+                              const T cosine) {
+  const T x = axis.x();
+  const T y = axis.y();
+  const T z = axis.z();
+  const T versine = T{1} - cosine;
+  const T xy = x * y * versine;
+  const T xz = x * z * versine;
+  const T yz = y * z * versine;
+  return Matrix3T<T>(cosine + x * x * versine, xy - z * sine, xz + y * sine,
+                     xy + z * sine, cosine + y * y * versine, yz - x * sine,
+                     xz - y * sine, yz + x * sine, cosine + z * z * versine);
+}
 
-Isometry::Isometry(const Isometry& obj) = default;
+}  // namespace
 
-Isometry Isometry::fromTranslation(const Vector3& vector) {
-  return Isometry{vector, Matrix3::kIdentity};
+template <typename T>
+IsometryT<T> IsometryT<T>::rotateAround(const Vector3T<T>& vector,
+                                        const T radians) noexcept {
+  return fromUnitAxisAngle(vector / vector.norm(), radians);
 }
 
-Isometry Isometry::rotateAround(const Vector3& vector, const double radians) {
-  const double ux = vector[0] / vector.norm();
-  const double uy = vector[1] / vector.norm();
-  const double uz = vector[2] / vector.norm();
-  const double cosAngle = cos(radians);
-  const double sinAngle = sin(radians);
-  Matrix3 rotationMatrix =
-      Matrix3(cosAngle + std::pow(ux, 2.) * (1. - cosAngle),
-              ux * uy * (1. - cosAngle) - uz * sinAngle,
-              ux * uz * (1. - cosAngle) + uy * sinAngle,
-              uy * ux * (1. - cosAngle) + uz * sinAngle,
-              cosAngle + std::pow(uy, 2.) * (1 - cosAngle),
-              uy * uz * (1. - cosAngle) - ux * sinAngle,
-              uz * ux * (1. - cosAngle) - uy * sinAngle,
-              uz * uy * (1. - cosAngle) + ux * sinAngle,
-              cosAngle + std::pow(uz, 2.) * (1. - cosAngle));
-  return Isometry{Vector3(), rotationMatrix};
+template <typename T>
+IsometryT<T> IsometryT<T>::fromUnitAxisAngle(const Vector3T<T>& axis,
+                                             const T radians) noexcept {
+  T sine;
+  T cosine;
+  internal::sinCos(radians, &sine, &cosine);
+  return IsometryT{Vector3T<T>(), axisAngleRotation(axis, sine, cosine)};
 }
 
-Isometry Isometry::fromEulerAngles(const double roll, const double pitch,
-                                   const double yaw) {
-  return rotateAround(Vector3::kUnitX, roll) *
-         rotateAround(Vector3::kUnitY, pitch) *
-         rotateAround(Vector3::kUnitZ, yaw);
+template <typename T>
+IsometryT<T> IsometryT<T>::fromEulerAngles(const T roll, const T pitch,
+                                           const T yaw) noexcept {
+  T sin_roll;
+  T cos_roll;
+  T sin_pitch;
+  T cos_pitch;
+  T sin_yaw;
+  T cos_yaw;
+  internal::sinCos(roll, &sin_roll, &cos_roll);
+  internal::sinCos(pitch, &sin_pitch, &cos_pitch);
+  internal::sinCos(yaw, &sin_yaw, &cos_yaw);
+  return IsometryT{Vector3T<T>(),
+                   eulerRotation(sin_roll, cos_roll, sin_pitch, cos_pitch,
+                                 sin_yaw, cos_yaw)};
 }
 
-Vector3 Isometry::transform(const Vector3& vector) const {
-  return rotation_ * vector + translation_;
+template <typename T>
+void IsometryT<T>::fromEulerAngles(const T* roll, const T* pitch,
+                                   const T* yaw, const std::size_t count,
+                                   IsometryT* output) noexcept {
+  T sin_roll[internal::kTrigBlock];
+  T cos_roll[internal::kTrigBlock];
+  T sin_pitch[internal::kTrigBlock];
+  T cos_pitch[internal::kTrigBlock];
+  T sin_yaw[internal::kTrigBlock];
+  T cos_yaw[internal::kTrigBlock];
+  for (std::size_t begin = 0; begin < count; begin += internal::kTrigBlock) {
+    const std::size_t size = std::min(internal::kTrigBlock, count - begin);
+    internal::sinCos(roll + begin, size, sin_roll, cos_roll);
+    internal::sinCos(pitch + begin, size, sin_pitch, cos_pitch);
+    internal::sinCos(yaw + begin, size, sin_yaw, cos_yaw);
+    for (std::size_t i = 0; i < size; ++i) {
+      output[begin + i] = IsometryT{
+          Vector3T<T>(),
+          eulerRotation(sin_roll[i], cos_roll[i], sin_pitch[i], cos_pitch[i],
+                        sin_yaw[i], cos_yaw[i])};
+    }
+  }
 }
 
-Vector3& Isometry::translation() { return translation_; }
-
-const Vector3& Isometry::translation() const { return translation_; }
-
-Matrix3& Isometry::rotation() { return rotation_; }
-
-const Matrix3& Isometry::rotation() const { return rotation_; }
+template <typename T>
+void IsometryT<T>::fromUnitAxisAngle(const Vector3T<T>* axes,
+                                     const T* radians, const std::size_t count,
+                                     IsometryT* output) noexcept {
+  T sines[internal::kTrigBlock];
+  T cosines[internal::kTrigBlock];
+  for (std::size_t begin = 0; begin < count; begin += internal::kTrigBlock) {
+    const std::size_t size = std::min(internal::kTrigBlock, count - begin);
+    internal::sinCos(radians + begin, size, sines, cosines);
+    for (std::size_t i = 0; i < size; ++i) {
+      output[begin + i] = IsometryT{
+          Vector3T<T>(),
+          axisAngleRotation(axes[begin + i], sines[i], cosines[i])};
+    }
+  }
+}
 
-Isometry Isometry::inverse() const {
-  const Matrix3 inv_rot = rotation_.inverse();
-  return Isometry(-1 * inv_rot.product(translation_), inv_rot);
+template <typename T>
+IsometryT<T> IsometryT<T>::exp(const TwistT<T>& twist) noexcept {
+  const Vector3T<T>& w = twist.angular;
+  const T theta2 = w.dot(w);
+  T sine{0};
+  T cosine{1};
+  if (theta2 >= static_cast<T>(internal::kSmallAngleSquared)) {
+    internal::sinCos(std::sqrt(theta2), &sine, &cosine);
+  }
+  return expMap(twist, theta2, sine, cosine);
 }
 
-Isometry Isometry::compose(const Isometry& isometry) const {
-  return (*this) * isometry;
+template <typename T>
+void IsometryT<T>::exp(const TwistT<T>* twists, const std::size_t count,
+                       IsometryT* output) noexcept {
+  T thetas[internal::kTrigBlock];
+  T sines[internal::kTrigBlock];
+  T cosines[internal::kTrigBlock];
+  for (std::size_t begin = 0; begin < count; begin += internal::kTrigBlock) {
+    const std::size_t size = std::min(internal::kTrigBlock, count - begin);
+    for (std::size_t i = 0; i < size; ++i) {
+      thetas[i] = twists[begin + i].angular.norm();
+    }
+    internal::sinCos(thetas, size, sines, cosines);
+    for (std::size_t i = 0; i < size; ++i) {
+      output[begin + i] = expMap(twists[begin + i], thetas[i] * thetas[i],
+                                 sines[i], cosines[i]);
+    }
+  }
 }
 
-Isometry& Isometry::operator=(const Isometry& isometry) {
-  // self-assignment guard
-  if (this == &isometry) {
-    return *this;
+template <typename T>
+TwistT<T> IsometryT<T>::log() const noexcept {
+  const Vector3T<T> w = rotation_.log();
+  const T theta2 = w.dot(w);
+  T sine{0};
+  T cosine{1};
+  if (theta2 >= static_cast<T>(internal::kSmallAngleSquared)) {
+    internal::sinCos(std::sqrt(theta2), &sine, &cosine);
   }
-  rotation_ = isometry.rotation_;
-  translation_ = isometry.translation_;
-  return *this;
+  return logMap(w, theta2, sine, cosine);
 }
 
-bool Isometry::operator==(const Isometry& isometry) const {
-  return rotation_ == isometry.rotation_ &&
-         translation_ == isometry.translation_;
+template <typename T>
+void IsometryT<T>::log(const IsometryT* isometries, const std::size_t count,
+                       TwistT<T>* output) noexcept {
+  Vector3T<T> rotations[internal::kTrigBlock];
+  T thetas[internal::kTrigBlock];
+  T sines[internal::kTrigBlock];
+  T cosines[internal::kTrigBlock];
+  for (std::size_t begin = 0; begin < count; begin += internal::kTrigBlock) {
+    const std::size_t size = std::min(internal::kTrigBlock, count - begin);
+    for (std::size_t i = 0; i < size; ++i) {
+      rotations[i] = isometries[begin + i].rotation_.log();
+      thetas[i] = rotations[i].norm();
+    }
+    internal::sinCos(thetas, size, sines, cosines);
+    for (std::size_t i = 0; i < size; ++i) {
+      output[begin + i] = isometries[begin + i].logMap(
+          rotations[i], thetas[i] * thetas[i], sines[i], cosines[i]);
+    }
+  }
 }
 
-Isometry& Isometry::operator*=(const Isometry& isometry) {
-  translation_ = rotation_ * isometry.translation() + translation_;
-  rotation_ = rotation_ * isometry.rotation();
-  return *this;
+template <typename T>
+IsometryT<T> IsometryT<T>::expMap(const TwistT<T>& twist, const T theta2,
+                                  const T sine, const T cosine) noexcept {
+  const Vector3T<T>& w = twist.angular;
+  T a;
+  T b;
+  internal::expCoefficients(theta2, sine, cosine, &a, &b);
+  // c = (theta - sin(theta)) / theta^3, the last coefficient of V.
+  const T c = theta2 < static_cast<T>(internal::kSmallAngleSquared)
+                  ? T{1} / T{6} - theta2 / T{120} * (T{1} - theta2 / T{42})
+                  : (T{1} - a) / theta2;
+  const Vector3T<T> wv = w.cross(twist.linear);
+  return IsometryT{twist.linear + b * wv + c * w.cross(wv),
+                   internal::rodrigues(w, a, b)};
 }
 
-Vector3 Isometry::operator*(const Vector3& vector) const {
-  return rotation_.product(vector) + translation_;
+template <typename T>
+TwistT<T> IsometryT<T>::logMap(const Vector3T<T>& w, const T theta2,
+                               const T sine, const T cosine) const noexcept {
+  // The translation is V t, with V = I + b [w]x + c [w]x^2, whose inverse is
+  // I - [w]x / 2 + d [w]x^2.
+  T d;
+  if (theta2 < static_cast<T>(internal::kSmallAngleSquared)) {
+    d = T{1} / T{12} + theta2 / T{720} * (T{1} + theta2 / T{42});
+  } else {
+    T a;
+    T b;
+    internal::expCoefficients(theta2, sine, cosine, &a, &b);
+    d = (T{1} - a / (T{2} * b)) / theta2;
+  }
+  const Vector3T<T> wt = w.cross(translation_);
+  return TwistT<T>{translation_ - T{0.5} * wt + d * w.cross(wt), w};
 }
 
-Isometry Isometry::operator*(const Isometry& isometry) const {
-  return Isometry((rotation_ * isometry.translation()) + translation_,
-                  rotation_ * isometry.rotation());
+template <typename T>
+bool IsometryT<T>::operator==(const IsometryT& isometry) const {
+  return rotation_ == isometry.rotation_ &&
+         translation_ == isometry.translation_;
 }
 
-std::ostream& operator<<(std::ostream& os, const Isometry& isometry) {
-  os << std::setprecision(9) << "[T: " << isometry.translation()
-     << ", R:" << isometry.rotation() << "]";
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const IsometryT<T>& isometry) {
+  // The precision is restored so that the caller's stream state is kept.
+  const std::streamsize precision = os.precision(9);
+  os << "[T: " << isometry.translation() << ", R:" << isometry.rotation()
+     << "]";
+  os.precision(precision);
   return os;
 }
 
+template class IsometryT<double>;
+template class IsometryT<float>;
+template std::ostream& operator<<(std::ostream& os,
+                                  const IsometryT<double>& isometry);
+template std::ostream& operator<<(std::ostream& os,
+                                  const IsometryT<float>& isometry);
+
 }  // namespace math
 }  // namespace ekumen
@@ -0,0 +1,76 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <ostream>
+
+#include <isometry/isometry_q.hpp>
+
+namespace ekumen {
+namespace math {
+
+// Translation and quaternion are packed without padding, which is what makes
+// IsometryQ cheaper to store than Isometry.
+static_assert(sizeof(IsometryQ) == 7 * sizeof(double),
+              "IsometryQ must not have padding");
+static_assert(sizeof(IsometryQf) == 7 * sizeof(float),
+              "IsometryQf must not have padding");
+
+template <typename T>
+IsometryQT<T>::IsometryQT(const IsometryT<T>& isometry)
+    : translation_(isometry.translation()),
+      rotation_(QuaternionT<T>::fromRotationMatrix(isometry.rotation())) {}
+
+template <typename T>
+IsometryQT<T> IsometryQT<T>::fromTranslation(const Vector3T<T>& vector) {
+  return IsometryQT(vector, QuaternionT<T>::kIdentity);
+}
+
+template <typename T>
+IsometryQT<T> IsometryQT<T>::rotateAround(const Vector3T<T>& vector,
+                                          const T radians) {
+  return IsometryQT(Vector3T<T>(),
+                    QuaternionT<T>::fromAxisAngle(vector, radians));
+}
+
+template <typename T>
+IsometryQT<T> IsometryQT<T>::fromEulerAngles(const T roll, const T pitch,
+                                             const T yaw) {
+  return IsometryQT(
+      Vector3T<T>(),
+      QuaternionT<T>::fromAxisAngle(Vector3T<T>::kUnitX, roll) *
+          QuaternionT<T>::fromAxisAngle(Vector3T<T>::kUnitY, pitch) *
+          QuaternionT<T>::fromAxisAngle(Vector3T<T>::kUnitZ, yaw));
+}
+
+template <typename T>
+bool IsometryQT<T>::operator==(const IsometryQT& isometry) const {
+  return rotation_ == isometry.rotation_ &&
+         translation_ == isometry.translation_;
+}
+
+template <typename T>
+bool IsometryQT<T>::operator!=(const IsometryQT& isometry) const {
+  return !(*this == isometry);
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const IsometryQT<T>& isometry) {
+  const std::streamsize precision = os.precision(9);
+  os << "[T: " << isometry.translation() << ", Q:" << isometry.rotation()
+     << "]";
+  os.precision(precision);
+  return os;
+}
+
+template class IsometryQT<double>;
+template class IsometryQT<float>;
+template std::ostream& operator<<(std::ostream& os,
+                                  const IsometryQT<double>& isometry);
+template std::ostream& operator<<(std::ostream& os,
+                                  const IsometryQT<float>& isometry);
+
+}  // namespace math
+}  // namespace ekumen
@@ -4,8 +4,9 @@
  * Author: Alexis Pojomovsky, 2020
  */
 
-#include <array>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <limits>
 #include <stdexcept>
 
@@ -13,201 +14,244 @@
 
 namespace ekumen {
 namespace math {
-
-const Matrix3 Matrix3::kIdentity{Matrix3(1., 0., 0., 0., 1., 0., 0., 0., 1.)};
-const Matrix3 Matrix3::kOnes{Matrix3(1., 1., 1., 1., 1., 1., 1., 1., 1.)};
-const Matrix3 Matrix3::kZero{Matrix3(0., 0., 0., 0., 0., 0., 0., 0., 0.)};
-
-Matrix3::Matrix3()
-    : row_0_{0., 0., 0.}, row_1_{0., 0., 0.}, row_2_{0., 0., 0.} {}
-
-Matrix3::Matrix3(const double a1, const double a2, const double a3,
-                 const double b1, const double b2, const double b3,
-                 const double c1, const double c2, const double c3)
-    : row_0_{a1, a2, a3}, row_1_{b1, b2, b3}, row_2_{c1, c2, c3} {}
-
-bool Matrix3::operator==(const Matrix3& matrix) const {
-  return row_0_ == matrix[0] && row_1_ == matrix[1] && row_2_ == matrix[2];
-}
-
-bool Matrix3::operator!=(const Matrix3& matrix) const {
-  return !(*this == matrix);
-}
-
-Vector3 Matrix3::operator[](const int index) const {
-  switch (index) {
-    case 0:
-      return row_0_;
-    case 1:
-      return row_1_;
-    case 2:
-      return row_2_;
-    default:
-      throw std::out_of_range("Matrix3 has only 3 elements");
+namespace {
+
+// Angles up to which the batch kernel reduces arguments accurately. The
+// quotient by pi/2 stays below 2^17, so its products with the 33-bit parts of
+// pi/2 below are exact.
+constexpr double kMaxReducedAngle{1e5};
+
+// pi/2 split in three parts of 33 significant bits each, as in fdlibm.
+constexpr double kPiOver2Hi{1.57079632673412561417e+00};
+constexpr double kPiOver2Mid{6.07710050630396597660e-11};
+constexpr double kPiOver2Lo{2.02226624871116645580e-21};
+constexpr double kTwoOverPi{6.36619772367581382433e-01};
+
+// Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer.
+constexpr double kRoundingShift{6755399441055744.};
+
+// Minimax polynomials of sine and cosine over [-pi/4, pi/4], from fdlibm.
+constexpr double kS1{-1.66666666666666324348e-01};
+constexpr double kS2{8.33333333332248946124e-03};
+constexpr double kS3{-1.98412698298579493134e-04};
+constexpr double kS4{2.75573137070700676789e-06};
+constexpr double kS5{-2.50507602534068634195e-08};
+constexpr double kS6{1.58969099521155010221e-10};
+constexpr double kC1{4.16666666666666019037e-02};
+constexpr double kC2{-1.38888888888741095749e-03};
+constexpr double kC3{2.48015872894767294178e-05};
+constexpr double kC4{-2.75573143513906633035e-07};
+constexpr double kC5{2.08757232129817482790e-09};
+constexpr double kC6{-1.13596475577881948265e-11};
+
+}  // namespace
+
+namespace internal {
+
+// Sines and cosines of `count` angles. The first loop has no branches,
+// calls nor integer conversions, so it vectorizes. Each angle is reduced to
+// [-pi/4, pi/4] by its nearest multiple n of pi/2, and the polynomials
+// evaluated on the remainder are swapped and negated by the quadrant, n mod 4,
+// with arithmetic instead of selects. Angles it cannot reduce, including
+// infinities and NaN, give meaningless results that are redone afterwards
+// with std::sin and std::cos.
+template <typename T>
+void sinCos(const T* radians, const std::size_t count, T* sines,
+            T* cosines) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const double x = radians[i];
+    const double n = (x * kTwoOverPi + kRoundingShift) - kRoundingShift;
+    const double r =
+        ((x - n * kPiOver2Hi) - n * kPiOver2Mid) - n * kPiOver2Lo;
+    const double z = r * r;
+    const double sin_poly =
+        kS2 + z * (kS3 + z * (kS4 + z * (kS5 + z * kS6)));
+    const double sin_r = r + r * z * (kS1 + z * sin_poly);
+    const double cos_poly =
+        kC1 + z * (kC2 + z * (kC3 + z * (kC4 + z * (kC5 + z * kC6))));
+    const double half_z = 0.5 * z;
+    const double w = 1. - half_z;
+    const double cos_r = w + (((1. - w) - half_z) + z * z * cos_poly);
+    // n - 4 * floor(n / 4), where the offset makes rounding act as floor.
+    const double quadrant =
+        n - 4. * ((n * 0.25 - 0.375 + kRoundingShift) - kRoundingShift);
+    // 1 in quadrants 1 and 3, where sine and cosine swap, 0 otherwise.
+    const double odd = 1. - std::fabs(std::fabs(quadrant - 2.) - 1.);
+    // Sine is negative in quadrants 2 and 3, cosine in quadrants 1 and 2.
+    const double sine_sign = 1. - (quadrant - odd);
+    const double cosine_sign = 2. * std::fabs(quadrant - 1.5) - 2.;
+    sines[i] =
+        static_cast<T>(sine_sign * (odd * cos_r + (1. - odd) * sin_r));
+    cosines[i] =
+        static_cast<T>(cosine_sign * (odd * sin_r + (1. - odd) * cos_r));
   }
-}
-
-Vector3& Matrix3::operator[](const int index) {
-  switch (index) {
-    case 0:
-      return row_0_;
-    case 1:
-      return row_1_;
-    case 2:
-      return row_2_;
-    default:
-      throw std::out_of_range("Matrix3 has only 3 elements");
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!(std::fabs(radians[i]) <= kMaxReducedAngle)) {
+      sinCos(radians[i], &sines[i], &cosines[i]);
+    }
   }
 }
 
-std::ostream& operator<<(std::ostream& os, const Matrix3& matrix) {
-  os << "[[" << matrix[0][0] << ", " << matrix[0][1] << ", " << matrix[0][2]
-     << "], [" << matrix[1][0] << ", " << matrix[1][1] << ", " << matrix[1][2]
-     << "], [" << matrix[2][0] << ", " << matrix[2][1] << ", " << matrix[2][2]
-     << "]]";
-  return os;
-}
-
-Matrix3& Matrix3::operator+=(const Matrix3& matrix) {
-  row_0_ += matrix[0];
-  row_1_ += matrix[1];
-  row_2_ += matrix[2];
-  return *this;
-}
-
-Matrix3& Matrix3::operator-=(const Matrix3& matrix) {
-  row_0_ -= matrix[0];
-  row_1_ -= matrix[1];
-  row_2_ -= matrix[2];
-  return *this;
-}
-
-Matrix3& Matrix3::operator*=(const Matrix3& matrix) {
-  row_0_ *= matrix[0];
-  row_1_ *= matrix[1];
-  row_2_ *= matrix[2];
-  return *this;
-}
-
-Matrix3& Matrix3::operator*=(const double scalar) {
-  row_0_ *= scalar;
-  row_1_ *= scalar;
-  row_2_ *= scalar;
-  return *this;
-}
-
-Matrix3& Matrix3::operator/=(const Matrix3& matrix) {
-  row_0_ /= matrix[0];
-  row_1_ /= matrix[1];
-  row_2_ /= matrix[2];
-  return *this;
-}
-
-Matrix3& Matrix3::operator/=(const double scalar) {
-  row_0_ /= scalar;
-  row_1_ /= scalar;
-  row_2_ /= scalar;
-  return *this;
-}
+template void sinCos(const double* radians, const std::size_t count,
+                     double* sines, double* cosines);
+template void sinCos(const float* radians, const std::size_t count,
+                     float* sines, float* cosines);
 
-Matrix3 Matrix3::operator+(const Matrix3& matrix) const {
-  Matrix3 aux{*this};
-  aux += matrix;
-  return aux;
-}
+}  // namespace internal
 
-Matrix3 Matrix3::operator-(const Matrix3& matrix) const {
-  Matrix3 aux{*this};
-  aux -= matrix;
-  return aux;
-}
-
-Matrix3 Matrix3::operator*(const Matrix3& matrix) const {
-  Matrix3 aux{*this};
-  aux *= matrix;
-  return aux;
-}
-
-Vector3 Matrix3::operator*(const Vector3& vector) const {
-  return Vector3{row_0_.dot(vector), row_1_.dot(vector), row_2_.dot(vector)};
+template <typename T>
+bool Matrix3T<T>::operator==(const Matrix3T& matrix) const {
+  for (int i = 0; i < 9; ++i) {
+    if (std::fabs(data_[i] - matrix.data_[i]) >
+        std::numeric_limits<T>::epsilon()) {
+      return false;
+    }
+  }
+  return true;
 }
 
-Matrix3 Matrix3::operator*(const double scalar) const {
-  Matrix3 aux{*this};
-  aux *= scalar;
-  return aux;
+template <typename T>
+bool Matrix3T<T>::operator!=(const Matrix3T& matrix) const {
+  return !(*this == matrix);
 }
 
-Matrix3 operator*(double scalar, const Matrix3& matrix) {
-  return matrix * scalar;
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Matrix3T<T>& matrix) {
+  os << "[[" << matrix(0, 0) << ", " << matrix(0, 1) << ", " << matrix(0, 2)
+     << "], [" << matrix(1, 0) << ", " << matrix(1, 1) << ", " << matrix(1, 2)
+     << "], [" << matrix(2, 0) << ", " << matrix(2, 1) << ", " << matrix(2, 2)
+     << "]]";
+  return os;
 }
 
-Matrix3 Matrix3::operator/(const Matrix3& matrix) const {
-  Matrix3 aux{*this};
-  aux /= matrix;
-  return aux;
+template <typename T>
+Matrix3T<T> Matrix3T<T>::inverse() const {
+  Matrix3T inverse;
+  if (!tryInverse(&inverse)) {
+    internal::fail<std::runtime_error>("Matrix is non-invertible");
+  }
+  return inverse;
 }
 
-Matrix3 Matrix3::operator/(const double scalar) const {
-  Matrix3 aux{*this};
-  aux /= scalar;
-  return aux;
+template <typename T>
+bool Matrix3T<T>::tryInverse(Matrix3T* inverse) const noexcept {
+  const T det = this->det();
+  if (std::fabs(det) < T(0.000001)) {
+    return false;
+  }
+  const T a = data_[0];
+  const T b = data_[1];
+  const T c = data_[2];
+  const T d = data_[3];
+  const T e = data_[4];
+  const T f = data_[5];
+  const T g = data_[6];
+  const T h = data_[7];
+  const T k = data_[8];
+  *inverse = T{1} / det *
+             Matrix3T((e * k - f * h), -(b * k - c * h), (b * f - c * e),
+                      -(d * k - f * g), (a * k - c * g), -(a * f - c * d),
+                      (d * h - e * g), -(a * h - b * g), (a * e - b * d));
+  return true;
 }
 
-double Matrix3::det() const {
-  return row_0_[0] * (row_1_[1] * row_2_[2] - row_1_[2] * row_2_[1]) -
-         row_0_[1] * (row_1_[0] * row_2_[2] - row_1_[2] * row_2_[0]) +
-         row_0_[2] * (row_1_[0] * row_2_[1] - row_1_[1] * row_2_[0]);
+template <typename T>
+Matrix3T<T> Matrix3T<T>::exp(const Vector3T<T>& rotation) noexcept {
+  const T theta2 = rotation.dot(rotation);
+  T sine{0};
+  T cosine{1};
+  if (theta2 >= static_cast<T>(internal::kSmallAngleSquared)) {
+    internal::sinCos(std::sqrt(theta2), &sine, &cosine);
+  }
+  T a;
+  T b;
+  internal::expCoefficients(theta2, sine, cosine, &a, &b);
+  return internal::rodrigues(rotation, a, b);
 }
 
-Matrix3 Matrix3::inverse() const {
-  double det = this->det();
-  if (std::fabs(det) < 0.000001) {
-    throw std::runtime_error("Matrix is non-invertible");
+template <typename T>
+void Matrix3T<T>::exp(const Vector3T<T>* rotations, const std::size_t count,
+                      Matrix3T* output) noexcept {
+  T thetas[internal::kTrigBlock];
+  T sines[internal::kTrigBlock];
+  T cosines[internal::kTrigBlock];
+  for (std::size_t begin = 0; begin < count; begin += internal::kTrigBlock) {
+    const std::size_t size = std::min(internal::kTrigBlock, count - begin);
+    for (std::size_t i = 0; i < size; ++i) {
+      thetas[i] = rotations[begin + i].norm();
+    }
+    internal::sinCos(thetas, size, sines, cosines);
+    for (std::size_t i = 0; i < size; ++i) {
+      T a;
+      T b;
+      internal::expCoefficients(thetas[i] * thetas[i], sines[i], cosines[i],
+                                &a, &b);
+      output[begin + i] = internal::rodrigues(rotations[begin + i], a, b);
+    }
   }
-  const double a = row_0_[0];
-  const double b = row_0_[1];
-  const double c = row_0_[2];
-  const double d = row_1_[0];
-  const double e = row_1_[1];
-  const double f = row_1_[2];
-  const double g = row_2_[0];
-  const double h = row_2_[1];
-  const double k = row_2_[2];
-  return 1 / det *
-         Matrix3((e * k - f * h), -(b * k - c * h), (b * f - c * e),
-                 -(d * k - f * g), (a * k - c * g), -(a * f - c * d),
-                 (d * h - e * g), -(a * h - b * h), (a * e - b * d));
 }
 
-Matrix3 Matrix3::product(const Matrix3& matrix) const {
-  const auto r0 = row(0);
-  const auto r1 = row(1);
-  const auto r2 = row(2);
-  const auto c0 = matrix.col(0);
-  const auto c1 = matrix.col(1);
-  const auto c2 = matrix.col(2);
-  return Matrix3{
-      r0.dot(c0), r0.dot(c1), r0.dot(c2), r1.dot(c0), r1.dot(c1),
-      r1.dot(c2), r2.dot(c0), r2.dot(c1), r2.dot(c2),
-  };
+template <typename T>
+Vector3T<T> Matrix3T<T>::log() const noexcept {
+  // The skew-symmetric part is sin(theta) times the axis, and the trace is
+  // 1 + 2 cos(theta).
+  const Vector3T<T> skew(T{0.5} * (data_[7] - data_[5]),
+                         T{0.5} * (data_[2] - data_[6]),
+                         T{0.5} * (data_[3] - data_[1]));
+  const T sine = skew.norm();
+  const T cosine = std::max(
+      T{-1}, std::min(T{1}, T{0.5} * (data_[0] + data_[4] + data_[8] - T{1})));
+  const T theta = std::atan2(sine, cosine);
+  if (cosine > T{0}) {
+    const T theta2 = theta * theta;
+    if (theta2 < static_cast<T>(internal::kSmallAngleSquared)) {
+      // theta / sin(theta), which is 0 / 0 for the null rotation.
+      return skew *
+             (T{1} + theta2 / T{6} *
+                         (T{1} + theta2 * T{7} / T{60} *
+                                     (T{1} + theta2 * T{31} / T{294})));
+    }
+    return skew * (theta / sine);
+  }
+  // Past pi / 2 the skew-symmetric part vanishes, so the axis n comes from
+  // the symmetric part instead, which is cos(theta) I + (1 - cos(theta)) n n',
+  // starting with its largest component to divide by it.
+  const T versine = T{1} - cosine;
+  int i = 0;
+  if (data_[4] > data_[i * 4]) {
+    i = 1;
+  }
+  if (data_[8] > data_[i * 4]) {
+    i = 2;
+  }
+  const int j = (i + 1) % 3;
+  const int k = (i + 2) % 3;
+  T axis[3];
+  axis[i] = std::sqrt(std::max(T{0}, (data_[i * 4] - cosine) / versine));
+  const T scale = T{0.5} / (versine * axis[i]);
+  axis[j] = (data_[i * 3 + j] + data_[j * 3 + i]) * scale;
+  axis[k] = (data_[i * 3 + k] + data_[k * 3 + i]) * scale;
+  // The symmetric part does not tell n from -n, the skew-symmetric part does
+  // until exactly pi, where both rotate the same.
+  const T sign = skew[i] < T{0} ? T{-1} : T{1};
+  return Vector3T<T>(axis[0], axis[1], axis[2]) * (sign * theta);
 }
 
-Vector3 Matrix3::product(const Vector3& vector) const {
-  std::array<double, 3> arr{};
-  for (int i = 0; i < 3; ++i) {
-    arr.at(i) = row(i).dot(vector);
+template <typename T>
+void Matrix3T<T>::log(const Matrix3T* rotations, const std::size_t count,
+                      Vector3T<T>* output) noexcept {
+  // atan2 does not vectorize, so there is nothing to gain from blocks.
+  for (std::size_t i = 0; i < count; ++i) {
+    output[i] = rotations[i].log();
   }
-  return Vector3{arr[0], arr[1], arr[2]};
 }
 
-Vector3& Matrix3::row(const int index) { return (*this)[index]; }
-
-Vector3 Matrix3::row(const int index) const { return (*this)[index]; }
-
-Vector3 Matrix3::col(const int index) const {
-  return Vector3{row_0_[index], row_1_[index], row_2_[index]};
-}
+template class Matrix3T<double>;
+template class Matrix3T<float>;
+template std::ostream& operator<<(std::ostream& os,
+                                  const Matrix3T<double>& matrix);
+template std::ostream& operator<<(std::ostream& os,
+                                  const Matrix3T<float>& matrix);
 
 }  // namespace math
 }  // namespace ekumen
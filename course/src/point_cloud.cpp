@@ -0,0 +1,69 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <isometry/point_cloud.hpp>
+
+namespace ekumen {
+namespace math {
+
+template <typename T>
+constexpr std::size_t PointCloudT<T>::kAlignment;
+
+template <typename T>
+PointCloudT<T>::PointCloudT(const std::size_t size)
+    : x_(size, T{0}), y_(size, T{0}), z_(size, T{0}) {}
+
+template <typename T>
+PointCloudT<T>::PointCloudT(const std::vector<Vector3T<T>>& points) {
+  reserve(points.size());
+  for (const Vector3T<T>& point : points) {
+    push_back(point);
+  }
+}
+
+template <typename T>
+std::vector<Vector3T<T>> PointCloudT<T>::toVector() const {
+  std::vector<Vector3T<T>> points;
+  points.reserve(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    points.emplace_back(x_[i], y_[i], z_[i]);
+  }
+  return points;
+}
+
+template <typename T>
+void PointCloudT<T>::resize(const std::size_t size) {
+  x_.resize(size, T{0});
+  y_.resize(size, T{0});
+  z_.resize(size, T{0});
+}
+
+template <typename T>
+void PointCloudT<T>::reserve(const std::size_t size) {
+  x_.reserve(size);
+  y_.reserve(size);
+  z_.reserve(size);
+}
+
+template <typename T>
+void PointCloudT<T>::clear() {
+  x_.clear();
+  y_.clear();
+  z_.clear();
+}
+
+template <typename T>
+void PointCloudT<T>::push_back(const Vector3T<T>& point) {
+  x_.push_back(point.x());
+  y_.push_back(point.y());
+  z_.push_back(point.z());
+}
+
+template class PointCloudT<double>;
+template class PointCloudT<float>;
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,407 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <isometry/point_file.hpp>
+
+namespace ekumen {
+namespace math {
+namespace {
+
+// A field of the records of a file.
+struct Field {
+  std::string name;
+  // Offset in bytes from the start of the record.
+  std::size_t offset;
+  // Size in bytes.
+  std::size_t size;
+  bool floating_point;
+};
+
+// Where the points are within the file.
+struct Layout {
+  // Offset in bytes of the first record.
+  std::size_t data_offset{0};
+  std::size_t count{0};
+  std::size_t stride{0};
+  std::vector<Field> fields;
+};
+
+[[noreturn]] void fail(const std::string& path, const std::string& message) {
+  internal::fail<std::runtime_error>(path + ": " + message);
+}
+
+// Reads the next line of the header into `line`, without the line ending.
+// Returns false when no line ending is found before `last`.
+bool nextLine(const char** cursor, const char* last, std::string* line) {
+  const char* end = static_cast<const char*>(
+      std::memchr(*cursor, '\n', static_cast<std::size_t>(last - *cursor)));
+  if (end == nullptr) {
+    return false;
+  }
+  line->assign(*cursor, end > *cursor && end[-1] == '\r' ? end - 1 : end);
+  *cursor = end + 1;
+  return true;
+}
+
+std::vector<std::string> split(const std::string& line) {
+  std::istringstream is{line};
+  std::vector<std::string> tokens;
+  std::string token;
+  while (is >> token) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+std::size_t parseCount(const std::string& path, const std::string& token) {
+  char* end;
+  errno = 0;
+  const unsigned long long value = std::strtoull(token.c_str(), &end, 10);
+  if (token.empty() || token[0] == '-' || *end != '\0' || errno != 0) {
+    fail(path, "invalid count " + token);
+  }
+  return static_cast<std::size_t>(value);
+}
+
+// Sizes computed from the counts of a header, which fail when they overflow
+// instead of wrapping to a layout that does not match the file.
+std::size_t multiply(const std::string& path, const std::size_t lhs,
+                     const std::size_t rhs) {
+  if (rhs != 0 && lhs > std::numeric_limits<std::size_t>::max() / rhs) {
+    fail(path, "header sizes overflow");
+  }
+  return lhs * rhs;
+}
+
+std::size_t add(const std::string& path, const std::size_t lhs,
+                const std::size_t rhs) {
+  if (lhs > std::numeric_limits<std::size_t>::max() - rhs) {
+    fail(path, "header sizes overflow");
+  }
+  return lhs + rhs;
+}
+
+// Size of a PLY property type, 0 when unknown.
+std::size_t plyTypeSize(const std::string& type) {
+  if (type == "char" || type == "uchar" || type == "int8" ||
+      type == "uint8") {
+    return 1;
+  }
+  if (type == "short" || type == "ushort" || type == "int16" ||
+      type == "uint16") {
+    return 2;
+  }
+  if (type == "int" || type == "uint" || type == "int32" ||
+      type == "uint32" || type == "float" || type == "float32") {
+    return 4;
+  }
+  if (type == "double" || type == "float64") {
+    return 8;
+  }
+  return 0;
+}
+
+Layout parsePly(const std::string& path, const char* first,
+                const char* last) {
+  // An element of the file, with its properties.
+  struct Element {
+    std::string name;
+    std::size_t count;
+    std::size_t size;
+    bool has_list;
+    std::vector<Field> properties;
+  };
+  std::vector<Element> elements;
+  const char* cursor = first;
+  std::string line;
+  nextLine(&cursor, last, &line);
+  while (true) {
+    if (!nextLine(&cursor, last, &line)) {
+      fail(path, "PLY header without end_header");
+    }
+    const std::vector<std::string> tokens = split(line);
+    if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info") {
+      continue;
+    }
+    if (tokens[0] == "end_header") {
+      break;
+    }
+    if (tokens[0] == "format" && tokens.size() >= 2) {
+      if (tokens[1] != "binary_little_endian") {
+        fail(path, "unsupported PLY format " + tokens[1]);
+      }
+    } else if (tokens[0] == "element" && tokens.size() == 3) {
+      elements.push_back(
+          Element{tokens[1], parseCount(path, tokens[2]), 0, false, {}});
+    } else if (tokens[0] == "property" && !elements.empty() &&
+               tokens.size() >= 3) {
+      Element& element = elements.back();
+      if (tokens[1] == "list") {
+        element.has_list = true;
+        continue;
+      }
+      const std::size_t size = plyTypeSize(tokens[1]);
+      if (size == 0) {
+        fail(path, "unknown PLY property type " + tokens[1]);
+      }
+      element.properties.push_back(
+          Field{tokens[2], element.size, size,
+                tokens[1].compare(0, 5, "float") == 0 ||
+                    tokens[1] == "double"});
+      element.size = add(path, element.size, size);
+    } else {
+      fail(path, "unexpected PLY header line: " + line);
+    }
+  }
+
+  // Elements are stored one after the other, so the ones before the vertices
+  // are skipped, which requires them to have a fixed size.
+  Layout layout;
+  layout.data_offset = static_cast<std::size_t>(cursor - first);
+  for (const Element& element : elements) {
+    if (element.has_list) {
+      fail(path, "PLY element " + element.name + " has list properties");
+    }
+    if (element.name == "vertex") {
+      layout.count = element.count;
+      layout.stride = element.size;
+      layout.fields = element.properties;
+      return layout;
+    }
+    layout.data_offset = add(path, layout.data_offset,
+                             multiply(path, element.count, element.size));
+  }
+  fail(path, "PLY file without a vertex element");
+}
+
+Layout parsePcd(const std::string& path, const char* first,
+                const char* last) {
+  std::vector<std::string> names;
+  std::vector<std::string> sizes;
+  std::vector<std::string> types;
+  std::vector<std::string> counts;
+  std::size_t width{0};
+  std::size_t height{1};
+  std::size_t points{0};
+  bool has_points{false};
+  const char* cursor = first;
+  std::string line;
+  while (true) {
+    if (!nextLine(&cursor, last, &line)) {
+      fail(path, "PCD header without DATA");
+    }
+    std::vector<std::string> tokens = split(line);
+    if (tokens.empty() || tokens[0][0] == '#') {
+      continue;
+    }
+    const std::string key = tokens[0];
+    tokens.erase(tokens.begin());
+    if (key == "DATA") {
+      if (tokens.size() != 1 || tokens[0] != "binary") {
+        fail(path, "unsupported PCD data " + line.substr(4));
+      }
+      break;
+    }
+    if (key == "FIELDS") {
+      names = tokens;
+    } else if (key == "SIZE") {
+      sizes = tokens;
+    } else if (key == "TYPE") {
+      types = tokens;
+    } else if (key == "COUNT") {
+      counts = tokens;
+    } else if (key == "WIDTH" && tokens.size() == 1) {
+      width = parseCount(path, tokens[0]);
+    } else if (key == "HEIGHT" && tokens.size() == 1) {
+      height = parseCount(path, tokens[0]);
+    } else if (key == "POINTS" && tokens.size() == 1) {
+      points = parseCount(path, tokens[0]);
+      has_points = true;
+    } else if (key != "VERSION" && key != "VIEWPOINT") {
+      fail(path, "unexpected PCD header line: " + line);
+    }
+  }
+  if (counts.empty()) {
+    counts.assign(names.size(), "1");
+  }
+  if (sizes.size() != names.size() || types.size() != names.size() ||
+      counts.size() != names.size()) {
+    fail(path, "PCD fields, sizes, types and counts do not match");
+  }
+
+  Layout layout;
+  layout.data_offset = static_cast<std::size_t>(cursor - first);
+  layout.count = has_points ? points : multiply(path, width, height);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    const std::size_t size = parseCount(path, sizes[i]);
+    layout.fields.push_back(
+        Field{names[i], layout.stride, size, types[i] == "F"});
+    layout.stride = add(path, layout.stride,
+                        multiply(path, size, parseCount(path, counts[i])));
+  }
+  return layout;
+}
+
+// Finds x, y and z among the fields, returning their offset and size.
+std::pair<std::size_t, std::size_t> findCoordinates(
+    const std::string& path, const std::vector<Field>& fields) {
+  const Field* xyz[3] = {nullptr, nullptr, nullptr};
+  for (const Field& field : fields) {
+    if (field.name.size() == 1 && field.name[0] >= 'x' &&
+        field.name[0] <= 'z') {
+      xyz[field.name[0] - 'x'] = &field;
+    }
+  }
+  if (xyz[0] == nullptr || xyz[1] == nullptr || xyz[2] == nullptr) {
+    fail(path, "points do not have x, y and z fields");
+  }
+  const std::size_t size = xyz[0]->size;
+  for (int i = 0; i < 3; ++i) {
+    if (!xyz[i]->floating_point || xyz[i]->size != size ||
+        (size != sizeof(float) && size != sizeof(double))) {
+      fail(path, "x, y and z must all be float or all be double");
+    }
+    if (xyz[i]->offset != xyz[0]->offset + i * size) {
+      fail(path, "x, y and z must be consecutive fields");
+    }
+  }
+  return std::make_pair(xyz[0]->offset, size);
+}
+
+int toAdvice(const PointFile::Access access) {
+  switch (access) {
+    case PointFile::Access::kSequential:
+      return MADV_SEQUENTIAL;
+    case PointFile::Access::kRandom:
+      return MADV_RANDOM;
+    case PointFile::Access::kNormal:
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+}  // namespace
+
+PointFile::PointFile(const std::string& path, const Access access) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  fail(path, "point files can only be read on little-endian hosts");
+#endif
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    fail(path, std::strerror(errno));
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    const int error = errno;
+    ::close(fd);
+    fail(path, std::strerror(error));
+  }
+  if (status.st_size == 0) {
+    ::close(fd);
+    fail(path, "empty file");
+  }
+  map_size_ = static_cast<std::size_t>(status.st_size);
+  void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int error = errno;
+  // The mapping keeps the file referenced on its own.
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    fail(path, std::strerror(error));
+  }
+  map_ = static_cast<std::uint8_t*>(map);
+
+  // The destructor does not run when the constructor fails, so a rejected
+  // header unmaps the file on the way out.
+  struct Unmapper {
+    PointFile* file;
+    ~Unmapper() {
+      if (file != nullptr) {
+        file->unmap();
+      }
+    }
+  } unmapper{this};
+  const char* first = reinterpret_cast<const char*>(map_);
+  const char* last = first + map_size_;
+  Layout layout;
+  if (map_size_ >= 4 && std::memcmp(first, "ply", 3) == 0 &&
+      (first[3] == '\n' || first[3] == '\r')) {
+    format_ = Format::kPly;
+    layout = parsePly(path, first, last);
+  } else {
+    format_ = Format::kPcd;
+    layout = parsePcd(path, first, last);
+  }
+  const std::pair<std::size_t, std::size_t> coordinates =
+      findCoordinates(path, layout.fields);
+  // A z field with a count of 0 takes no room in the records.
+  if (layout.stride < coordinates.first + 3 * coordinates.second) {
+    fail(path, "records of " + std::to_string(layout.stride) +
+                   " bytes cannot hold x, y and z");
+  }
+  if (layout.data_offset > map_size_ ||
+      (layout.count > 0 &&
+       (map_size_ - layout.data_offset) / layout.stride < layout.count)) {
+    fail(path, "file is shorter than its " + std::to_string(layout.count) +
+                   " points");
+  }
+  points_ = map_ + layout.data_offset + coordinates.first;
+  size_ = layout.count;
+  stride_ = layout.stride;
+  scalar_size_ = coordinates.second;
+  unmapper.file = nullptr;
+  advise(access);
+}
+
+PointFile::PointFile(PointFile&& other) noexcept { *this = std::move(other); }
+
+PointFile& PointFile::operator=(PointFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    std::swap(map_, other.map_);
+    std::swap(map_size_, other.map_size_);
+    format_ = other.format_;
+    points_ = other.points_;
+    size_ = other.size_;
+    stride_ = other.stride_;
+    scalar_size_ = other.scalar_size_;
+    other.points_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+PointFile::~PointFile() { unmap(); }
+
+void PointFile::advise(const Access access) const {
+  if (map_ != nullptr) {
+    // Only a hint: a failure leaves the default behavior.
+    ::madvise(map_, map_size_, toAdvice(access));
+  }
+}
+
+void PointFile::unmap() {
+  if (map_ != nullptr) {
+    ::munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+  }
+}
+
+}  // namespace math
+}  // namespace ekumen
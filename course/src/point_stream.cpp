@@ -0,0 +1,279 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <isometry/error.hpp>
+#include <isometry/point_stream.hpp>
+
+namespace ekumen {
+namespace math {
+namespace {
+
+// Queue of the indices of the buffers handed from a stage of the pipeline to
+// the next one. Pushes never block, since a stage only pushes buffers it got
+// from the ring.
+class Channel {
+ public:
+  void push(const std::size_t index) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      indices_.push_back(index);
+    }
+    ready_.notify_one();
+  }
+
+  // Takes the next index, waiting for one. Returns false once the channel is
+  // closed and empty.
+  bool pop(std::size_t* index) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    ready_.wait(lock, [this] { return closed_ || !indices_.empty(); });
+    if (indices_.empty()) {
+      return false;
+    }
+    *index = indices_.front();
+    indices_.pop_front();
+    return true;
+  }
+
+  // Tells the next stage that no more buffers come.
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      closed_ = true;
+    }
+    ready_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::size_t> indices_;
+  bool closed_{false};
+};
+
+// A buffer of whole records.
+struct Buffer {
+  std::vector<std::uint8_t> bytes;
+  // Number of records it holds.
+  std::size_t count{0};
+};
+
+// First error of the pipeline, reported by the calling thread once every
+// stage has stopped, since the other threads cannot throw.
+class Status {
+ public:
+  void fail(const std::string& message) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (message_.empty()) {
+      message_ = message;
+    }
+    failed_ = true;
+  }
+
+  bool failed() const { return failed_; }
+
+  std::string message() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return message_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::string message_;
+  std::atomic<bool> failed_{false};
+};
+
+std::string errorMessage(const char* operation, const int error) {
+  return std::string(operation) + " failed: " + std::strerror(error);
+}
+
+// Reads until `size` bytes are read or the input ends, returning the number
+// of bytes read, or -1 with errno set on failure.
+ssize_t readFully(const int fd, std::uint8_t* data, const std::size_t size) {
+  std::size_t done{0};
+  while (done < size) {
+    const ssize_t result = ::read(fd, data + done, size - done);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (result == 0) {
+      break;
+    }
+    done += static_cast<std::size_t>(result);
+  }
+  return static_cast<ssize_t>(done);
+}
+
+// Writes `size` bytes, returning false with errno set on failure.
+bool writeFully(const int fd, const std::uint8_t* data,
+                const std::size_t size) {
+  std::size_t done{0};
+  while (done < size) {
+    const ssize_t result = ::write(fd, data + done, size - done);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    done += static_cast<std::size_t>(result);
+  }
+  return true;
+}
+
+// Transforms the coordinates of a buffer in place. Records holding only the
+// coordinates go through the interleaved kernel, others through the strided
+// one into `scratch`, and are then patched.
+template <typename P>
+void transformRecords(const Matrix3T<P>& rotation,
+                      const Vector3T<P>& translation, const std::size_t stride,
+                      const std::size_t offset, Buffer* buffer,
+                      std::vector<P>* scratch) {
+  std::uint8_t* records = buffer->bytes.data();
+  if (stride == 3 * sizeof(P)) {
+    P* xyz = reinterpret_cast<P*>(records);
+    internal::transformPoints(rotation, translation, xyz, buffer->count, xyz);
+    return;
+  }
+  internal::transformPoints(rotation, translation, records + offset, stride,
+                            buffer->count, scratch->data());
+  for (std::size_t i = 0; i < buffer->count; ++i) {
+    std::memcpy(records + i * stride + offset, scratch->data() + 3 * i,
+                3 * sizeof(P));
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+template <typename P>
+std::size_t streamTransform(const Matrix3T<P>& rotation,
+                            const Vector3T<P>& translation, const int input,
+                            const int output, const std::size_t stride,
+                            const std::size_t offset,
+                            const StreamOptions& options) {
+  if (stride < 3 * sizeof(P) || offset > stride - 3 * sizeof(P)) {
+    fail<std::invalid_argument>(
+        "Records of " + std::to_string(stride) +
+        " bytes cannot hold 3 coordinates at offset " + std::to_string(offset));
+  }
+  if (options.buffers < 2) {
+    fail<std::invalid_argument>("A stream needs at least 2 buffers");
+  }
+  if (options.buffer_size < stride) {
+    fail<std::invalid_argument>("Stream buffers cannot hold a record");
+  }
+  const std::size_t capacity = options.buffer_size / stride;
+  std::vector<Buffer> buffers(options.buffers);
+  for (Buffer& buffer : buffers) {
+    buffer.bytes.resize(capacity * stride);
+  }
+  // Only a hint, which pipes and sockets reject.
+  ::posix_fadvise(input, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  // Buffers go around the ring from the reader to the transformer to the
+  // writer and back. Each stage closes the channel to the next one when it
+  // stops, and the writer closes the one to the reader when it fails, so
+  // that every stage stops on the first error.
+  Channel empty;
+  Channel read;
+  Channel transformed;
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    empty.push(i);
+  }
+  Status status;
+  std::size_t written{0};
+
+  std::thread transformer{[&] {
+    std::vector<P> scratch(stride == 3 * sizeof(P) ? 0 : 3 * capacity);
+    std::size_t index;
+    while (read.pop(&index)) {
+      transformRecords(rotation, translation, stride, offset, &buffers[index],
+                       &scratch);
+      transformed.push(index);
+    }
+    transformed.close();
+  }};
+  std::thread writer{[&] {
+    std::size_t index;
+    while (transformed.pop(&index)) {
+      const Buffer& buffer = buffers[index];
+      if (!writeFully(output, buffer.bytes.data(), buffer.count * stride)) {
+        status.fail(errorMessage("write", errno));
+        empty.close();
+        return;
+      }
+      written += buffer.count;
+      empty.push(index);
+    }
+  }};
+
+  std::size_t index;
+  while (empty.pop(&index) && !status.failed()) {
+    Buffer& buffer = buffers[index];
+    const ssize_t size = readFully(input, buffer.bytes.data(),
+                                   buffer.bytes.size());
+    if (size < 0) {
+      status.fail(errorMessage("read", errno));
+      break;
+    }
+    const std::size_t bytes = static_cast<std::size_t>(size);
+    buffer.count = bytes / stride;
+    if (buffer.count > 0) {
+      read.push(index);
+    }
+    if (bytes < buffer.bytes.size()) {
+      if (bytes % stride != 0) {
+        status.fail("Input ends within a record");
+      }
+      break;
+    }
+  }
+  read.close();
+  transformer.join();
+  writer.join();
+
+  const std::string message = status.message();
+  if (!message.empty()) {
+    fail<std::runtime_error>(message);
+  }
+  return written;
+}
+
+template std::size_t streamTransform(const Matrix3T<double>& rotation,
+                                     const Vector3T<double>& translation,
+                                     const int input, const int output,
+                                     const std::size_t stride,
+                                     const std::size_t offset,
+                                     const StreamOptions& options);
+template std::size_t streamTransform(const Matrix3T<float>& rotation,
+                                     const Vector3T<float>& translation,
+                                     const int input, const int output,
+                                     const std::size_t stride,
+                                     const std::size_t offset,
+                                     const StreamOptions& options);
+
+}  // namespace internal
+}  // namespace math
+}  // namespace ekumen
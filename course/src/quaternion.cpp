@@ -0,0 +1,89 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <limits>
+
+#include <isometry/quaternion.hpp>
+
+namespace ekumen {
+namespace math {
+
+template <typename T>
+QuaternionT<T> QuaternionT<T>::fromAxisAngle(const Vector3T<T>& axis,
+                                             const T radians) {
+  const T half = radians / T{2};
+  const Vector3T<T> v = axis * (std::sin(half) / axis.norm());
+  return QuaternionT(std::cos(half), v.x(), v.y(), v.z());
+}
+
+// Shepperd's method: the square root is taken of the largest of the four
+// candidate diagonal combinations, which keeps the divisions well conditioned
+// for any rotation angle.
+template <typename T>
+QuaternionT<T> QuaternionT<T>::fromRotationMatrix(const Matrix3T<T>& matrix) {
+  const T m00 = matrix(0, 0);
+  const T m11 = matrix(1, 1);
+  const T m22 = matrix(2, 2);
+  const T trace = m00 + m11 + m22;
+  if (trace > T{0}) {
+    const T s = T{2} * std::sqrt(trace + T{1});
+    return QuaternionT(s / T{4}, (matrix(2, 1) - matrix(1, 2)) / s,
+                       (matrix(0, 2) - matrix(2, 0)) / s,
+                       (matrix(1, 0) - matrix(0, 1)) / s);
+  }
+  if (m00 > m11 && m00 > m22) {
+    const T s = T{2} * std::sqrt(T{1} + m00 - m11 - m22);
+    return QuaternionT((matrix(2, 1) - matrix(1, 2)) / s, s / T{4},
+                       (matrix(0, 1) + matrix(1, 0)) / s,
+                       (matrix(0, 2) + matrix(2, 0)) / s);
+  }
+  if (m11 > m22) {
+    const T s = T{2} * std::sqrt(T{1} + m11 - m00 - m22);
+    return QuaternionT((matrix(0, 2) - matrix(2, 0)) / s,
+                       (matrix(0, 1) + matrix(1, 0)) / s, s / T{4},
+                       (matrix(1, 2) + matrix(2, 1)) / s);
+  }
+  const T s = T{2} * std::sqrt(T{1} + m22 - m00 - m11);
+  return QuaternionT((matrix(1, 0) - matrix(0, 1)) / s,
+                     (matrix(0, 2) + matrix(2, 0)) / s,
+                     (matrix(1, 2) + matrix(2, 1)) / s, s / T{4});
+}
+
+template <typename T>
+bool QuaternionT<T>::operator==(const QuaternionT& quaternion) const {
+  bool same{true};
+  bool opposite{true};
+  for (int i = 0; i < 4; ++i) {
+    same = same && std::fabs(data_[i] - quaternion.data_[i]) <=
+                       std::numeric_limits<T>::epsilon();
+    opposite = opposite && std::fabs(data_[i] + quaternion.data_[i]) <=
+                               std::numeric_limits<T>::epsilon();
+  }
+  return same || opposite;
+}
+
+template <typename T>
+bool QuaternionT<T>::operator!=(const QuaternionT& quaternion) const {
+  return !(*this == quaternion);
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const QuaternionT<T>& quaternion) {
+  os << "(w: " << quaternion.w() << ", x: " << quaternion.x()
+     << ", y: " << quaternion.y() << ", z: " << quaternion.z() << ")";
+  return os;
+}
+
+template class QuaternionT<double>;
+template class QuaternionT<float>;
+template std::ostream& operator<<(std::ostream& os,
+                                  const QuaternionT<double>& quaternion);
+template std::ostream& operator<<(std::ostream& os,
+                                  const QuaternionT<float>& quaternion);
+
+}  // namespace math
+}  // namespace ekumen
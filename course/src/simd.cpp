@@ -0,0 +1,324 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <isometry/isometry.hpp>
+#include <isometry/point_cloud.hpp>
+#include <isometry/simd.hpp>
+
+namespace ekumen {
+namespace math {
+namespace {
+
+// The kernels are written once and inlined into one copy per level below,
+// each compiled for its own instruction set by a function attribute. Headers
+// are compiled for the baseline as usual, so no wider instruction can leak
+// into the code shared with the rest of the program.
+
+// The rotation and translation are loaded once into locals so the loop body
+// only touches the point streams, which lets the compiler keep them in
+// registers and vectorize the loop.
+template <typename T>
+__attribute__((always_inline)) inline void transformKernel(
+    const Matrix3T<T>& rotation, const Vector3T<T>& translation,
+    const T* input, const std::size_t count, T* output) {
+  const T r00 = rotation(0, 0);
+  const T r01 = rotation(0, 1);
+  const T r02 = rotation(0, 2);
+  const T r10 = rotation(1, 0);
+  const T r11 = rotation(1, 1);
+  const T r12 = rotation(1, 2);
+  const T r20 = rotation(2, 0);
+  const T r21 = rotation(2, 1);
+  const T r22 = rotation(2, 2);
+  const T tx = translation.x();
+  const T ty = translation.y();
+  const T tz = translation.z();
+  for (std::size_t i = 0; i < count; ++i) {
+    const T x = input[3 * i];
+    const T y = input[3 * i + 1];
+    const T z = input[3 * i + 2];
+    output[3 * i] = r00 * x + r01 * y + r02 * z + tx;
+    output[3 * i + 1] = r10 * x + r11 * y + r12 * z + ty;
+    output[3 * i + 2] = r20 * x + r21 * y + r22 * z + tz;
+  }
+}
+
+// Each coordinate array is a contiguous, aligned stream, so the loop
+// vectorizes without shuffles and processes as many points per instruction
+// as the SIMD width allows: with doubles, 2 with SSE2, 4 with AVX2 and 8 with
+// AVX-512, and twice as many with floats. Outputs either are the inputs or do
+// not overlap them, so iterations never depend on each other and the aliasing
+// checks the compiler cannot fit are skipped.
+template <typename T>
+__attribute__((always_inline)) inline void transformPlanarKernel(
+    const Matrix3T<T>& rotation, const Vector3T<T>& translation, const T* x,
+    const T* y, const T* z, const std::size_t count, T* out_x, T* out_y,
+    T* out_z) {
+  constexpr std::size_t kAlignment{PointCloudT<T>::kAlignment};
+  x = static_cast<const T*>(__builtin_assume_aligned(x, kAlignment));
+  y = static_cast<const T*>(__builtin_assume_aligned(y, kAlignment));
+  z = static_cast<const T*>(__builtin_assume_aligned(z, kAlignment));
+  out_x = static_cast<T*>(__builtin_assume_aligned(out_x, kAlignment));
+  out_y = static_cast<T*>(__builtin_assume_aligned(out_y, kAlignment));
+  out_z = static_cast<T*>(__builtin_assume_aligned(out_z, kAlignment));
+  const T r00 = rotation(0, 0);
+  const T r01 = rotation(0, 1);
+  const T r02 = rotation(0, 2);
+  const T r10 = rotation(1, 0);
+  const T r11 = rotation(1, 1);
+  const T r12 = rotation(1, 2);
+  const T r20 = rotation(2, 0);
+  const T r21 = rotation(2, 1);
+  const T r22 = rotation(2, 2);
+  const T tx = translation.x();
+  const T ty = translation.y();
+  const T tz = translation.z();
+#pragma GCC ivdep
+  for (std::size_t i = 0; i < count; ++i) {
+    const T px = x[i];
+    const T py = y[i];
+    const T pz = z[i];
+    out_x[i] = r00 * px + r01 * py + r02 * pz + tx;
+    out_y[i] = r10 * px + r11 * py + r12 * pz + ty;
+    out_z[i] = r20 * px + r21 * py + r22 * pz + tz;
+  }
+}
+
+// Every coordinate is loaded with memcpy, which compiles to plain unaligned
+// loads, since records of mapped files can start at any byte.
+template <typename T>
+__attribute__((always_inline)) inline void transformStridedKernel(
+    const Matrix3T<T>& rotation, const Vector3T<T>& translation,
+    const std::uint8_t* input, const std::size_t stride,
+    const std::size_t count, T* output) {
+  const T r00 = rotation(0, 0);
+  const T r01 = rotation(0, 1);
+  const T r02 = rotation(0, 2);
+  const T r10 = rotation(1, 0);
+  const T r11 = rotation(1, 1);
+  const T r12 = rotation(1, 2);
+  const T r20 = rotation(2, 0);
+  const T r21 = rotation(2, 1);
+  const T r22 = rotation(2, 2);
+  const T tx = translation.x();
+  const T ty = translation.y();
+  const T tz = translation.z();
+  for (std::size_t i = 0; i < count; ++i) {
+    T xyz[3];
+    std::memcpy(xyz, input + i * stride, sizeof(xyz));
+    output[3 * i] = r00 * xyz[0] + r01 * xyz[1] + r02 * xyz[2] + tx;
+    output[3 * i + 1] = r10 * xyz[0] + r11 * xyz[1] + r12 * xyz[2] + ty;
+    output[3 * i + 2] = r20 * xyz[0] + r21 * xyz[1] + r22 * xyz[2] + tz;
+  }
+}
+
+// Defines the class template `Name`, whose static members are copies of the
+// kernels compiled with `attributes`, and whose table() lists them.
+#define ISOMETRY_DEFINE_KERNELS(Name, attributes)                             \
+  template <typename T>                                                       \
+  struct Name {                                                               \
+    attributes static void transform(const Matrix3T<T>& rotation,             \
+                                     const Vector3T<T>& translation,          \
+                                     const T* input, const std::size_t count, \
+                                     T* output) {                             \
+      transformKernel(rotation, translation, input, count, output);           \
+    }                                                                         \
+    attributes static void transformPlanar(                                   \
+        const Matrix3T<T>& rotation, const Vector3T<T>& translation,          \
+        const T* x, const T* y, const T* z, const std::size_t count,          \
+        T* out_x, T* out_y, T* out_z) {                                       \
+      transformPlanarKernel(rotation, translation, x, y, z, count, out_x,     \
+                            out_y, out_z);                                    \
+    }                                                                         \
+    attributes static void transformStrided(                                  \
+        const Matrix3T<T>& rotation, const Vector3T<T>& translation,          \
+        const std::uint8_t* input, const std::size_t stride,                  \
+        const std::size_t count, T* output) {                                 \
+      transformStridedKernel(rotation, translation, input, stride, count,     \
+                             output);                                         \
+    }                                                                         \
+    static internal::SimdKernels<T> table() {                                 \
+      return internal::SimdKernels<T>{&transform, &transformPlanar,           \
+                                      &transformStrided};                     \
+    }                                                                         \
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ISOMETRY_X86 1
+ISOMETRY_DEFINE_KERNELS(ScalarKernels,
+                        __attribute__((optimize("no-tree-vectorize"))));
+ISOMETRY_DEFINE_KERNELS(Sse2Kernels, __attribute__((target("sse2"))));
+ISOMETRY_DEFINE_KERNELS(Avx2Kernels, __attribute__((target("avx2"))));
+ISOMETRY_DEFINE_KERNELS(Avx512Kernels, __attribute__((target("avx512f"))));
+#else
+#define ISOMETRY_X86 0
+ISOMETRY_DEFINE_KERNELS(ScalarKernels, );
+#endif
+
+#undef ISOMETRY_DEFINE_KERNELS
+
+SimdLevel detectSimdLevel() {
+#if ISOMETRY_X86
+  // Also checks that the operating system saves the wider registers.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SimdLevel::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::kSse2;
+  }
+#endif
+  return SimdLevel::kScalar;
+}
+
+SimdLevel selectSimdLevel() {
+  const SimdLevel supported = supportedSimdLevel();
+  const char* name = std::getenv("ISOMETRY_SIMD");
+  if (name == nullptr || *name == '\0') {
+    return supported;
+  }
+  SimdLevel level;
+  if (!parseSimdLevel(name, &level)) {
+    std::fprintf(stderr, "ISOMETRY_SIMD: unknown level %s, using %s\n", name,
+                 toString(supported));
+    return supported;
+  }
+  if (level > supported) {
+    std::fprintf(stderr, "ISOMETRY_SIMD: %s is not supported, using %s\n",
+                 name, toString(supported));
+    return supported;
+  }
+  return level;
+}
+
+}  // namespace
+
+SimdLevel supportedSimdLevel() {
+  static const SimdLevel level = detectSimdLevel();
+  return level;
+}
+
+SimdLevel activeSimdLevel() {
+  static const SimdLevel level = selectSimdLevel();
+  return level;
+}
+
+const char* toString(const SimdLevel level) {
+  switch (level) {
+    case SimdLevel::kSse2:
+      return "sse2";
+    case SimdLevel::kAvx2:
+      return "avx2";
+    case SimdLevel::kAvx512:
+      return "avx512";
+    case SimdLevel::kScalar:
+    default:
+      return "scalar";
+  }
+}
+
+bool parseSimdLevel(const std::string& name, SimdLevel* level) {
+  for (const SimdLevel candidate : {SimdLevel::kScalar, SimdLevel::kSse2,
+                                    SimdLevel::kAvx2, SimdLevel::kAvx512}) {
+    if (name == toString(candidate)) {
+      *level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace internal {
+
+template <typename T>
+const SimdKernels<T>& simdKernels(const SimdLevel level) {
+  static const SimdKernels<T> kTables[] = {
+      ScalarKernels<T>::table(),
+#if ISOMETRY_X86
+      Sse2Kernels<T>::table(),
+      Avx2Kernels<T>::table(),
+      Avx512Kernels<T>::table(),
+#endif
+  };
+  return kTables[static_cast<int>(std::min(level, supportedSimdLevel()))];
+}
+
+template <typename T>
+const SimdKernels<T>& simdKernels() {
+  static const SimdKernels<T>& kernels = simdKernels<T>(activeSimdLevel());
+  return kernels;
+}
+
+template const SimdKernels<double>& simdKernels(const SimdLevel level);
+template const SimdKernels<float>& simdKernels(const SimdLevel level);
+template const SimdKernels<double>& simdKernels();
+template const SimdKernels<float>& simdKernels();
+
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const T* input,
+                     const std::size_t count, T* output) {
+  simdKernels<T>().transform(rotation, translation, input, count, output);
+}
+
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const T* x, const T* y,
+                     const T* z, const std::size_t count, T* out_x, T* out_y,
+                     T* out_z) {
+  simdKernels<T>().transform_planar(rotation, translation, x, y, z, count,
+                                    out_x, out_y, out_z);
+}
+
+template <typename T>
+void transformPoints(const Matrix3T<T>& rotation,
+                     const Vector3T<T>& translation, const std::uint8_t* input,
+                     const std::size_t stride, const std::size_t count,
+                     T* output) {
+  simdKernels<T>().transform_strided(rotation, translation, input, stride,
+                                     count, output);
+}
+
+template void transformPoints(const Matrix3T<double>& rotation,
+                              const Vector3T<double>& translation,
+                              const double* input, const std::size_t count,
+                              double* output);
+template void transformPoints(const Matrix3T<float>& rotation,
+                              const Vector3T<float>& translation,
+                              const float* input, const std::size_t count,
+                              float* output);
+template void transformPoints(const Matrix3T<double>& rotation,
+                              const Vector3T<double>& translation,
+                              const double* x, const double* y,
+                              const double* z, const std::size_t count,
+                              double* out_x, double* out_y, double* out_z);
+template void transformPoints(const Matrix3T<float>& rotation,
+                              const Vector3T<float>& translation,
+                              const float* x, const float* y, const float* z,
+                              const std::size_t count, float* out_x,
+                              float* out_y, float* out_z);
+template void transformPoints(const Matrix3T<double>& rotation,
+                              const Vector3T<double>& translation,
+                              const std::uint8_t* input,
+                              const std::size_t stride,
+                              const std::size_t count, double* output);
+template void transformPoints(const Matrix3T<float>& rotation,
+                              const Vector3T<float>& translation,
+                              const std::uint8_t* input,
+                              const std::size_t stride,
+                              const std::size_t count, float* output);
+
+}  // namespace internal
+}  // namespace math
+}  // namespace ekumen
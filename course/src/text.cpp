@@ -0,0 +1,543 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <isometry/text.hpp>
+
+namespace ekumen {
+namespace math {
+namespace text {
+namespace {
+
+// Powers of ten that are exact in a long double with a 64-bit mantissa.
+constexpr long double kPowersOf10[] = {
+    1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,
+    1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+    1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L};
+
+// Largest power of ten that is exact in a double.
+constexpr int kMaxExactDoublePower{22};
+
+// Largest power of ten that is exact in a long double with a 64-bit
+// mantissa, since 5^27 < 2^64.
+constexpr int kMaxExactLongDoublePower{27};
+
+// Relative distance to a halfway point under which a long double result
+// may round either way, two units of its 64-bit mantissa.
+constexpr long double kHalfwayTolerance{1.L / (std::uint64_t{1} << 62)};
+
+// Number of decimal digits that always fit in the mantissa accumulator.
+constexpr int kMaxMantissaDigits{19};
+
+// Significant digits that are enough to round any decimal number correctly,
+// since halfway points between doubles have at most 767.
+constexpr int kMaxSignificantDigits{768};
+
+inline bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+
+// Loads 8 characters as a little-endian word.
+inline std::uint64_t loadEightChars(const char* c) {
+  std::uint64_t word;
+  std::memcpy(&word, c, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+// Whether all 8 characters of `word` are digits: no byte is below '0' nor
+// above '9', tested on all bytes at once.
+inline bool isEightDigits(const std::uint64_t word) {
+  return (((word + 0x4646464646464646) | (word - 0x3030303030303030)) &
+          0x8080808080808080) == 0;
+}
+
+// Converts 8 digits, the first one in the lowest byte, to their value by
+// combining pairs of digits, then pairs of pairs, then the two halves.
+inline std::uint64_t parseEightDigits(std::uint64_t word) {
+  word -= 0x3030303030303030;
+  word = (word * 10) + (word >> 8);
+  word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+          (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+         32;
+  return word & 0xffffffff;
+}
+
+inline bool isSpace(const char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline const char* skipSpaces(const char* first, const char* last) {
+  while (first != last && isSpace(*first)) {
+    ++first;
+  }
+  return first;
+}
+
+// Rounds mantissa * 10^exponent to the nearest double, returning false when
+// it cannot be done quickly.
+//
+// Mantissas up to 2^53 with small exponents are exact doubles multiplied or
+// divided by an exact power of ten, which is a single correctly rounded
+// operation. Larger mantissas are computed in a 64-bit long double, which is
+// then only rounded to double when it is not within a couple of units of a
+// halfway point between two doubles, since the exact value could lie on
+// either side of it.
+bool roundDouble(const std::uint64_t mantissa, const int exponent,
+                 double* value) {
+  if (mantissa == 0) {
+    *value = 0.;
+    return true;
+  }
+  if (mantissa <= (std::uint64_t{1} << 53) &&
+      std::abs(exponent) <= kMaxExactDoublePower) {
+    const double base = static_cast<double>(mantissa);
+    const double power = static_cast<double>(kPowersOf10[std::abs(exponent)]);
+    *value = exponent >= 0 ? base * power : base / power;
+    return true;
+  }
+  if (std::numeric_limits<long double>::digits >= 64 &&
+      std::abs(exponent) <= kMaxExactLongDoublePower) {
+    const long double base = static_cast<long double>(mantissa);
+    const long double power = kPowersOf10[std::abs(exponent)];
+    const long double result = exponent >= 0 ? base * power : base / power;
+    // The neighbour of the nearest double on the side of `result` bounds the
+    // halfway point, which is exact in a long double.
+    const double nearest = static_cast<double>(result);
+    std::uint64_t bits;
+    std::memcpy(&bits, &nearest, sizeof(bits));
+    bits += result > nearest ? 1 : -1;
+    double neighbour;
+    std::memcpy(&neighbour, &bits, sizeof(neighbour));
+    const long double halfway =
+        (static_cast<long double>(nearest) + neighbour) / 2;
+    if (std::fabs(result - halfway) > result * kHalfwayTolerance) {
+      *value = nearest;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Computes mantissa * 10^exponent rounded to the nearest double, through
+// strtod when roundDouble() cannot, on digits without a decimal point so
+// that the locale does not matter.
+double composeDouble(const std::uint64_t mantissa, const int exponent) {
+  double value;
+  if (roundDouble(mantissa, exponent, &value)) {
+    return value;
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%llue%d",
+                static_cast<unsigned long long>(mantissa), exponent);
+  return std::strtod(buffer, nullptr);
+}
+
+// Computes the value of a number whose digits past the mantissa were not all
+// zeros, so that it lies strictly between mantissa and mantissa + 1 times
+// 10^exponent. It is only rounded quickly when both ends round to the same
+// double. Otherwise strtod rounds the digits of [first, last), which have at
+// most one decimal point, times 10^explicit_exponent: those past
+// kMaxSignificantDigits are replaced by a sticky digit, since no halfway
+// point between doubles has that many.
+double composeTruncated(const std::uint64_t mantissa, const int exponent,
+                        const char* first, const char* last,
+                        const int explicit_exponent) {
+  double lower;
+  double upper;
+  if (roundDouble(mantissa, exponent, &lower) &&
+      roundDouble(mantissa + 1, exponent, &upper) && lower == upper) {
+    return lower;
+  }
+  char buffer[kMaxSignificantDigits + 16];
+  int count{0};
+  long long scale{explicit_exponent};
+  bool fraction{false};
+  bool sticky{false};
+  for (const char* c = first; c != last; ++c) {
+    if (*c == '.') {
+      fraction = true;
+      continue;
+    }
+    scale -= fraction ? 1 : 0;
+    if (count == kMaxSignificantDigits) {
+      sticky = sticky || *c != '0';
+      ++scale;
+    } else if (count > 0 || *c != '0') {
+      buffer[count++] = *c;
+    }
+  }
+  if (sticky) {
+    buffer[count++] = '1';
+    --scale;
+  }
+  // Far past the range of doubles either way, as the explicit exponent is.
+  scale = std::max(std::min(scale, 1000000LL), -1000000LL);
+  std::snprintf(buffer + count, sizeof(buffer) - count, "e%lld", scale);
+  return std::strtod(buffer, nullptr);
+}
+
+inline char* write(const char* text, const std::size_t length, char* first,
+                   char* last) {
+  if (first == nullptr || static_cast<std::size_t>(last - first) < length) {
+    return nullptr;
+  }
+  std::memcpy(first, text, length);
+  return first + length;
+}
+
+template <std::size_t N>
+inline char* write(const char (&text)[N], char* first, char* last) {
+  return write(text, N - 1, first, last);
+}
+
+// Parses the character `c`, after optional whitespace.
+inline const char* expect(const char* first, const char* last, const char c) {
+  if (first == nullptr) {
+    return nullptr;
+  }
+  first = skipSpaces(first, last);
+  return first != last && *first == c ? first + 1 : nullptr;
+}
+
+// Parses `c`, a colon and a number, as in "x: 1".
+inline const char* parseField(const char* first, const char* last,
+                              const char c, double* value) {
+  first = expect(expect(first, last, c), last, ':');
+  return first == nullptr ? nullptr : parse(first, last, value);
+}
+
+// Parses "[a, b, c]" into a row of a matrix.
+const char* parseRow(const char* first, const char* last, const int row,
+                     Matrix3* matrix) {
+  first = expect(first, last, '[');
+  for (int col = 0; col < 3 && first != nullptr; ++col) {
+    if (col > 0) {
+      first = expect(first, last, ',');
+    }
+    if (first != nullptr) {
+      first = parse(first, last, &(*matrix)(row, col));
+    }
+  }
+  return expect(first, last, ']');
+}
+
+// Reads from `is` one bracketed token, from its opening bracket or
+// parenthesis to the matching closing one, and parses it with text::parse.
+template <typename T>
+std::istream& readBracketed(std::istream& is, T* value) {
+  // Room for the longest formatted value plus generous whitespace.
+  char buffer[4 * kMaxIsometryLength];
+  std::size_t length{0};
+  int depth{0};
+  is >> std::ws;
+  while (length < sizeof(buffer)) {
+    const int c = is.get();
+    if (c == std::char_traits<char>::eof()) {
+      break;
+    }
+    buffer[length++] = static_cast<char>(c);
+    if (c == '(' || c == '[') {
+      ++depth;
+    } else if (c == ')' || c == ']') {
+      --depth;
+    }
+    if (depth <= 0) {
+      break;
+    }
+  }
+  T parsed;
+  if (depth != 0 || length == 0 ||
+      text::parse(buffer, buffer + length, &parsed) != buffer + length) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+  *value = parsed;
+  return is;
+}
+
+}  // namespace
+
+// The digits come from snprintf in scientific notation, which is correctly
+// rounded, with 15, 16 and then 17 significant digits: the first precision
+// that reads back to `value` gives the shortest text, since 17 digits always
+// do. Subnormals start from a single digit.
+char* format(const double value, char* first, char* last) {
+  if (first == nullptr) {
+    return nullptr;
+  }
+  if (std::isnan(value)) {
+    return write("nan", first, last);
+  }
+  if (std::isinf(value)) {
+    return value < 0 ? write("-inf", first, last) : write("inf", first, last);
+  }
+  // One more character for the terminator written by snprintf.
+  char buffer[kMaxDoubleLength + 1];
+  char* out = buffer;
+  if (std::signbit(value)) {
+    *out++ = '-';
+  }
+  const double magnitude = std::fabs(value);
+  if (magnitude == 0.) {
+    *out++ = '0';
+    return write(buffer, out - buffer, first, last);
+  }
+
+  // Every decimal of up to 15 significant digits maps to a distinct normal
+  // double, so a shorter text would only differ by trailing zeros. Subnormals
+  // have fewer significant digits and need the search to start lower.
+  const int shortest =
+      magnitude < std::numeric_limits<double>::min() ? 1 : 15;
+  char digits[17];
+  int count{0};
+  int exponent{0};
+  for (int precision = shortest; precision <= 17; ++precision) {
+    char scientific[32];
+    std::snprintf(scientific, sizeof(scientific), "%.*e", precision - 1,
+                  magnitude);
+    // Collects the digits around the decimal separator, whichever the
+    // locale makes it.
+    const char* c = scientific;
+    count = 0;
+    for (; *c != 'e'; ++c) {
+      if (isDigit(*c)) {
+        digits[count++] = *c;
+      }
+    }
+    exponent = std::atoi(c + 1);
+    while (count > 1 && digits[count - 1] == '0') {
+      --count;
+    }
+    std::uint64_t mantissa{0};
+    for (int i = 0; i < count; ++i) {
+      mantissa = mantissa * 10 + static_cast<std::uint64_t>(digits[i] - '0');
+    }
+    if (precision == 17 ||
+        composeDouble(mantissa, exponent - (count - 1)) == magnitude) {
+      break;
+    }
+  }
+
+  // digits[0].digits[1..count) * 10^exponent.
+  if (exponent < -5 || exponent >= 17) {
+    *out++ = digits[0];
+    if (count > 1) {
+      *out++ = '.';
+      std::memcpy(out, digits + 1, count - 1);
+      out += count - 1;
+    }
+    out += std::snprintf(out, buffer + sizeof(buffer) - out, "e%d", exponent);
+  } else if (exponent < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = -1; i > exponent; --i) {
+      *out++ = '0';
+    }
+    std::memcpy(out, digits, count);
+    out += count;
+  } else {
+    for (int i = 0; i <= exponent; ++i) {
+      *out++ = i < count ? digits[i] : '0';
+    }
+    if (count > exponent + 1) {
+      *out++ = '.';
+      std::memcpy(out, digits + exponent + 1, count - exponent - 1);
+      out += count - exponent - 1;
+    }
+  }
+  return write(buffer, out - buffer, first, last);
+}
+
+char* format(const Vector3& vector, char* first, char* last) {
+  first = format(vector.x(), write("(x: ", first, last), last);
+  first = format(vector.y(), write(", y: ", first, last), last);
+  first = format(vector.z(), write(", z: ", first, last), last);
+  return write(")", first, last);
+}
+
+char* format(const Matrix3& matrix, char* first, char* last) {
+  first = write("[", first, last);
+  for (int row = 0; row < 3; ++row) {
+    first = write(row == 0 ? "[" : ", [", row == 0 ? 1 : 3, first, last);
+    for (int col = 0; col < 3; ++col) {
+      if (col > 0) {
+        first = write(", ", first, last);
+      }
+      first = format(matrix(row, col), first, last);
+    }
+    first = write("]", first, last);
+  }
+  return write("]", first, last);
+}
+
+char* format(const Isometry& isometry, char* first, char* last) {
+  first = format(isometry.translation(), write("[T: ", first, last), last);
+  first = format(isometry.rotation(), write(", R:", first, last), last);
+  return write("]", first, last);
+}
+
+// Digits are accumulated into a 64-bit mantissa and a decimal exponent, and
+// composeDouble() rounds them. Past 19 significant digits the mantissa is
+// full, and the remaining ones only tell whether composeTruncated() has to
+// round a value between two mantissas.
+const char* parse(const char* first, const char* last, double* value) {
+  const char* c = skipSpaces(first, last);
+  bool negative{false};
+  if (c != last && (*c == '-' || *c == '+')) {
+    negative = *c == '-';
+    ++c;
+  }
+  if (last - c >= 3 && (std::memcmp(c, "inf", 3) == 0 ||
+                        std::memcmp(c, "nan", 3) == 0)) {
+    const double special = *c == 'i'
+                               ? std::numeric_limits<double>::infinity()
+                               : std::numeric_limits<double>::quiet_NaN();
+    *value = negative ? -special : special;
+    return c + 3;
+  }
+
+  const char* digits_first = c;
+  std::uint64_t mantissa{0};
+  int digits{0};
+  int exponent{0};
+  int explicit_exponent{0};
+  bool any_digit{false};
+  bool truncated{false};
+  for (; c != last && isDigit(*c); ++c) {
+    any_digit = true;
+    if (digits < kMaxMantissaDigits) {
+      mantissa = mantissa * 10 + static_cast<std::uint64_t>(*c - '0');
+      digits += mantissa != 0 ? 1 : 0;
+    } else {
+      ++exponent;
+      truncated = truncated || *c != '0';
+    }
+  }
+  if (c != last && *c == '.') {
+    ++c;
+    // Leading zeros are not significant digits, so chunks of 8 are only
+    // taken once the mantissa has started.
+    while (c != last && isDigit(*c) && mantissa == 0) {
+      any_digit = true;
+      mantissa = static_cast<std::uint64_t>(*c - '0');
+      digits = mantissa != 0 ? 1 : 0;
+      --exponent;
+      ++c;
+    }
+    while (last - c >= 8 && digits + 8 <= kMaxMantissaDigits &&
+           isEightDigits(loadEightChars(c))) {
+      mantissa = mantissa * 100000000 + parseEightDigits(loadEightChars(c));
+      digits += 8;
+      exponent -= 8;
+      c += 8;
+    }
+    for (; c != last && isDigit(*c); ++c) {
+      any_digit = true;
+      if (digits < kMaxMantissaDigits) {
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*c - '0');
+        digits += mantissa != 0 ? 1 : 0;
+        --exponent;
+      } else {
+        truncated = truncated || *c != '0';
+      }
+    }
+  }
+  if (!any_digit) {
+    return nullptr;
+  }
+  const char* digits_last = c;
+  if (c != last && (*c == 'e' || *c == 'E')) {
+    const char* e = c + 1;
+    bool negative_exponent{false};
+    if (e != last && (*e == '-' || *e == '+')) {
+      negative_exponent = *e == '-';
+      ++e;
+    }
+    if (e != last && isDigit(*e)) {
+      for (; e != last && isDigit(*e); ++e) {
+        // Saturates far beyond the range of doubles.
+        if (explicit_exponent < 100000) {
+          explicit_exponent = explicit_exponent * 10 + (*e - '0');
+        }
+      }
+      explicit_exponent =
+          negative_exponent ? -explicit_exponent : explicit_exponent;
+      exponent += explicit_exponent;
+      c = e;
+    }
+  }
+  const double magnitude =
+      truncated ? composeTruncated(mantissa, exponent, digits_first,
+                                   digits_last, explicit_exponent)
+                : composeDouble(mantissa, exponent);
+  *value = negative ? -magnitude : magnitude;
+  return c;
+}
+
+const char* parse(const char* first, const char* last, Vector3* vector) {
+  Vector3 parsed;
+  first = expect(first, last, '(');
+  first = parseField(first, last, 'x', &parsed.x());
+  first = parseField(expect(first, last, ','), last, 'y', &parsed.y());
+  first = parseField(expect(first, last, ','), last, 'z', &parsed.z());
+  first = expect(first, last, ')');
+  if (first != nullptr) {
+    *vector = parsed;
+  }
+  return first;
+}
+
+const char* parse(const char* first, const char* last, Matrix3* matrix) {
+  Matrix3 parsed;
+  first = expect(first, last, '[');
+  first = parseRow(first, last, 0, &parsed);
+  first = parseRow(expect(first, last, ','), last, 1, &parsed);
+  first = parseRow(expect(first, last, ','), last, 2, &parsed);
+  first = expect(first, last, ']');
+  if (first != nullptr) {
+    *matrix = parsed;
+  }
+  return first;
+}
+
+const char* parse(const char* first, const char* last, Isometry* isometry) {
+  Vector3 translation;
+  Matrix3 rotation;
+  first = expect(expect(expect(first, last, '['), last, 'T'), last, ':');
+  first = first == nullptr ? nullptr : parse(first, last, &translation);
+  first = expect(expect(expect(first, last, ','), last, 'R'), last, ':');
+  first = first == nullptr ? nullptr : parse(first, last, &rotation);
+  first = expect(first, last, ']');
+  if (first != nullptr) {
+    *isometry = Isometry(translation, rotation);
+  }
+  return first;
+}
+
+}  // namespace text
+
+std::istream& operator>>(std::istream& is, Vector3& vector) {
+  return text::readBracketed(is, &vector);
+}
+
+std::istream& operator>>(std::istream& is, Matrix3& matrix) {
+  return text::readBracketed(is, &matrix);
+}
+
+std::istream& operator>>(std::istream& is, Isometry& isometry) {
+  return text::readBracketed(is, &isometry);
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,111 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <isometry/error.hpp>
+#include <isometry/thread_pool.hpp>
+
+namespace ekumen {
+namespace math {
+namespace {
+
+// Runs a task, returning the exception it throws, if any. Without exceptions
+// a failing task aborts instead, so there is nothing to forward.
+std::exception_ptr runTask(const std::function<void(std::size_t)>& task,
+                           const std::size_t index) {
+#if ISOMETRY_HAS_EXCEPTIONS
+  try {
+    task(index);
+  } catch (...) {
+    return std::current_exception();
+  }
+#else
+  task(index);
+#endif
+  return nullptr;
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(const std::size_t threads) {
+  std::size_t count = threads;
+  if (count == 0) {
+    count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  threads_.reserve(count - 1);
+  for (std::size_t index = 1; index < count; ++index) {
+    threads_.emplace_back(&ThreadPool::work, this, index);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+std::size_t ThreadPool::size() const { return threads_.size() + 1; }
+
+void ThreadPool::run(const std::size_t tasks,
+                     const std::function<void(std::size_t)>& task) {
+  std::lock_guard<std::mutex> run_lock{run_mutex_};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    task_ = &task;
+    tasks_ = tasks;
+    pending_ = tasks - 1;
+    error_ = nullptr;
+    ++generation_;
+  }
+  start_.notify_all();
+
+  std::exception_ptr error = runTask(task, 0);
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_.wait(lock, [this] { return pending_ == 0; });
+  task_ = nullptr;
+  if (!error) {
+    error = error_;
+  }
+  lock.unlock();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::work(const std::size_t index) {
+  std::size_t generation{0};
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (true) {
+    start_.wait(lock, [this, generation] {
+      return stop_ || generation_ != generation;
+    });
+    if (stop_) {
+      return;
+    }
+    generation = generation_;
+    if (index >= tasks_) {
+      continue;
+    }
+    const std::function<void(std::size_t)>& task = *task_;
+    lock.unlock();
+    const std::exception_ptr error = runTask(task, index);
+    lock.lock();
+    if (error && !error_) {
+      error_ = error;
+    }
+    if (--pending_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace ekumen
@@ -0,0 +1,119 @@
+/*
+ * Isometry library
+ * Copyright 2020 Ekumen Inc.
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include <isometry/error.hpp>
+#include <isometry/transform_buffer.hpp>
+
+namespace ekumen {
+namespace math {
+
+TransformBuffer::TransformBuffer(const std::size_t capacity)
+    : times_(capacity), samples_(capacity) {
+  if (capacity == 0) {
+    internal::fail<std::invalid_argument>(
+        "TransformBuffer capacity must be positive");
+  }
+}
+
+void TransformBuffer::insert(const double time, const Isometry& transform) {
+  if (size_ > 0 && !(time > newestTime())) {
+    internal::fail<std::invalid_argument>(
+        "Sample at " + std::to_string(time) +
+        " is not later than the newest one at " +
+        std::to_string(newestTime()));
+  }
+  std::size_t index;
+  if (size_ < capacity()) {
+    index = slot(size_);
+    ++size_;
+  } else {
+    index = head_;
+    head_ = slot(1);
+  }
+  times_[index] = time;
+  samples_[index].transform = transform;
+  samples_[index].rotation =
+      Quaternion::fromRotationMatrix(transform.rotation());
+}
+
+// Binary search for the first sample not earlier than `time`, over indices
+// from the oldest sample, which are mapped to ring positions on the fly. The
+// halving step is written without branches, since the outcome of each
+// comparison is unpredictable and mispredictions would dominate the cost.
+Isometry TransformBuffer::lookup(const double time) const {
+  checkNotEmpty();
+  if (!(time >= oldestTime() && time <= newestTime())) {
+    internal::fail<std::out_of_range>("Time " + std::to_string(time) +
+                                      " is outside the buffered history [" +
+                                      std::to_string(oldestTime()) + ", " +
+                                      std::to_string(newestTime()) + "]");
+  }
+  std::size_t first = 0;
+  std::size_t count = size_;
+  while (count > 1) {
+    const std::size_t half = count / 2;
+    first = times_[slot(first + half)] < time ? first + half : first;
+    count -= half;
+  }
+  first += times_[slot(first)] < time ? 1 : 0;
+  const std::size_t after = slot(first);
+  if (times_[after] == time) {
+    return samples_[after].transform;
+  }
+  const std::size_t before = slot(first - 1);
+  const double t =
+      (time - times_[before]) / (times_[after] - times_[before]);
+  const Sample& from = samples_[before];
+  const Sample& to = samples_[after];
+  return Isometry(from.transform.translation() +
+                      (to.transform.translation() -
+                       from.transform.translation()) *
+                          t,
+                  from.rotation.slerp(to.rotation, t).toRotationMatrix());
+}
+
+const Isometry& TransformBuffer::latest() const {
+  checkNotEmpty();
+  return samples_[slot(size_ - 1)].transform;
+}
+
+double TransformBuffer::oldestTime() const {
+  checkNotEmpty();
+  return times_[head_];
+}
+
+double TransformBuffer::newestTime() const {
+  checkNotEmpty();
+  return times_[slot(size_ - 1)];
+}
+
+void TransformBuffer::clear() {
+  head_ = 0;
+  size_ = 0;
+}
+
+std::size_t TransformBuffer::size() const { return size_; }
+
+std::size_t TransformBuffer::capacity() const { return times_.size(); }
+
+bool TransformBuffer::empty() const { return size_ == 0; }
+
+std::size_t TransformBuffer::slot(const std::size_t index) const {
+  const std::size_t position = head_ + index;
+  return position < capacity() ? position : position - capacity();
+}
+
+void TransformBuffer::checkNotEmpty() const {
+  if (size_ == 0) {
+    internal::fail<std::out_of_range>("TransformBuffer is empty");
+  }
+}
+
+}  // namespace math
+}  // namespace ekumen
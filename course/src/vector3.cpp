@@ -5,180 +5,51 @@
  */
 
 #include <isometry/vector3.hpp>
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 
 namespace ekumen {
 namespace math {
 
-const Vector3 Vector3::kZero{Vector3(0., 0., 0.)};
-const Vector3 Vector3::kUnitX{Vector3(1., 0., 0.)};
-const Vector3 Vector3::kUnitY{Vector3(0., 1., 0.)};
-const Vector3 Vector3::kUnitZ{Vector3(0., 0., 1.)};
-
-Vector3::Vector3() : x_{0.}, y_{0.}, z_{0.} {}
-
-Vector3::Vector3(std::initializer_list<double> list) {
+template <typename T>
+Vector3T<T>::Vector3T(std::initializer_list<T> list) : data_{} {
   if (list.size() != 3) {
-    throw std::runtime_error(
+    internal::fail<std::runtime_error>(
         "Initializer list constructor requires 3 elements.");
   }
-  auto it = std::begin(list);
-  x_ = *it++;
-  y_ = *it++;
-  z_ = *it;
-}
-
-Vector3::Vector3(const double x, const double y, const double z)
-    : x_{x}, y_{y}, z_{z} {}
-
-Vector3 Vector3::operator+(const Vector3& vector) const {
-  Vector3 aux{*this};
-  aux += vector;
-  return aux;
-}
-
-Vector3 Vector3::operator-(const Vector3& vector) const {
-  Vector3 aux{*this};
-  aux -= vector;
-  return aux;
-}
-
-Vector3 Vector3::operator*(const Vector3& vector) const {
-  Vector3 aux{*this};
-  aux *= vector;
-  return aux;
-}
-
-Vector3 Vector3::operator*(double scalar) const {
-  Vector3 aux{*this};
-  aux *= scalar;
-  return aux;
-}
-
-Vector3 operator*(double scalar, const Vector3& vector) {
-  return vector * scalar;
-}
-
-Vector3 Vector3::operator/(const Vector3& vector) const {
-  Vector3 aux{*this};
-  aux /= vector;
-  return aux;
-}
-
-Vector3 Vector3::operator/(double scalar) const {
-  Vector3 aux{*this};
-  aux /= scalar;
-  return aux;
-}
-
-Vector3& Vector3::operator+=(const Vector3& vector) {
-  x_ += vector.x();
-  y_ += vector.y();
-  z_ += vector.z();
-  return *this;
-}
-
-Vector3& Vector3::operator-=(const Vector3& vector) {
-  x_ -= vector.x();
-  y_ -= vector.y();
-  z_ -= vector.z();
-  return *this;
-}
-
-Vector3& Vector3::operator*=(const Vector3& vector) {
-  x_ *= vector.x();
-  y_ *= vector.y();
-  z_ *= vector.z();
-  return *this;
+  std::copy(list.begin(), list.end(), data_);
 }
 
-Vector3& Vector3::operator*=(const double scalar) {
-  x_ *= scalar;
-  y_ *= scalar;
-  z_ *= scalar;
-  return *this;
-}
-
-Vector3& Vector3::operator/=(const Vector3& vector) {
-  x_ /= vector.x();
-  y_ /= vector.y();
-  z_ /= vector.z();
-  return *this;
-}
-
-Vector3& Vector3::operator/=(const double scalar) {
-  x_ /= scalar;
-  y_ /= scalar;
-  z_ /= scalar;
-  return *this;
-}
-
-bool Vector3::operator==(const Vector3& vector) const {
-  return std::fabs(x_ - vector.x()) <= std::numeric_limits<double>::epsilon() &&
-         std::fabs(y_ - vector.y()) <= std::numeric_limits<double>::epsilon() &&
-         std::fabs(z_ - vector.z()) <= std::numeric_limits<double>::epsilon();
-}
-
-bool Vector3::operator!=(const Vector3& vector) const {
-  return !(*this == vector);
-}
-
-double Vector3::operator[](const int index) const {
-  switch (index) {
-    case 0:
-      return x_;
-    case 1:
-      return y_;
-    case 2:
-      return z_;
-    default:
-      throw std::out_of_range("Vector3 has only 3 elements");
+template <typename T>
+bool Vector3T<T>::operator==(const Vector3T& vector) const {
+  for (int i = 0; i < 3; ++i) {
+    if (std::fabs(data_[i] - vector.data_[i]) >
+        std::numeric_limits<T>::epsilon()) {
+      return false;
+    }
   }
+  return true;
 }
 
-double& Vector3::operator[](const int index) {
-  switch (index) {
-    case 0:
-      return x_;
-    case 1:
-      return y_;
-    case 2:
-      return z_;
-    default:
-      throw std::out_of_range("Vector3 has only 3 elements");
-  }
+template <typename T>
+bool Vector3T<T>::operator!=(const Vector3T& vector) const {
+  return !(*this == vector);
 }
 
-std::ostream& operator<<(std::ostream& os, const Vector3& vector) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Vector3T<T>& vector) {
   os << "(x: " << vector.x() << ", y: " << vector.y() << ", z: " << vector.z()
      << ")";
   return os;
 }
 
-double Vector3::dot(const Vector3& vector) const {
-  return x() * vector.x() + y() * vector.y() + z() * vector.z();
-}
-
-Vector3 Vector3::cross(const Vector3& vector) const {
-  return Vector3{y_ * vector.z() - z_ * vector.y(),
-                 z_ * vector.x() - x_ * vector.z(),
-                 x_ * vector.y() - y_ * vector.x()};
-}
-
-double Vector3::norm() const { return sqrt(dot(*this)); }
-
-double Vector3::x() const { return x_; }
-
-double Vector3::y() const { return y_; }
-
-double Vector3::z() const { return z_; }
-
-double& Vector3::x() { return x_; }
-
-double& Vector3::y() { return y_; }
-
-double& Vector3::z() { return z_; }
+template class Vector3T<double>;
+template class Vector3T<float>;
+template std::ostream& operator<<(std::ostream& os,
+                                  const Vector3T<double>& vector);
+template std::ostream& operator<<(std::ostream& os,
+                                  const Vector3T<float>& vector);
 
 }  // namespace math
 }  // namespace ekumen
@@ -0,0 +1,153 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <isometry/binary.hpp>
+#include <isometry/isometry.hpp>
+#include <isometry/isometry_q.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+// Compares bit patterns, since the encoding must be lossless.
+bool areIdentical(const Isometry& obj1, const Isometry& obj2) {
+  for (int r = 0; r < 3; ++r) {
+    const double a = obj1.translation()[r];
+    const double b = obj2.translation()[r];
+    if (std::memcmp(&a, &b, sizeof(double)) != 0) {
+      return false;
+    }
+    for (int c = 0; c < 3; ++c) {
+      const double m = obj1.rotation()(r, c);
+      const double n = obj2.rotation()(r, c);
+      if (std::memcmp(&m, &n, sizeof(double)) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Isometry makeIsometry(const double value) {
+  return Isometry{Vector3(value, -1. / 3., 1e-300),
+                  Isometry::fromEulerAngles(value, 0.2, -0.7).rotation()};
+}
+
+GTEST_TEST(BinaryTest, BinaryLayoutTests) {
+  static_assert(binary::Codec<Vector3>::kSize == 24, "3 doubles");
+  static_assert(binary::Codec<Matrix3>::kSize == 72, "9 doubles");
+  static_assert(binary::Codec<Isometry>::kSize == 96, "12 doubles");
+  static_assert(binary::Codec<IsometryQ>::kSize == 56, "7 doubles");
+
+  // Little-endian doubles, with no header nor padding.
+  std::uint8_t bytes[24];
+  binary::encode(Vector3(1., -2., 0.), bytes);
+  const std::uint8_t expected[24] = {
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x3f,  // 1
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0,  // -2
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 0
+  };
+  for (int i = 0; i < 24; ++i) {
+    EXPECT_EQ(bytes[i], expected[i]) << "byte " << i;
+  }
+
+  // Matrices are stored in row-major order, after the translation.
+  std::uint8_t isometry_bytes[96];
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Matrix3(4., 5., 6., 7., 8., 9., 10., 11., 12.)};
+  binary::encode(isometry, isometry_bytes);
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(binary::internal::loadDouble(isometry_bytes + 8 * i), i + 1.);
+  }
+}
+
+GTEST_TEST(BinaryTest, BinaryRoundTripTests) {
+  const Isometry isometry = makeIsometry(0.1);
+  std::uint8_t bytes[96];
+  binary::encode(isometry.translation(), bytes);
+  EXPECT_EQ(binary::decode<Vector3>(bytes), isometry.translation());
+  binary::encode(isometry.rotation(), bytes);
+  EXPECT_EQ(binary::decode<Matrix3>(bytes), isometry.rotation());
+  binary::encode(isometry, bytes);
+  EXPECT_TRUE(areIdentical(binary::decode<Isometry>(bytes), isometry));
+
+  // The compact form stores the rotation as a quaternion.
+  const IsometryQ compact{isometry};
+  binary::encode(compact, bytes);
+  const IsometryQ decoded = binary::decode<IsometryQ>(bytes);
+  EXPECT_EQ(decoded.translation(), compact.translation());
+  EXPECT_EQ(decoded.rotation().w(), compact.rotation().w());
+  EXPECT_EQ(decoded.rotation().z(), compact.rotation().z());
+  EXPECT_TRUE(decoded.toIsometry() == isometry);
+
+  // Bulk encoding stores the values back to back.
+  std::vector<Isometry> isometries;
+  for (int i = 0; i < 10; ++i) {
+    isometries.push_back(makeIsometry(0.3 * i));
+  }
+  std::vector<std::uint8_t> buffer(isometries.size() * 96);
+  binary::encode(isometries.data(), isometries.size(), buffer.data());
+  std::vector<Isometry> round_trip(isometries.size());
+  binary::decode(buffer.data(), round_trip.size(), round_trip.data());
+  for (std::size_t i = 0; i < isometries.size(); ++i) {
+    EXPECT_TRUE(areIdentical(round_trip[i], isometries[i])) << i;
+    EXPECT_TRUE(areIdentical(binary::decode<Isometry>(buffer.data() + 96 * i),
+                             isometries[i]));
+  }
+}
+
+GTEST_TEST(BinaryTest, BinaryViewTests) {
+  std::vector<Isometry> isometries;
+  for (int i = 0; i < 5; ++i) {
+    isometries.push_back(makeIsometry(0.5 * i));
+  }
+  // An odd offset checks that views do not require aligned buffers.
+  std::vector<std::uint8_t> buffer(1 + 5 * 96);
+  binary::encode(isometries.data(), isometries.size(), buffer.data() + 1);
+
+  const binary::ArrayView<Isometry> view{buffer.data() + 1, 5 * 96};
+  ASSERT_EQ(view.size(), 5u);
+  EXPECT_FALSE(view.empty());
+  for (std::size_t i = 0; i < view.size(); ++i) {
+    EXPECT_EQ(view[i].translation().x(), isometries[i].translation().x());
+    EXPECT_EQ(view[i].translation()[1], isometries[i].translation().y());
+    EXPECT_EQ(view[i].rotation()(2, 1), isometries[i].rotation()(2, 1));
+    EXPECT_EQ(view[i].rotation().value(), isometries[i].rotation());
+    EXPECT_TRUE(areIdentical(view.at(i).value(), isometries[i]));
+  }
+  EXPECT_THROW(view.at(5), std::out_of_range);
+  EXPECT_THROW(binary::ArrayView<Isometry>(buffer.data(), 100),
+               std::invalid_argument);
+
+  std::vector<std::uint8_t> compact(2 * 56);
+  const IsometryQ first{isometries[1]};
+  const IsometryQ second{isometries[2]};
+  binary::encode(first, compact.data());
+  binary::encode(second, compact.data() + 56);
+  const binary::ArrayView<IsometryQ> compact_view{compact.data(),
+                                                  compact.size()};
+  ASSERT_EQ(compact_view.size(), 2u);
+  EXPECT_EQ(compact_view[1].translation().value(), second.translation());
+  EXPECT_TRUE(compact_view[1].rotation() == second.rotation());
+  EXPECT_TRUE(compact_view[0].value() == first);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,94 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <type_traits>
+
+#include <isometry/expression.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/vector3.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+using expr::lazy;
+
+GTEST_TEST(ExpressionTest, ExpressionVectorTests) {
+  const Vector3 p{1., 2., 3.};
+  const Vector3 q{4., 5., 6.};
+  const Vector3 r{-1., 0.5, 2.};
+
+  // Wrapping one operand makes the whole expression lazy.
+  static_assert(!std::is_same<decltype(lazy(p) + q), Vector3>::value,
+                "the sum is an expression");
+  static_assert(std::is_same<decltype(p + q), Vector3>::value,
+                "plain operators are unchanged");
+
+  EXPECT_EQ(Vector3(lazy(p) + q), p + q);
+  EXPECT_EQ(Vector3(p - lazy(q)), p - q);
+  EXPECT_EQ(Vector3(lazy(p) * q), p * q);
+  EXPECT_EQ(Vector3(lazy(p) / q), p / q);
+  EXPECT_EQ(Vector3(lazy(p) * 2.), p * 2.);
+  EXPECT_EQ(Vector3(2 * lazy(p)), 2. * p);
+  EXPECT_EQ(Vector3(lazy(p) / 4.), p / 4.);
+  const Vector3 chained = (lazy(p) + q) * 3. - r / lazy(q) + p;
+  EXPECT_EQ(chained, (p + q) * 3. - r / q + p);
+  EXPECT_EQ(Vector3(expr::cross(lazy(p) + q, r)), (p + q).cross(r));
+  EXPECT_DOUBLE_EQ(expr::dot(lazy(p) - q, r), (p - q).dot(r));
+
+  // Compound assignment evaluates the whole expression before updating.
+  Vector3 s{p};
+  s += lazy(s) * 2.;
+  EXPECT_EQ(s, p * 3.);
+  s = lazy(s) - s;
+  EXPECT_EQ(s, Vector3::kZero);
+}
+
+GTEST_TEST(ExpressionTest, ExpressionMatrixTests) {
+  const Matrix3 m1{1., 2., 3., 4., 5., 6., 7., 8., 9.};
+  const Matrix3 m2{9., -8., 7., -6., 5., -4., 3., -2., 1.};
+  const Vector3 v{1., -2., 3.};
+  const Vector3 t{0.5, 0.25, -1.};
+
+  EXPECT_EQ(Matrix3(lazy(m1) + m2), m1 + m2);
+  EXPECT_EQ(Matrix3(m1 - lazy(m2)), m1 - m2);
+  EXPECT_EQ(Matrix3(lazy(m1) * m2), m1 * m2);
+  EXPECT_EQ(Matrix3(lazy(m1) / m2), m1 / m2);
+  EXPECT_EQ(Matrix3(lazy(m1) * 2.), m1 * 2.);
+  EXPECT_EQ(Matrix3(2. * lazy(m1)), 2. * m1);
+  EXPECT_EQ(Matrix3(lazy(m1) / 2.), m1 / 2.);
+  EXPECT_EQ(Matrix3(expr::transpose(m1)), m1.transpose());
+  EXPECT_EQ(Matrix3(expr::product(m1, lazy(m2) + m1)),
+            m1.product(m2 + m1));
+
+  // Matrix times vector keeps its matrix product meaning.
+  EXPECT_EQ(Vector3(lazy(m1) * v + t), m1 * v + t);
+  EXPECT_EQ(Vector3(m1 * lazy(v)), m1 * v);
+  EXPECT_EQ(Vector3(expr::transpose(m1) * (lazy(v) - t)),
+            m1.transposeProduct(v - t));
+  EXPECT_EQ(Vector3(expr::product(lazy(m1) + m2, v)), (m1 + m2) * v);
+}
+
+GTEST_TEST(ExpressionTest, ExpressionConstexprTests) {
+  static constexpr Matrix3 m(0., -1., 0., 1., 0., 0., 0., 0., 1.);
+  static constexpr Vector3 v(1., 2., 3.);
+  static constexpr Vector3 t(10., 20., 30.);
+  constexpr Vector3 p = lazy(m) * v + t;
+  static_assert(p.x() == 8. && p.y() == 21. && p.z() == 33.,
+                "expressions evaluate at compile time");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,212 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <isometry/frame_graph.hpp>
+#include <isometry/isometry.hpp>
+#include "gtest/gtest.h"
+
+namespace {
+
+// Number of calls to the global operator new, to check that lookups do not
+// allocate.
+std::size_t allocation_count{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  void* ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+testing::AssertionResult areAlmostEqual(const Isometry& obj1,
+                                        const Isometry& obj2,
+                                        const double tolerance) {
+  for (int r = 0; r < 3; ++r) {
+    if (std::abs(obj1.translation()[r] - obj2.translation()[r]) > tolerance) {
+      return testing::AssertionFailure()
+             << "Values are not equal: " << obj1 << " and " << obj2;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(obj1.rotation()(r, c) - obj2.rotation()(r, c)) >
+          tolerance) {
+        return testing::AssertionFailure()
+               << "Values are not equal: " << obj1 << " and " << obj2;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+Isometry makeIsometry(const double x, const double y, const double z,
+                      const double roll, const double pitch,
+                      const double yaw) {
+  return Isometry{Vector3{x, y, z},
+                  Isometry::fromEulerAngles(roll, pitch, yaw).rotation()};
+}
+
+GTEST_TEST(FrameGraphTest, FrameGraphLookupTests) {
+  const double kTolerance{1e-12};
+  // map
+  //  `- odom
+  //      `- base
+  //          |- camera
+  //          `- arm
+  //              `- gripper
+  const Isometry map_odom = makeIsometry(10., -3., 0., 0., 0., 0.5);
+  const Isometry odom_base = makeIsometry(1., 2., 0., 0., 0., -0.2);
+  const Isometry base_camera = makeIsometry(0.2, 0., 1.1, -1.2, 0., -1.5);
+  const Isometry base_arm = makeIsometry(-0.1, 0.3, 0.5, 0., 0.4, 0.);
+  const Isometry arm_gripper = makeIsometry(0., 0., 0.6, 0.1, 0.2, 0.3);
+
+  FrameGraph graph;
+  const FrameGraph::FrameId map = graph.addFrame("map");
+  graph.addFrame("odom", map, map_odom);
+  graph.addFrame("base", "odom", odom_base);
+  const FrameGraph::FrameId camera =
+      graph.addFrame("camera", "base", base_camera);
+  graph.addFrame("arm", "base", base_arm);
+  graph.addFrame("gripper", "arm", arm_gripper);
+  EXPECT_EQ(graph.size(), 6u);
+  EXPECT_EQ(graph.id("camera"), camera);
+  EXPECT_EQ(graph.name(camera), "camera");
+  EXPECT_EQ(graph.parent(camera), graph.id("base"));
+  EXPECT_EQ(graph.parent(map), FrameGraph::kNoParent);
+  EXPECT_TRUE(graph.contains("gripper"));
+  EXPECT_FALSE(graph.contains("lidar"));
+
+  const Isometry map_camera = map_odom * odom_base * base_camera;
+  EXPECT_TRUE(
+      areAlmostEqual(graph.lookup("camera", "map"), map_camera, kTolerance));
+  EXPECT_TRUE(areAlmostEqual(graph.lookup(map, camera), map_camera.inverse(),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("camera", "camera"),
+                             Isometry::fromTranslation(Vector3::kZero),
+                             kTolerance));
+
+  // Sibling branches meet at their common ancestor.
+  const Isometry camera_gripper =
+      base_camera.inverse() * base_arm * arm_gripper;
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("gripper", "camera"),
+                             camera_gripper, kTolerance));
+  const Vector3 p{0.1, -0.2, 0.3};
+  const Vector3 p_in_camera = graph.lookup("gripper", "camera") * p;
+  const Vector3 expected = base_camera.inverseTransform(
+      base_arm * (arm_gripper * p));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(p_in_camera[i], expected[i], kTolerance);
+  }
+
+  // Updated edges are picked up by later lookups.
+  const Isometry new_odom_base = makeIsometry(5., 5., 0., 0., 0., 1.);
+  graph.setTransform("base", new_odom_base);
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("camera", "map"),
+                             map_odom * new_odom_base * base_camera,
+                             kTolerance));
+}
+
+GTEST_TEST(FrameGraphTest, FrameGraphAllocationTests) {
+  FrameGraph graph;
+  FrameGraph::FrameId left = graph.addFrame("root");
+  FrameGraph::FrameId right = left;
+  for (int i = 0; i < 20; ++i) {
+    left = graph.addFrame("left_" + std::to_string(i), left,
+                          makeIsometry(i, 0., 0., 0.1, 0., 0.));
+    right = graph.addFrame("right_" + std::to_string(i), right,
+                           makeIsometry(0., i, 0., 0., 0.1, 0.));
+  }
+
+  // Names longer than the small string buffer of std::string.
+  graph.addFrame("camera_depth_optical_frame", left,
+                 makeIsometry(1., 2., 3., 0.1, 0.2, 0.3));
+  graph.addFrame("gripper_palm_center_link", right,
+                 makeIsometry(3., 2., 1., 0.3, 0.2, 0.1));
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(graph.name(graph.id("left_" + std::to_string(i))),
+              "left_" + std::to_string(i));
+  }
+  const std::string camera{"camera_depth_optical_frame"};
+
+  const std::size_t allocations_before = allocation_count;
+  Isometry result = graph.lookup(left, right);
+  for (int i = 0; i < 100; ++i) {
+    result = graph.lookup(left, right);
+  }
+  const Isometry by_name =
+      graph.lookup("camera_depth_optical_frame", "gripper_palm_center_link");
+  const Isometry by_string =
+      graph.lookup(camera, graph.name(graph.id("gripper_palm_center_link")));
+  const bool contains = graph.contains("gripper_palm_center_link");
+  EXPECT_EQ(allocation_count, allocations_before);
+  EXPECT_EQ(by_name, by_string);
+  EXPECT_TRUE(contains);
+  EXPECT_TRUE(areAlmostEqual(result * graph.lookup(right, left),
+                             Isometry::fromTranslation(Vector3::kZero), 1e-9));
+  EXPECT_TRUE(areAlmostEqual(
+      by_name,
+      graph.lookup(std::string("camera_depth_optical_frame"),
+                   std::string("gripper_palm_center_link")),
+      1e-12));
+}
+
+GTEST_TEST(FrameGraphTest, FrameGraphErrorTests) {
+  FrameGraph graph;
+  const FrameGraph::FrameId world = graph.addFrame("world");
+  graph.addFrame("robot", world, Isometry::fromTranslation(Vector3::kUnitX));
+  graph.addFrame("other_world");
+
+  EXPECT_THROW(graph.addFrame("robot"), std::invalid_argument);
+  EXPECT_THROW(graph.addFrame("arm", "unknown",
+                              Isometry::fromTranslation(Vector3::kUnitX)),
+               std::out_of_range);
+  EXPECT_THROW(graph.addFrame("arm", 42,
+                              Isometry::fromTranslation(Vector3::kUnitX)),
+               std::out_of_range);
+  EXPECT_THROW(graph.setTransform("world",
+                                  Isometry::fromTranslation(Vector3::kUnitX)),
+               std::invalid_argument);
+  EXPECT_THROW(graph.lookup("robot", "unknown"), std::out_of_range);
+  EXPECT_THROW(graph.lookup("robot", "other_world"), std::runtime_error);
+  EXPECT_THROW(graph.id("unknown"), std::out_of_range);
+
+  // A literal 0 is the first frame rather than a name.
+  EXPECT_EQ(world, 0u);
+  EXPECT_THROW(
+      graph.setTransform(0, Isometry::fromTranslation(Vector3::kUnitX)),
+      std::invalid_argument);
+  EXPECT_EQ(graph.lookup(0, 0), Isometry::fromTranslation(Vector3::kZero));
+  // Names in arrays end at their first null character.
+  const char buffer[16] = "robot";
+  EXPECT_EQ(graph.lookup(buffer, "world"),
+            Isometry::fromTranslation(Vector3::kUnitX));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
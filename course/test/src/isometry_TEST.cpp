@@ -10,10 +10,14 @@
  */
 
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <isometry/isometry.hpp>
+#include <isometry/point_cloud.hpp>
 #include "gtest/gtest.h"
 
 namespace ekumen {
@@ -111,6 +115,333 @@ GTEST_TEST(IsometryTest, IsometryFullTests) {
   EXPECT_EQ(t9 * Vector3(1., 1., 1.), Vector3(3., 5., 7.));
 }
 
+GTEST_TEST(IsometryTest, IsometryRigidInverseTests) {
+  const double kTolerance{1e-12};
+  const Isometry t1{
+      Vector3{1., -2., 3.},
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation()};
+  const Isometry t1_inv = t1.inverse();
+
+  EXPECT_TRUE(areAlmostEqual(t1_inv.rotation(), t1.rotation().inverse(),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(
+      t1_inv, Isometry(-1. * t1.rotation().inverse().product(t1.translation()),
+                       t1.rotation().inverse()),
+      kTolerance));
+
+  const Vector3 p{4., 5., -6.};
+  const Vector3 q = t1.transform(p);
+  const Vector3 p_from_inverse = t1_inv.transform(q);
+  const Vector3 p_from_inverse_transform = t1.inverseTransform(q);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(p_from_inverse[i], p[i], kTolerance);
+    EXPECT_NEAR(p_from_inverse_transform[i], p[i], kTolerance);
+  }
+}
+
+GTEST_TEST(IsometryTest, IsometryBatchTransformTests) {
+  const double kTolerance{1e-12};
+  const Isometry t1{
+      Vector3{1., -2., 3.},
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation()};
+
+  std::vector<Vector3> points;
+  for (int i = 0; i < 37; ++i) {
+    points.emplace_back(i, -2. * i, 0.5 * i);
+  }
+
+  std::vector<Vector3> output(points.size());
+  t1.transform(points.data(), points.size(), output.data());
+  std::vector<Vector3> in_place{points};
+  t1.transform(in_place.data(), in_place.size());
+  std::vector<double> xyz;
+  for (const Vector3& point : points) {
+    xyz.insert(xyz.end(), {point.x(), point.y(), point.z()});
+  }
+  std::vector<double> xyz_output(xyz.size());
+  t1.transform(xyz.data(), points.size(), xyz_output.data());
+  t1.transform(xyz.data(), points.size());
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const Vector3 expected = t1.transform(points[i]);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(output[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(in_place[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(xyz_output[3 * i + j], expected[j], kTolerance);
+      EXPECT_NEAR(xyz[3 * i + j], expected[j], kTolerance);
+    }
+  }
+
+  // Empty ranges are a no-op.
+  t1.transform(static_cast<Vector3*>(nullptr), 0);
+}
+
+GTEST_TEST(IsometryTest, IsometryClosedFormBuilderTests) {
+  const double kTolerance{1e-15};
+  const Vector3 axis{1., -2., 3.};
+  EXPECT_TRUE(areAlmostEqual(Isometry::fromUnitAxisAngle(axis / axis.norm(),
+                                                         0.7),
+                             Isometry::rotateAround(axis, 0.7), kTolerance));
+  for (const double angle : {0., 0.3, -1.2, M_PI / 2., 3., -7.5, 1e3}) {
+    EXPECT_TRUE(areAlmostEqual(
+        Isometry::fromEulerAngles(angle, 0.5 * angle, -angle),
+        Isometry::rotateAround(Vector3::kUnitX, angle) *
+            Isometry::rotateAround(Vector3::kUnitY, 0.5 * angle) *
+            Isometry::rotateAround(Vector3::kUnitZ, -angle),
+        kTolerance));
+  }
+}
+
+GTEST_TEST(IsometryTest, IsometryBatchBuilderTests) {
+  const double kTolerance{4e-16};
+  // More angles than one block of the kernel, with multiples of pi / 2, an
+  // angle too large for its reduction and non finite ones.
+  std::vector<double> roll;
+  std::vector<double> pitch;
+  std::vector<double> yaw;
+  std::vector<Vector3> axes;
+  for (int i = 0; i < 1000; ++i) {
+    roll.push_back(0.01 * i - 5.);
+    pitch.push_back(std::sin(i) * 40.);
+    yaw.push_back(M_PI / 2. * (i - 500));
+    const Vector3 axis{std::cos(i), std::sin(i), 0.5};
+    axes.push_back(axis / axis.norm());
+  }
+  roll[7] = 123456.789;
+  pitch[8] = -1e300;
+  yaw[300] = 99999.;
+  std::vector<Isometry> output(roll.size());
+  Isometry::fromEulerAngles(roll.data(), pitch.data(), yaw.data(), roll.size(),
+                            output.data());
+  for (std::size_t i = 0; i < roll.size(); ++i) {
+    EXPECT_TRUE(areAlmostEqual(
+        output[i], Isometry::fromEulerAngles(roll[i], pitch[i], yaw[i]),
+        kTolerance))
+        << i;
+  }
+  Isometry::fromUnitAxisAngle(axes.data(), pitch.data(), axes.size(),
+                              output.data());
+  for (std::size_t i = 0; i < axes.size(); ++i) {
+    EXPECT_TRUE(areAlmostEqual(
+        output[i], Isometry::fromUnitAxisAngle(axes[i], pitch[i]),
+        kTolerance))
+        << i;
+  }
+
+  const std::vector<double> special{
+      std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::quiet_NaN(), 0.};
+  Isometry::fromEulerAngles(special.data(), special.data() + 2,
+                            special.data() + 2, 2, output.data());
+  EXPECT_TRUE(std::isnan(output[0].rotation()[1][1]));
+  EXPECT_TRUE(std::isnan(output[1].rotation()[1][1]));
+
+  const std::vector<float> angles{0.1f, -2.f, 30.f, 1e6f};
+  std::vector<Isometryf> float_output(angles.size());
+  Isometryf::fromEulerAngles(angles.data(), angles.data(), angles.data(),
+                             angles.size(), float_output.data());
+  for (std::size_t i = 0; i < angles.size(); ++i) {
+    const Isometryf expected =
+        Isometryf::fromEulerAngles(angles[i], angles[i], angles[i]);
+    for (int r = 0; r < 3; ++r) {
+      for (int col = 0; col < 3; ++col) {
+        EXPECT_NEAR(float_output[i].rotation()[r][col],
+                    expected.rotation()[r][col], 1e-6f);
+      }
+    }
+  }
+}
+
+GTEST_TEST(IsometryTest, IsometryExpLogTests) {
+  const double kTolerance{1e-14};
+  // Without rotation the exponential is a translation, and with a twist
+  // along its axis a rotation followed by that translation.
+  EXPECT_TRUE(areAlmostEqual(
+      Isometry::exp(Twist{Vector3(1., 2., 3.), Vector3()}),
+      Isometry::fromTranslation(Vector3(1., 2., 3.)), 0.));
+  const Vector3 axis = Vector3(1., -2., 0.5) / Vector3(1., -2., 0.5).norm();
+  EXPECT_TRUE(areAlmostEqual(
+      Isometry::exp(Twist{axis * 3., axis * 0.7}),
+      Isometry::fromTranslation(axis * 3.) * Isometry::rotateAround(axis, 0.7),
+      kTolerance));
+  // A quarter turn around z with a linear velocity along x moves on a circle
+  // of radius 2 / pi.
+  const Isometry quarter =
+      Isometry::exp(Twist{Vector3(1., 0., 0.), Vector3(0., 0., M_PI / 2.)});
+  EXPECT_NEAR(quarter.translation().x(), 2. / M_PI, kTolerance);
+  EXPECT_NEAR(quarter.translation().y(), 2. / M_PI, kTolerance);
+
+  const Vector3 linear(0.3, -4., 2.);
+  for (const double theta : {0., 1e-9, 5e-3, 0.0099, 0.0101, 0.3, 2.5,
+                             M_PI - 1e-9}) {
+    const Twist twist{linear, axis * theta};
+    const Isometry isometry = Isometry::exp(twist);
+    // The steps of a screw motion add up.
+    const Twist half{linear * 0.5, axis * (0.5 * theta)};
+    EXPECT_TRUE(areAlmostEqual(isometry,
+                               Isometry::exp(half) * Isometry::exp(half),
+                               kTolerance))
+        << theta;
+    const Twist recovered = isometry.log();
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_NEAR(recovered.angular[i], twist.angular[i], kTolerance)
+          << theta;
+      EXPECT_NEAR(recovered.linear[i], twist.linear[i], kTolerance)
+          << theta;
+    }
+  }
+
+  const Isometryf single = Isometryf::exp(
+      Twistf{Vector3f(1.f, 2.f, 3.f), Vector3f(0.f, 1e-3f, 0.f)});
+  const Twistf single_log = single.log();
+  EXPECT_NEAR(single_log.angular.y(), 1e-3f, 1e-9f);
+  EXPECT_NEAR(single_log.linear.z(), 3.f, 1e-6f);
+}
+
+GTEST_TEST(IsometryTest, IsometryBatchExpLogTests) {
+  // Angles below pi, where log() inverts exp().
+  std::vector<Twist> twists;
+  for (int i = 0; i < 600; ++i) {
+    twists.push_back(
+        Twist{Vector3(i, -0.5 * i, 1.),
+              Vector3(std::sin(i), std::cos(3. * i), 0.5) *
+                  (i % 7 == 0 ? 1e-3 : 0.005 * (i % 400))});
+  }
+  std::vector<Isometry> isometries(twists.size());
+  Isometry::exp(twists.data(), twists.size(), isometries.data());
+  std::vector<Twist> logs(twists.size());
+  Isometry::log(isometries.data(), isometries.size(), logs.data());
+  for (std::size_t i = 0; i < twists.size(); ++i) {
+    EXPECT_TRUE(areAlmostEqual(isometries[i], Isometry::exp(twists[i]),
+                               1e-12))
+        << i;
+    const Twist expected = isometries[i].log();
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(logs[i].linear[j], twists[i].linear[j], 1e-12) << i;
+      EXPECT_NEAR(logs[i].linear[j], expected.linear[j], 1e-12) << i;
+      EXPECT_EQ(logs[i].angular[j], expected.angular[j]) << i;
+    }
+  }
+}
+
+GTEST_TEST(IsometryTest, IsometryTrivialCopyTests) {
+  const Isometry poses[2] = {
+      Isometry{Vector3(1., 2., 3.),
+               Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()},
+      Isometry::fromTranslation(Vector3(-1., 0., 0.5))};
+  // Copies through raw bytes are well-defined and exact.
+  Isometry copies[2];
+  std::memcpy(copies, poses, sizeof(poses));
+  EXPECT_TRUE(areAlmostEqual(copies[0], poses[0], 0.));
+  EXPECT_TRUE(areAlmostEqual(copies[1], poses[1], 0.));
+
+  Isometry& self = copies[0];
+  copies[0] = self;
+  EXPECT_TRUE(areAlmostEqual(copies[0], poses[0], 0.));
+  std::vector<Isometry> grown;
+  for (int i = 0; i < 100; ++i) {
+    grown.push_back(poses[i % 2]);
+  }
+  EXPECT_TRUE(areAlmostEqual(grown[98], poses[0], 0.));
+  EXPECT_TRUE(areAlmostEqual(grown[99], poses[1], 0.));
+}
+
+GTEST_TEST(IsometryTest, IsometryNoexceptTests) {
+  Isometry t1;
+  Vector3 points[2];
+  static_assert(noexcept(t1 * t1) && noexcept(t1 * Vector3()) &&
+                    noexcept(t1.inverse()) && noexcept(t1.transform(points, 2)),
+                "Transforms must not throw");
+  static_assert(noexcept(Isometry::exp(Twist{})) && noexcept(t1.log()),
+                "Exponential and logarithm maps must not throw");
+  static_assert(noexcept(Isometry::fromEulerAngles(0., 0., 0.)) &&
+                    noexcept(Isometry::rotateAround(Vector3(), 0.)),
+                "Builders must not throw");
+  t1 = Isometry::exp(Twist{Vector3(1., 2., 3.), Vector3(0.1, 0.2, 0.3)});
+  EXPECT_TRUE(areAlmostEqual(t1 * t1.inverse(),
+                             Isometry::fromTranslation(Vector3()), 1e-12));
+}
+
+GTEST_TEST(IsometryTest, IsometryConstexprTests) {
+  // A calibration chain evaluated at compile time. Quarter turns and integer
+  // translations keep every value exact.
+  constexpr Isometry kBaseToLidar{
+      Vector3(1., 2., 3.), Matrix3(0., -1., 0., 1., 0., 0., 0., 0., 1.)};
+  constexpr Isometry kLidarToCamera{
+      Vector3(4., 5., 6.), Matrix3(1., 0., 0., 0., 0., -1., 0., 1., 0.)};
+  constexpr Isometry kBaseToCamera = kBaseToLidar * kLidarToCamera;
+  constexpr Isometry kCameraToBase = kBaseToCamera.inverse();
+  constexpr Vector3 kPoint = kBaseToCamera * Vector3(1., 1., 1.);
+  static_assert(kBaseToCamera.translation().x() == -4. &&
+                    kBaseToCamera.translation().y() == 6. &&
+                    kBaseToCamera.translation().z() == 9.,
+                "Composition must be constexpr");
+  static_assert(kCameraToBase.transform(kPoint).z() == 1. &&
+                    kBaseToCamera.inverseTransform(kPoint).x() == 1.,
+                "Inversion must be constexpr");
+  static_assert(Isometry::fromTranslation(Vector3::kUnitY)
+                        .compose(kBaseToLidar)
+                        .translation()
+                        .y() == 3.,
+                "Translations must be constexpr");
+  static_assert(Isometryf(kBaseToLidar).rotation()(0, 1) == -1.f,
+                "Conversions must be constexpr");
+
+  const Isometry base_to_lidar = kBaseToLidar;
+  EXPECT_TRUE(
+      areAlmostEqual(base_to_lidar * kLidarToCamera, kBaseToCamera, 0.));
+  EXPECT_TRUE(areAlmostEqual(kBaseToCamera * kCameraToBase,
+                             Isometry::fromTranslation(Vector3::kZero), 0.));
+}
+
+GTEST_TEST(IsometryTest, IsometryFloatTests) {
+  const float kTolerance{1e-5f};
+  const Isometryf t1{Vector3f(1.f, -2.f, 3.f),
+                     Isometryf::rotateAround(Vector3f(1.f, 2.f, 3.f), 0.7f)
+                         .rotation()};
+  const Isometry t1_double{t1};
+  const Vector3f p(4.f, 5.f, -6.f);
+  const Vector3f q = t1 * p;
+  const Vector3 q_double = t1_double * Vector3(p);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(q[i], q_double[i], kTolerance);
+  }
+  const Vector3f p_back = t1.inverseTransform(q);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(p_back[i], p[i], kTolerance);
+  }
+}
+
+GTEST_TEST(IsometryTest, IsometryMixedPrecisionTests) {
+  const float kTolerance{1e-5f};
+  const Isometry t1{
+      Vector3{1., -2., 3.},
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation()};
+
+  std::vector<Vector3f> points;
+  for (int i = 0; i < 37; ++i) {
+    points.emplace_back(i, -2.f * i, 0.5f * i);
+  }
+  std::vector<Vector3f> output(points.size());
+  t1.transform(points.data(), points.size(), output.data());
+  std::vector<Vector3f> in_place{points};
+  t1.transform(in_place.data(), in_place.size());
+  PointCloudf cloud{points};
+  PointCloudf cloud_output;
+  t1.transform(cloud, &cloud_output);
+  t1.transform(&cloud);
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const Vector3 expected = t1.transform(Vector3(points[i]));
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(output[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(in_place[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(cloud_output[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(cloud[i][j], expected[j], kTolerance);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace math
@@ -0,0 +1,126 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/isometry_q.hpp>
+#include <isometry/point_cloud.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+testing::AssertionResult areAlmostEqual(const Isometry& obj1,
+                                        const Isometry& obj2,
+                                        const double tolerance) {
+  for (int r = 0; r < 3; ++r) {
+    if (std::abs(obj1.translation()[r] - obj2.translation()[r]) > tolerance) {
+      return testing::AssertionFailure()
+             << "Values are not equal: " << obj1 << " and " << obj2;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(obj1.rotation()(r, c) - obj2.rotation()(r, c)) >
+          tolerance) {
+        return testing::AssertionFailure()
+               << "Values are not equal: " << obj1 << " and " << obj2;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(IsometryQTest, IsometryQFullTests) {
+  const double kTolerance{1e-12};
+  const Isometry t1{Vector3{1., -2., 3.},
+                    Isometry::fromEulerAngles(0.4, -0.2, 1.1).rotation()};
+  const Isometry t2{Vector3{-4., 0.5, 2.},
+                    Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7)
+                        .rotation()};
+  const IsometryQ q1{t1};
+  const IsometryQ q2{t2};
+  EXPECT_TRUE(areAlmostEqual(q1.toIsometry(), t1, kTolerance));
+
+  EXPECT_TRUE(IsometryQ() == IsometryQ::fromTranslation(Vector3::kZero));
+  EXPECT_TRUE(areAlmostEqual(IsometryQ::fromEulerAngles(0.4, -0.2, 1.1)
+                                 .toIsometry(),
+                             Isometry::fromEulerAngles(0.4, -0.2, 1.1),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(
+      IsometryQ::rotateAround(Vector3{1., 2., 3.}, 0.7).toIsometry(),
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7), kTolerance));
+
+  const Vector3 p{4., 5., -6.};
+  const Vector3 q = q1 * p;
+  const Vector3 expected = t1 * p;
+  const Vector3 back = q1.inverseTransform(q);
+  const Vector3 back_from_inverse = q1.inverse().transform(q);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(q[i], expected[i], kTolerance);
+    EXPECT_NEAR(back[i], p[i], kTolerance);
+    EXPECT_NEAR(back_from_inverse[i], p[i], kTolerance);
+  }
+
+  EXPECT_TRUE(areAlmostEqual((q1 * q2).toIsometry(), t1 * t2, kTolerance));
+  EXPECT_TRUE(areAlmostEqual(q1.compose(q2).toIsometry(), t1 * t2,
+                             kTolerance));
+  IsometryQ q3{q1};
+  q3 *= q2;
+  EXPECT_TRUE(areAlmostEqual(q3.toIsometry(), t1 * t2, kTolerance));
+  EXPECT_TRUE(areAlmostEqual((q1 * q1.inverse()).toIsometry(),
+                             Isometry::fromTranslation(Vector3::kZero),
+                             kTolerance));
+}
+
+GTEST_TEST(IsometryQTest, IsometryQChainTests) {
+  // A long chain of compositions stays a rigid transformation once the
+  // rotation is renormalized.
+  const IsometryQ step =
+      IsometryQ{Vector3{0.1, 0., 0.}, Quaternion::kIdentity} *
+      IsometryQ::rotateAround(Vector3{1., 2., 3.}, 0.01);
+  IsometryQ chain;
+  for (int i = 0; i < 100000; ++i) {
+    chain *= step;
+  }
+  EXPECT_NEAR(chain.rotation().norm(), 1., 1e-9);
+  chain.rotation().normalize();
+  EXPECT_NEAR(chain.rotation().norm(), 1., 1e-15);
+}
+
+GTEST_TEST(IsometryQTest, IsometryQBatchTransformTests) {
+  const double kTolerance{1e-12};
+  const IsometryQ q1{Isometry{
+      Vector3{1., -2., 3.},
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation()}};
+  std::vector<Vector3> points;
+  for (int i = 0; i < 37; ++i) {
+    points.emplace_back(i, -2. * i, 0.5 * i);
+  }
+  std::vector<Vector3> output(points.size());
+  q1.transform(points.data(), points.size(), output.data());
+  PointCloud cloud{points};
+  PointCloud cloud_output;
+  q1.transform(cloud, &cloud_output);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const Vector3 expected = q1.transform(points[i]);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(output[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(cloud_output[i][j], expected[j], kTolerance);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
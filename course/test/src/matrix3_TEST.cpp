@@ -12,6 +12,7 @@
 #include <cmath>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <isometry/matrix3.hpp>
 #include "gtest/gtest.h"
@@ -21,6 +22,18 @@ namespace math {
 namespace test {
 namespace {
 
+testing::AssertionResult areAlmostEqual(const Matrix3 &obj1,
+                                        const Matrix3 &obj2,
+                                        const double tolerance) {
+  for (int i = 0; i < 9; ++i) {
+    if (std::abs(obj1.data()[i] - obj2.data()[i]) > tolerance) {
+      return testing::AssertionFailure()
+             << "The matrices are not almost equal " << obj1 << " " << obj2;
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
 GTEST_TEST(Matrix3Test, Matrix3FullTests) {
   const double kTolerance{1e-12};
   Matrix3 m1{1., 2., 3., 4., 5., 6., 7., 8., 9.};
@@ -127,6 +140,157 @@ GTEST_TEST(Matrix3Test, Matrix3FullTests) {
   EXPECT_EQ(m4_moved[2][2], 10);
 }
 
+// Writes through the mutable row views, which constant evaluation only accepts
+// when they stay within the matrix storage.
+constexpr Matrix3 writeRows() {
+  Matrix3 matrix;
+  matrix[0] = Vector3(1., 2., 3.);
+  matrix.rowAt(1).y() = 5.;
+  matrix.row(2).z() = 9.;
+  return matrix;
+}
+
+GTEST_TEST(Matrix3Test, Matrix3ConstexprTests) {
+  constexpr Matrix3 m1(1., 2., 3., 4., 5., 6., 7., 8., 10.);
+  constexpr Matrix3 m2(1., 0., 0., 0., 1., 0., 0., 0., 1.);
+  static_assert(m1.det() == -3., "Determinant must be constexpr");
+  static_assert(m1.product(m2)(2, 2) == 10., "Product must be constexpr");
+  static_assert(m1.product(Vector3(1., 1., 1.)).y() == 15.,
+                "Vector product must be constexpr");
+  static_assert(m1.col(1).z() == 8., "Column access must be constexpr");
+  static_assert((m1 + m2 - m2 * 2.)(0, 0) == 0.,
+                "Arithmetic must be constexpr");
+  static_assert(Matrix3::kIdentity.product(m1)(1, 2) == 6. &&
+                    (Matrix3f::kOnes - Matrix3f::kZero).det() == 0.f,
+                "Constants must be constexpr");
+  static_assert(writeRows()(0, 2) == 3. && writeRows()(1, 1) == 5. &&
+                    writeRows()(2, 2) == 9.,
+                "Mutable row access must be constexpr");
+  EXPECT_EQ(m1.product(m2), m1);
+}
+
+GTEST_TEST(Matrix3Test, Matrix3StorageTests) {
+  const double kTolerance{1e-12};
+  Matrix3 m1{1., 2., 3., 4., 5., 6., 7., 8., 10.};
+
+  const double* data = m1.data();
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(data[i], m1(i / 3, i % 3));
+    EXPECT_EQ(data[i], m1[i / 3][i % 3]);
+  }
+
+  m1(1, 2) = 11.;
+  EXPECT_EQ(m1[1][2], 11.);
+  m1.data()[7] = 12.;
+  EXPECT_EQ(m1(2, 1), 12.);
+  m1[2][0] = 13.;
+  EXPECT_EQ(m1.data()[6], 13.);
+  m1.row(0) = Vector3(1., 2., 3.);
+  EXPECT_EQ(m1, Matrix3(1., 2., 3., 4., 5., 11., 13., 12., 10.));
+  // Assigning a row copies its elements rather than rebinding the view.
+  m1[1] = m1[0];
+  m1[0].x() = 0.;
+  EXPECT_EQ(m1, Matrix3(0., 2., 3., 1., 2., 3., 13., 12., 10.));
+
+  const Matrix3 m2{2., 1., 0., 1., 3., 1., 0., 5., 4.};
+  EXPECT_TRUE(areAlmostEqual(m2.product(m2.inverse()), Matrix3::kIdentity,
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(m2.inverse().product(m2), Matrix3::kIdentity,
+                             kTolerance));
+}
+
+GTEST_TEST(Matrix3Test, Matrix3TransposeTests) {
+  constexpr Matrix3 m1{1., 2., 3., 4., 5., 6., 7., 8., 9.};
+  EXPECT_EQ(m1.transpose(), Matrix3(1., 4., 7., 2., 5., 8., 3., 6., 9.));
+  EXPECT_EQ(m1.transpose().transpose(), m1);
+  EXPECT_EQ(m1.transposeProduct(Vector3(1., 0., 0.)), Vector3(1., 2., 3.));
+  EXPECT_EQ(m1.transposeProduct(Vector3(1., 2., 3.)),
+            m1.transpose().product(Vector3(1., 2., 3.)));
+}
+
+GTEST_TEST(Matrix3Test, Matrix3NoexceptTests) {
+  const double kTolerance{1e-12};
+  Matrix3 m1{2., 1., 0., 1., 3., 1., 0., 5., 4.};
+  Matrix3 inverse;
+  ASSERT_TRUE(m1.tryInverse(&inverse));
+  EXPECT_TRUE(areAlmostEqual(inverse, m1.inverse(), kTolerance));
+  const Matrix3 singular{1., 2., 3., 2., 4., 6., 0., 1., 1.};
+  inverse = Matrix3::kIdentity;
+  EXPECT_FALSE(singular.tryInverse(&inverse));
+  EXPECT_EQ(inverse, Matrix3::kIdentity);
+
+  EXPECT_EQ(Vector3(m1.rowAt(1)), Vector3(m1.row(1)));
+  EXPECT_EQ(m1.colAt(2), m1.col(2));
+  m1.rowAt(2) = Vector3(7., 8., 9.);
+  EXPECT_EQ(m1, Matrix3(2., 1., 0., 1., 3., 1., 7., 8., 9.));
+
+  static_assert(noexcept(m1.rowAt(0)) && noexcept(m1.colAt(0)) &&
+                    noexcept(m1(0, 0)) && noexcept(m1.tryInverse(&inverse)),
+                "Unchecked access must not throw");
+  static_assert(noexcept(m1.product(m1)) && noexcept(m1 * Vector3()) &&
+                    noexcept(2. * m1) && noexcept(Matrix3::exp(Vector3())),
+                "Arithmetic must not throw");
+  static_assert(!noexcept(m1.inverse()) && !noexcept(m1.row(0)),
+                "Checked access reports errors");
+}
+
+GTEST_TEST(Matrix3Test, Matrix3ExpLogTests) {
+  const double kTolerance{1e-15};
+  const double angle{0.7};
+  EXPECT_TRUE(areAlmostEqual(
+      Matrix3::exp(Vector3(0., 0., angle)),
+      Matrix3(std::cos(angle), -std::sin(angle), 0., std::sin(angle),
+              std::cos(angle), 0., 0., 0., 1.),
+      kTolerance));
+  EXPECT_TRUE(
+      areAlmostEqual(Matrix3::exp(Vector3()), Matrix3::kIdentity, 0.));
+  EXPECT_EQ(Matrix3::kIdentity.log(), Vector3());
+
+  // Round trips across the small angle branches, around pi / 2 and close
+  // to pi, where the axis comes from the symmetric part.
+  const Vector3 axis = Vector3(1., -2., 0.5) / Vector3(1., -2., 0.5).norm();
+  for (const double theta :
+       {1e-300, 1e-9, 5e-3, 0.0099, 0.0101, 0.3, M_PI / 2. - 1e-9,
+        M_PI / 2. + 1e-9, 2.5, M_PI - 1e-6, M_PI - 1e-12}) {
+    const Vector3 rotation = axis * theta;
+    const Vector3 recovered = Matrix3::exp(rotation).log();
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_NEAR(recovered[i], rotation[i], 4. * kTolerance * (1. + theta))
+          << theta;
+    }
+  }
+  // Rotations by pi come back with either axis.
+  const Vector3 half_turn = Matrix3(-1., 0., 0., 0., 1., 0., 0., 0., -1.).log();
+  EXPECT_NEAR(std::fabs(half_turn.y()), M_PI, kTolerance);
+  EXPECT_EQ(half_turn.x(), 0.);
+  // Angles past pi wrap around.
+  const Vector3 wrapped = Matrix3::exp(Vector3(0., 0., 1.5 * M_PI)).log();
+  EXPECT_NEAR(wrapped.z(), -0.5 * M_PI, kTolerance);
+
+  const Vector3f small_rotation = Matrix3f::exp(Vector3f(1e-3f, 0.f, 0.f))
+                                      .log();
+  EXPECT_NEAR(small_rotation.x(), 1e-3f, 1e-9f);
+}
+
+GTEST_TEST(Matrix3Test, Matrix3BatchExpLogTests) {
+  std::vector<Vector3> rotations;
+  for (int i = 0; i < 600; ++i) {
+    rotations.push_back(Vector3(std::sin(i), std::cos(3. * i), 0.5) *
+                        (i % 7 == 0 ? 1e-3 : 0.005 * i));
+  }
+  rotations[5] = Vector3();
+  std::vector<Matrix3> matrices(rotations.size());
+  Matrix3::exp(rotations.data(), rotations.size(), matrices.data());
+  std::vector<Vector3> logs(rotations.size());
+  Matrix3::log(matrices.data(), matrices.size(), logs.data());
+  for (std::size_t i = 0; i < rotations.size(); ++i) {
+    EXPECT_TRUE(
+        areAlmostEqual(matrices[i], Matrix3::exp(rotations[i]), 1e-15))
+        << i;
+    EXPECT_EQ(logs[i], matrices[i].log()) << i;
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace math
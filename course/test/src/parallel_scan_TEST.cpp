@@ -0,0 +1,107 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/parallel_scan.hpp>
+#include <isometry/thread_pool.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+testing::AssertionResult areAlmostEqual(const Isometry& obj1,
+                                        const Isometry& obj2,
+                                        const double tolerance) {
+  for (int r = 0; r < 3; ++r) {
+    if (std::abs(obj1.translation()[r] - obj2.translation()[r]) > tolerance) {
+      return testing::AssertionFailure()
+             << "Values are not equal: " << obj1 << " and " << obj2;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(obj1.rotation()(r, c) - obj2.rotation()(r, c)) >
+          tolerance) {
+        return testing::AssertionFailure()
+               << "Values are not equal: " << obj1 << " and " << obj2;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// Odometry-like deltas: a small step forward and a small turn.
+std::vector<Isometry> makeDeltas(const std::size_t count) {
+  std::vector<Isometry> deltas;
+  deltas.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const double turn = 0.01 * std::sin(0.001 * i);
+    deltas.emplace_back(Vector3(0.1, 0.001 * std::cos(0.01 * i), 0.),
+                        Isometry::fromEulerAngles(0., 0.001, turn).rotation());
+  }
+  return deltas;
+}
+
+std::vector<Isometry> serialScan(const std::vector<Isometry>& deltas) {
+  std::vector<Isometry> poses;
+  Isometry pose = Isometry::fromTranslation(Vector3::kZero);
+  for (const Isometry& delta : deltas) {
+    pose *= delta;
+    poses.push_back(pose);
+  }
+  return poses;
+}
+
+GTEST_TEST(ParallelScanTest, ParallelScanMatchesSerialFoldTests) {
+  ThreadPool pool{4};
+  // Sizes below one grain, not multiples of the thread count, and leaving
+  // fewer chunks than threads.
+  for (const std::size_t count : {0, 1, 2, 9, 1000, 100003}) {
+    for (const std::size_t grain : {1, 3, 4096}) {
+      const std::vector<Isometry> deltas = makeDeltas(count);
+      const std::vector<Isometry> expected = serialScan(deltas);
+      std::vector<Isometry> poses(count);
+      parallelInclusiveScan(deltas.data(), count, poses.data(), &pool, grain);
+      for (std::size_t i = 0; i < count; ++i) {
+        // Poses reach about 10 km away, so the tolerance is relative to it.
+        ASSERT_TRUE(areAlmostEqual(poses[i], expected[i], 1e-8))
+            << "count " << count << ", grain " << grain << ", index " << i;
+      }
+    }
+  }
+}
+
+GTEST_TEST(ParallelScanTest, ParallelScanInPlaceTests) {
+  ThreadPool pool{3};
+  std::vector<Isometry> poses = makeDeltas(20000);
+  const std::vector<Isometry> expected = serialScan(poses);
+  parallelInclusiveScan(&poses, &pool, 1000);
+  ASSERT_EQ(poses.size(), expected.size());
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    ASSERT_TRUE(areAlmostEqual(poses[i], expected[i], 1e-9)) << i;
+  }
+
+  std::vector<Isometryf> posesf{Isometryf(Isometry::rotateAround(
+                                    Vector3::kUnitZ, 0.5)),
+                                Isometryf(Isometry::fromTranslation(
+                                    Vector3::kUnitX))};
+  parallelInclusiveScan(&posesf, &pool, 1);
+  EXPECT_EQ(posesf[1], Isometryf(Isometry::rotateAround(Vector3::kUnitZ, 0.5) *
+                                 Isometry::fromTranslation(Vector3::kUnitX)));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/point_cloud.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+bool isAligned(const double* ptr) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % PointCloud::kAlignment == 0;
+}
+
+GTEST_TEST(PointCloudTest, PointCloudFullTests) {
+  PointCloud empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.size(), 0u);
+
+  const std::vector<Vector3> points{Vector3(1., 2., 3.), Vector3(4., 5., 6.),
+                                    Vector3(7., 8., 9.)};
+  PointCloud cloud{points};
+  EXPECT_EQ(cloud.size(), 3u);
+  EXPECT_TRUE(isAligned(cloud.x()));
+  EXPECT_TRUE(isAligned(cloud.y()));
+  EXPECT_TRUE(isAligned(cloud.z()));
+  EXPECT_EQ(cloud.x()[1], 4.);
+  EXPECT_EQ(cloud.y()[1], 5.);
+  EXPECT_EQ(cloud.z()[1], 6.);
+  EXPECT_EQ(cloud[2], Vector3(7., 8., 9.));
+
+  const std::vector<Vector3> round_trip = cloud.toVector();
+  ASSERT_EQ(round_trip.size(), points.size());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(round_trip[i], points[i]);
+  }
+
+  cloud.set(0, Vector3(-1., -2., -3.));
+  EXPECT_EQ(cloud[0], Vector3(-1., -2., -3.));
+  cloud.push_back(Vector3(10., 11., 12.));
+  EXPECT_EQ(cloud.size(), 4u);
+  EXPECT_EQ(cloud[3], Vector3(10., 11., 12.));
+  cloud.resize(6);
+  EXPECT_EQ(cloud[5], Vector3::kZero);
+  cloud.clear();
+  EXPECT_TRUE(cloud.empty());
+
+  const PointCloud zeros(5);
+  EXPECT_EQ(zeros.size(), 5u);
+  EXPECT_EQ(zeros[4], Vector3::kZero);
+}
+
+GTEST_TEST(PointCloudTest, PointCloudTransformTests) {
+  const double kTolerance{1e-12};
+  const Isometry t1{
+      Vector3{1., -2., 3.},
+      Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation()};
+
+  std::vector<Vector3> points;
+  for (int i = 0; i < 37; ++i) {
+    points.emplace_back(i, -2. * i, 0.5 * i);
+  }
+  const PointCloud input{points};
+  PointCloud output;
+  t1.transform(input, &output);
+  PointCloud in_place{points};
+  t1.transform(&in_place);
+
+  ASSERT_EQ(output.size(), points.size());
+  ASSERT_EQ(in_place.size(), points.size());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const Vector3 expected = t1.transform(points[i]);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(output[i][j], expected[j], kTolerance);
+      EXPECT_NEAR(in_place[i][j], expected[j], kTolerance);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
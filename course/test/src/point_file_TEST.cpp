@@ -0,0 +1,262 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/parallel_transform.hpp>
+#include <isometry/point_file.hpp>
+#include <isometry/point_view.hpp>
+#include <isometry/thread_pool.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+std::string tempPath(const std::string& name) {
+  const char* directory = std::getenv("TMPDIR");
+  return std::string(directory != nullptr ? directory : "/tmp") +
+         "/point_file_" + name;
+}
+
+// Writes a file made of a text header and binary records, returning its path.
+std::string writeFile(const std::string& name, const std::string& header,
+                      const std::vector<std::uint8_t>& records) {
+  const std::string path = tempPath(name);
+  std::ofstream file{path, std::ios::binary};
+  file << header;
+  file.write(reinterpret_cast<const char*>(records.data()), records.size());
+  return path;
+}
+
+template <typename T>
+void append(const T value, std::vector<std::uint8_t>* records) {
+  std::uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  records->insert(records->end(), bytes, bytes + sizeof(T));
+}
+
+Vector3f floatPoint(const int i) {
+  return Vector3f(0.5f * i, -1.f * i, 2.f + i);
+}
+
+Vector3 doublePoint(const int i) {
+  return Vector3(0.1 * i, -1. / (i + 1), 1e3 * i);
+}
+
+// A PLY file of 100 float points with an intensity, after a camera element.
+std::string writePly() {
+  std::vector<std::uint8_t> records;
+  append(7.f, &records);
+  for (int i = 0; i < 100; ++i) {
+    const Vector3f point = floatPoint(i);
+    append(point.x(), &records);
+    append(point.y(), &records);
+    append(point.z(), &records);
+    append(static_cast<std::uint8_t>(i), &records);
+  }
+  return writeFile("cloud.ply",
+                   "ply\n"
+                   "format binary_little_endian 1.0\n"
+                   "comment written by the tests\n"
+                   "element camera 1\n"
+                   "property float focal\n"
+                   "element vertex 100\n"
+                   "property float x\n"
+                   "property float y\n"
+                   "property float z\n"
+                   "property uchar intensity\n"
+                   "end_header\n",
+                   records);
+}
+
+// A PCD file of 50 double points, after a color so that they are unaligned.
+std::string writePcd() {
+  std::vector<std::uint8_t> records;
+  for (int i = 0; i < 50; ++i) {
+    const Vector3 point = doublePoint(i);
+    append(static_cast<std::uint32_t>(i), &records);
+    append(point.x(), &records);
+    append(point.y(), &records);
+    append(point.z(), &records);
+  }
+  return writeFile("cloud.pcd",
+                   "# .PCD v0.7 - Point Cloud Data file format\n"
+                   "VERSION 0.7\n"
+                   "FIELDS rgb x y z\n"
+                   "SIZE 4 8 8 8\n"
+                   "TYPE U F F F\n"
+                   "COUNT 1 1 1 1\n"
+                   "WIDTH 50\n"
+                   "HEIGHT 1\n"
+                   "VIEWPOINT 0 0 0 1 0 0 0\n"
+                   "POINTS 50\n"
+                   "DATA binary\n",
+                   records);
+}
+
+GTEST_TEST(PointFileTest, PointFilePlyTests) {
+  const PointFile file{writePly()};
+  EXPECT_EQ(file.format(), PointFile::Format::kPly);
+  EXPECT_EQ(file.size(), 100u);
+  EXPECT_EQ(file.scalarSize(), 4u);
+  EXPECT_EQ(file.stride(), 13u);
+  EXPECT_THROW(file.points<double>(), std::runtime_error);
+
+  const PointViewf view = file.points<float>();
+  ASSERT_EQ(view.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(view[i], floatPoint(i));
+  }
+  EXPECT_EQ(view.subview(10, 5)[2], floatPoint(12));
+  EXPECT_EQ(view.subview(10, 5).size(), 5u);
+}
+
+GTEST_TEST(PointFileTest, PointFilePcdTests) {
+  PointFile file{writePcd(), PointFile::Access::kNormal};
+  EXPECT_EQ(file.format(), PointFile::Format::kPcd);
+  EXPECT_EQ(file.size(), 50u);
+  EXPECT_EQ(file.scalarSize(), 8u);
+  EXPECT_EQ(file.stride(), 28u);
+  file.advise(PointFile::Access::kRandom);
+
+  // Views stay valid when the mapping changes owner.
+  const PointView view = file.points<double>();
+  const PointFile moved{std::move(file)};
+  EXPECT_EQ(file.size(), 0u);
+  EXPECT_EQ(moved.size(), 50u);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(view[i], doublePoint(i));
+  }
+}
+
+GTEST_TEST(PointFileTest, PointFileTransformTests) {
+  const PointFile file{writePly()};
+  const PointViewf view = file.points<float>();
+  const Isometry isometry{Vector3(1., -2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  std::vector<Vector3f> expected;
+  for (std::size_t i = 0; i < view.size(); ++i) {
+    expected.push_back(view[i]);
+  }
+  isometry.transform(expected.data(), expected.size());
+
+  std::vector<Vector3f> serial(view.size());
+  isometry.transform(view, serial.data());
+  EXPECT_EQ(serial, expected);
+
+  ThreadPool pool{3};
+  std::vector<Vector3f> parallel(view.size());
+  parallelTransform(isometry, view, parallel.data(), &pool, 8);
+  EXPECT_EQ(parallel, expected);
+
+  // The double kernel reads unaligned records too.
+  const PointFile pcd{writePcd()};
+  const PointView doubles = pcd.points<double>();
+  std::vector<Vector3> transformed(doubles.size());
+  isometry.transform(doubles, transformed.data());
+  for (std::size_t i = 0; i < doubles.size(); ++i) {
+    EXPECT_EQ(transformed[i], isometry.transform(doubles[i]));
+  }
+}
+
+GTEST_TEST(PointFileTest, PointFileErrorTests) {
+  EXPECT_THROW(PointFile{tempPath("missing.ply")},
+               std::runtime_error);
+  EXPECT_THROW(PointFile{writeFile("empty.ply", "", {})}, std::runtime_error);
+
+  const std::string vertex =
+      "element vertex 2\n"
+      "property float x\nproperty float y\nproperty float z\n";
+  const std::vector<std::uint8_t> records(24);
+  const std::string ascii = writeFile(
+      "ascii.ply", "ply\nformat ascii 1.0\n" + vertex + "end_header\n",
+      records);
+  EXPECT_THROW(PointFile{ascii}, std::runtime_error);
+  const std::string truncated = writeFile(
+      "truncated.ply",
+      "ply\nformat binary_little_endian 1.0\n" + vertex + "end_header\n",
+      std::vector<std::uint8_t>(23));
+  EXPECT_THROW(PointFile{truncated}, std::runtime_error);
+  const std::string unterminated = writeFile(
+      "unterminated.ply", "ply\nformat binary_little_endian 1.0\n" + vertex,
+      {});
+  EXPECT_THROW(PointFile{unterminated}, std::runtime_error);
+  const std::string list = writeFile(
+      "list.ply",
+      "ply\nformat binary_little_endian 1.0\n" + vertex +
+          "property list uchar int indices\nend_header\n",
+      records);
+  EXPECT_THROW(PointFile{list}, std::runtime_error);
+  const std::string scattered =
+      writeFile("scattered.ply",
+                "ply\nformat binary_little_endian 1.0\nelement vertex 1\n"
+                "property float x\nproperty float y\nproperty uchar i\n"
+                "property float z\nend_header\n",
+                records);
+  EXPECT_THROW(PointFile{scattered}, std::runtime_error);
+  // The faces before the vertices would wrap the offset of the records.
+  const std::string skipped_overflow = writeFile(
+      "skipped_overflow.ply",
+      "ply\nformat binary_little_endian 1.0\n"
+      "element face 4611686018427387904\nproperty int i\n" +
+          vertex + "end_header\n",
+      records);
+  EXPECT_THROW(PointFile{skipped_overflow}, std::runtime_error);
+
+  const std::string compressed = writeFile(
+      "compressed.pcd",
+      "FIELDS x y z\nSIZE 4 4 4\nTYPE F F F\nPOINTS 2\n"
+      "DATA binary_compressed\n",
+      records);
+  EXPECT_THROW(PointFile{compressed}, std::runtime_error);
+  const std::string integers = writeFile(
+      "integers.pcd", "FIELDS x y z\nSIZE 4 4 4\nTYPE I I I\nPOINTS 2\n"
+                      "DATA binary\n",
+      records);
+  EXPECT_THROW(PointFile{integers}, std::runtime_error);
+  // A stride that wraps to 0.
+  const std::string stride_overflow = writeFile(
+      "stride_overflow.pcd",
+      "FIELDS x y z i\nSIZE 4 4 4 4\nTYPE F F F F\n"
+      "COUNT 1 1 1 4611686018427387901\nPOINTS 2\nDATA binary\n",
+      records);
+  EXPECT_THROW(PointFile{stride_overflow}, std::runtime_error);
+  const std::string points_overflow = writeFile(
+      "points_overflow.pcd",
+      "FIELDS x y z\nSIZE 4 4 4\nTYPE F F F\nWIDTH 4294967296\n"
+      "HEIGHT 4294967296\nDATA binary\n",
+      records);
+  EXPECT_THROW(PointFile{points_overflow}, std::runtime_error);
+  const std::string empty_z = writeFile(
+      "empty_z.pcd", "FIELDS x y z\nSIZE 4 4 4\nTYPE F F F\nCOUNT 1 1 0\n"
+                     "POINTS 2\nDATA binary\n",
+      records);
+  EXPECT_THROW(PointFile{empty_z}, std::runtime_error);
+  const std::string valid = writeFile(
+      "valid.pcd", "FIELDS x y z\nSIZE 4 4 4\nTYPE F F F\nPOINTS 2\n"
+                   "DATA binary\n",
+      records);
+  EXPECT_EQ(PointFile{valid}.size(), 2u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
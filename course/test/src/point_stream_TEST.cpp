@@ -0,0 +1,234 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/point_stream.hpp>
+#include <isometry/point_view.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+std::string tempPath(const std::string& name) {
+  const char* directory = std::getenv("TMPDIR");
+  return std::string(directory != nullptr ? directory : "/tmp") +
+         "/point_stream_" + name;
+}
+
+// Writes a file, returning its path.
+std::string writeFile(const std::string& name,
+                      const std::vector<std::uint8_t>& bytes) {
+  const std::string path = tempPath(name);
+  std::ofstream file{path, std::ios::binary};
+  file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  return path;
+}
+
+std::vector<std::uint8_t> readFile(const std::string& path) {
+  std::ifstream file{path, std::ios::binary};
+  return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file),
+                                   std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+void append(const T value, std::vector<std::uint8_t>* records) {
+  std::uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  records->insert(records->end(), bytes, bytes + sizeof(T));
+}
+
+Isometry makeIsometry() {
+  return Isometry{Vector3(1., -2., 3.),
+                  Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+}
+
+GTEST_TEST(PointStreamTest, PointStreamPackedTests) {
+  // An odd number of points, so that the last buffer is partly filled.
+  const std::size_t kCount{10007};
+  std::vector<float> xyz;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    xyz.push_back(0.5f * i);
+    xyz.push_back(-1.f * i);
+    xyz.push_back(2.f + i);
+  }
+  const Isometry isometry = makeIsometry();
+  std::vector<float> expected(xyz.size());
+  isometry.transform(xyz.data(), kCount, expected.data());
+
+  // A header before the records, which the caller skips and copies.
+  const std::string header{"header\n"};
+  std::vector<std::uint8_t> bytes(header.begin(), header.end());
+  for (const float value : xyz) {
+    append(value, &bytes);
+  }
+  const std::string input_path = writeFile("packed.bin", bytes);
+  const std::string output_path = tempPath("packed.out");
+  for (const std::size_t buffers : {2, 3, 5}) {
+    SCOPED_TRACE(buffers);
+    const int input = ::open(input_path.c_str(), O_RDONLY);
+    const int output =
+        ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(input, 0);
+    ASSERT_GE(output, 0);
+    ASSERT_EQ(::lseek(input, header.size(), SEEK_SET),
+              static_cast<off_t>(header.size()));
+    ASSERT_EQ(::write(output, header.data(), header.size()),
+              static_cast<ssize_t>(header.size()));
+    StreamOptions options;
+    // 83 records per buffer.
+    options.buffer_size = 1000;
+    options.buffers = buffers;
+    EXPECT_EQ(streamTransform<float>(isometry, input, output, 12, 0, options),
+              kCount);
+    ::close(input);
+    ::close(output);
+
+    const std::vector<std::uint8_t> written = readFile(output_path);
+    ASSERT_EQ(written.size(), bytes.size());
+    EXPECT_EQ(std::string(written.begin(), written.begin() + header.size()),
+              header);
+    EXPECT_EQ(std::memcmp(written.data() + header.size(), expected.data(),
+                          expected.size() * sizeof(float)),
+              0);
+  }
+}
+
+GTEST_TEST(PointStreamTest, PointStreamStridedTests) {
+  // Double points between a tag and an intensity, streamed through pipes,
+  // which return short reads.
+  const std::size_t kCount{5000};
+  const std::size_t kStride{4 + 3 * sizeof(double) + 1};
+  std::vector<std::uint8_t> records;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    append(static_cast<std::uint32_t>(i), &records);
+    append(0.1 * i, &records);
+    append(-1. / (i + 1), &records);
+    append(1e3 * i, &records);
+    append(static_cast<std::uint8_t>(i), &records);
+  }
+  const Isometry isometry = makeIsometry();
+  std::vector<Vector3> expected(kCount);
+  isometry.transform(PointView(records.data() + 4, kCount, kStride),
+                     expected.data());
+
+  int input[2];
+  int output[2];
+  ASSERT_EQ(::pipe(input), 0);
+  ASSERT_EQ(::pipe(output), 0);
+  std::thread producer{[&] {
+    const std::size_t kChunk{777};
+    for (std::size_t begin = 0; begin < records.size(); begin += kChunk) {
+      const std::size_t size = std::min(kChunk, records.size() - begin);
+      EXPECT_EQ(::write(input[1], records.data() + begin, size),
+                static_cast<ssize_t>(size));
+    }
+    ::close(input[1]);
+  }};
+  std::vector<std::uint8_t> written;
+  std::thread consumer{[&] {
+    std::uint8_t chunk[4096];
+    ssize_t size;
+    while ((size = ::read(output[0], chunk, sizeof(chunk))) > 0) {
+      written.insert(written.end(), chunk, chunk + size);
+    }
+  }};
+  StreamOptions options;
+  options.buffer_size = 4096;
+  EXPECT_EQ(
+      streamTransform<double>(isometry, input[0], output[1], kStride, 4,
+                              options),
+      kCount);
+  ::close(output[1]);
+  producer.join();
+  consumer.join();
+  ::close(input[0]);
+  ::close(output[0]);
+
+  ASSERT_EQ(written.size(), records.size());
+  const PointView view(written.data() + 4, kCount, kStride);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    const Vector3 point = view[i];
+    EXPECT_EQ(std::memcmp(&point, &expected[i], sizeof(point)), 0) << i;
+    // The other fields are copied unchanged.
+    EXPECT_EQ(std::memcmp(&written[i * kStride], &records[i * kStride], 4), 0);
+    EXPECT_EQ(written[(i + 1) * kStride - 1], records[(i + 1) * kStride - 1]);
+  }
+}
+
+GTEST_TEST(PointStreamTest, PointStreamErrorTests) {
+  const Isometry isometry = makeIsometry();
+  const std::string output_path = tempPath("errors.out");
+  const int output =
+      ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(output, 0);
+  const std::string empty_path = writeFile("empty.bin", {});
+  const int empty = ::open(empty_path.c_str(), O_RDONLY);
+  ASSERT_GE(empty, 0);
+  EXPECT_EQ(streamTransform<float>(isometry, empty, output, 12), 0u);
+
+  EXPECT_THROW(streamTransform<float>(isometry, empty, output, 11),
+               std::invalid_argument);
+  EXPECT_THROW(streamTransform<float>(isometry, empty, output, 16, 8),
+               std::invalid_argument);
+  StreamOptions options;
+  options.buffers = 1;
+  EXPECT_THROW(streamTransform<float>(isometry, empty, output, 12, 0, options),
+               std::invalid_argument);
+  options.buffers = 2;
+  options.buffer_size = 8;
+  EXPECT_THROW(streamTransform<float>(isometry, empty, output, 12, 0, options),
+               std::invalid_argument);
+  ::close(empty);
+
+  // The whole records before the truncated one are written.
+  const std::string truncated_path =
+      writeFile("truncated.bin", std::vector<std::uint8_t>(30));
+  const int truncated = ::open(truncated_path.c_str(), O_RDONLY);
+  ASSERT_GE(truncated, 0);
+  EXPECT_THROW(streamTransform<float>(isometry, truncated, output, 12),
+               std::runtime_error);
+  ::close(truncated);
+  ::close(output);
+  EXPECT_EQ(readFile(output_path).size(), 24u);
+
+  EXPECT_THROW(streamTransform<float>(isometry, -1, STDOUT_FILENO, 12),
+               std::runtime_error);
+  const std::string input_path =
+      writeFile("input.bin", std::vector<std::uint8_t>(120));
+  const int input = ::open(input_path.c_str(), O_RDONLY);
+  const int read_only = ::open(input_path.c_str(), O_RDONLY);
+  ASSERT_GE(input, 0);
+  ASSERT_GE(read_only, 0);
+  EXPECT_THROW(streamTransform<float>(isometry, input, read_only, 12),
+               std::runtime_error);
+  ::close(input);
+  ::close(read_only);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
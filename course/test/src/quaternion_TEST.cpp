@@ -0,0 +1,158 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+#include <isometry/isometry.hpp>
+#include <isometry/quaternion.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+testing::AssertionResult areAlmostEqual(const Matrix3& obj1,
+                                        const Matrix3& obj2,
+                                        const double tolerance) {
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(obj1(r, c) - obj2(r, c)) > tolerance) {
+        return testing::AssertionFailure()
+               << "Values are not equal: " << obj1 << " and " << obj2;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(QuaternionTest, QuaternionFullTests) {
+  const double kTolerance{1e-12};
+  const Quaternion identity;
+  EXPECT_TRUE(identity == Quaternion::kIdentity);
+  EXPECT_TRUE(Quaternion(-1., 0., 0., 0.) == Quaternion::kIdentity);
+  EXPECT_TRUE(Quaternion(0., 1., 0., 0.) != Quaternion::kIdentity);
+  EXPECT_TRUE(areAlmostEqual(identity.toRotationMatrix(), Matrix3::kIdentity,
+                             kTolerance));
+
+  const Quaternion q = Quaternion::fromAxisAngle(Vector3{1., 2., 3.}, 0.7);
+  EXPECT_NEAR(q.norm(), 1., kTolerance);
+  const Matrix3 r = Isometry::rotateAround(Vector3{1., 2., 3.}, 0.7).rotation();
+  EXPECT_TRUE(areAlmostEqual(q.toRotationMatrix(), r, kTolerance));
+
+  const Vector3 p{4., 5., -6.};
+  const Vector3 rotated = q * p;
+  const Vector3 expected = r * p;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(rotated[i], expected[i], kTolerance);
+  }
+
+  // Composition matches the matrix product.
+  const Quaternion q2 = Quaternion::fromAxisAngle(Vector3::kUnitZ, -1.3);
+  EXPECT_TRUE(areAlmostEqual((q * q2).toRotationMatrix(),
+                             r.product(q2.toRotationMatrix()), kTolerance));
+  Quaternion q3{q};
+  q3 *= q2;
+  EXPECT_TRUE(areAlmostEqual(q3.toRotationMatrix(), (q * q2).toRotationMatrix(),
+                             kTolerance));
+
+  // The inverse undoes the rotation.
+  const Vector3 back = q.inverse() * rotated;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(back[i], p[i], kTolerance);
+  }
+
+  Quaternion scaled{2., 0., 0., 2.};
+  EXPECT_NEAR(scaled.normalized().norm(), 1., kTolerance);
+  scaled.normalize();
+  EXPECT_NEAR(scaled.w(), std::sqrt(0.5), kTolerance);
+  EXPECT_NEAR(scaled.z(), std::sqrt(0.5), kTolerance);
+
+  std::stringstream ss;
+  ss << Quaternion(1., 2., 3., 4.);
+  EXPECT_EQ(ss.str(), "(w: 1, x: 2, y: 3, z: 4)");
+}
+
+GTEST_TEST(QuaternionTest, QuaternionFromRotationMatrixTests) {
+  const double kTolerance{1e-12};
+  // Covers every branch of the conversion: small angles, where the trace is
+  // positive, and angles close to pi around each axis.
+  const Vector3 axes[] = {Vector3{1., 2., 3.}, Vector3::kUnitX,
+                          Vector3::kUnitY, Vector3::kUnitZ};
+  const double angles[] = {0., 0.3, -2., 3.1, M_PI};
+  for (const Vector3& axis : axes) {
+    for (const double angle : angles) {
+      const Matrix3 r = Isometry::rotateAround(axis, angle).rotation();
+      const Quaternion q = Quaternion::fromRotationMatrix(r);
+      EXPECT_NEAR(q.norm(), 1., kTolerance);
+      EXPECT_TRUE(areAlmostEqual(q.toRotationMatrix(), r, kTolerance));
+      EXPECT_TRUE(q == Quaternion::fromAxisAngle(axis, angle));
+    }
+  }
+}
+
+GTEST_TEST(QuaternionTest, QuaternionSlerpTests) {
+  const double kTolerance{1e-12};
+  const Vector3 axis{1., 2., 3.};
+  const Quaternion from = Quaternion::fromAxisAngle(axis, 0.2);
+  const Quaternion to = Quaternion::fromAxisAngle(axis, 1.4);
+  EXPECT_TRUE(from.slerp(to, 0.) == from);
+  EXPECT_TRUE(from.slerp(to, 1.) == to);
+  // Constant angular velocity: a quarter of the way is a quarter of the angle.
+  const Quaternion quarter = from.slerp(to, 0.25);
+  EXPECT_NEAR(quarter.norm(), 1., kTolerance);
+  EXPECT_TRUE(areAlmostEqual(quarter.toRotationMatrix(),
+                             Quaternion::fromAxisAngle(axis, 0.5)
+                                 .toRotationMatrix(),
+                             kTolerance));
+  // The sign of the target does not change the path.
+  const Quaternion negated(-to.w(), -to.x(), -to.y(), -to.z());
+  EXPECT_TRUE(areAlmostEqual(from.slerp(negated, 0.25).toRotationMatrix(),
+                             quarter.toRotationMatrix(), kTolerance));
+  // The shorter arc is taken: from 0.2 to -0.2 + 2 pi goes through 0.
+  const Quaternion wrapped = Quaternion::fromAxisAngle(axis, 2. * M_PI - 0.2);
+  EXPECT_TRUE(areAlmostEqual(from.slerp(wrapped, 0.5).toRotationMatrix(),
+                             Matrix3::kIdentity, kTolerance));
+  // Nearly equal rotations are still interpolated to a unit quaternion.
+  const Quaternion close = Quaternion::fromAxisAngle(axis, 0.2 + 1e-9);
+  EXPECT_NEAR(from.slerp(close, 0.5).norm(), 1., kTolerance);
+  EXPECT_TRUE(areAlmostEqual(from.slerp(close, 0.5).toRotationMatrix(),
+                             from.toRotationMatrix(), 1e-9));
+}
+
+GTEST_TEST(QuaternionTest, QuaternionConstexprTests) {
+  constexpr Quaternion q{0., 0., 0., 1.};
+  constexpr Vector3 rotated = q * Vector3(1., 0., 0.);
+  static_assert(rotated.x() == -1. && rotated.y() == 0. && rotated.z() == 0.,
+                "a half turn around z negates x");
+  static_assert((q * q).w() == -1., "two half turns are a full turn");
+  static_assert(q.toRotationMatrix()(2, 2) == 1., "z is the rotation axis");
+  static_assert(q.conjugate().z() == -1., "conjugate negates the vector part");
+}
+
+GTEST_TEST(QuaternionTest, QuaternionFloatTests) {
+  const float kTolerance{1e-5f};
+  const Quaternionf q =
+      Quaternionf::fromAxisAngle(Vector3f(1.f, 2.f, 3.f), 0.7f);
+  const Quaternion q_double{q};
+  EXPECT_NEAR(q.norm(), 1.f, kTolerance);
+  const Vector3f rotated = q * Vector3f(4.f, 5.f, -6.f);
+  const Vector3 expected = q_double * Vector3(4., 5., -6.);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(rotated[i], expected[i], kTolerance);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/matrix3.hpp>
+#include <isometry/seqlock.hpp>
+#include <isometry/vector3.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+// An isometry whose 12 scalars are all derived from `stamp`, so that a value
+// mixing two stores is detected.
+Isometry makeStamped(const double stamp) {
+  return Isometry{Vector3(stamp, stamp + 1., stamp + 2.),
+                  Matrix3(stamp + 3., stamp + 4., stamp + 5., stamp + 6.,
+                          stamp + 7., stamp + 8., stamp + 9., stamp + 10.,
+                          stamp + 11.)};
+}
+
+bool isStamped(const Isometry& isometry) {
+  const double stamp = isometry.translation().x();
+  for (int r = 0; r < 3; ++r) {
+    if (isometry.translation()[r] != stamp + r) {
+      return false;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (isometry.rotation()(r, c) != stamp + 3. + 3. * r + c) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+GTEST_TEST(SeqLockTest, SeqLockFullTests) {
+  SeqLock<Vector3> vector{Vector3(1., 2., 3.)};
+  EXPECT_EQ(vector.load(), Vector3(1., 2., 3.));
+  EXPECT_EQ(vector.version(), 0u);
+  vector.store(Vector3(-4., 5., 0.5));
+  EXPECT_EQ(vector.load(), Vector3(-4., 5., 0.5));
+  EXPECT_EQ(vector.version(), 1u);
+
+  const Isometry pose = Isometry::fromEulerAngles(0.1, -0.2, 0.3) *
+                        Isometry::fromTranslation(Vector3(1., 2., 3.));
+  SeqLock<Isometry> isometry{pose};
+  EXPECT_EQ(isometry.load(), pose);
+  isometry.store(pose.inverse());
+  EXPECT_EQ(isometry.load(), pose.inverse());
+
+  SeqLock<Isometryf> isometry_float{Isometryf(pose)};
+  EXPECT_EQ(isometry_float.load(), Isometryf(pose));
+}
+
+GTEST_TEST(SeqLockTest, SeqLockConcurrencyTests) {
+  const int kStores{200000};
+  const int kReaders{4};
+  SeqLock<Isometry> published{makeStamped(0.)};
+  std::atomic<bool> done{false};
+  std::atomic<int> torn_reads{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaders; ++i) {
+    readers.emplace_back([&] {
+      double last_stamp{0.};
+      while (!done.load()) {
+        const Isometry value = published.load();
+        // Values must be whole and never go back in time.
+        if (!isStamped(value) || value.translation().x() < last_stamp) {
+          ++torn_reads;
+        }
+        last_stamp = value.translation().x();
+      }
+    });
+  }
+  for (int i = 1; i <= kStores; ++i) {
+    published.store(makeStamped(i));
+  }
+  done = true;
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(torn_reads.load(), 0);
+  EXPECT_TRUE(isStamped(published.load()));
+  EXPECT_EQ(published.load().translation().x(), kStores);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
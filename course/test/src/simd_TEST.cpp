@@ -0,0 +1,157 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <isometry/aligned_allocator.hpp>
+#include <isometry/isometry.hpp>
+#include <isometry/point_cloud.hpp>
+#include <isometry/simd.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+const SimdLevel kLevels[] = {SimdLevel::kScalar, SimdLevel::kSse2,
+                             SimdLevel::kAvx2, SimdLevel::kAvx512};
+
+// Runs every kernel of `level` on an odd number of points, so that the
+// vector loops have a tail, and checks that the results are bit-identical to
+// the ones of the scalar kernels.
+template <typename T>
+void expectSameAsScalar(const SimdLevel level) {
+  using Planar =
+      std::vector<T, AlignedAllocator<T, PointCloudT<T>::kAlignment>>;
+  const std::size_t kCount{1037};
+  const IsometryT<T> isometry(
+      IsometryT<double>::fromEulerAngles(0.3, -0.2, 1.1));
+  const Matrix3T<T>& rotation = isometry.rotation();
+  const Vector3T<T> translation(T{1.5}, T{-2}, T{0.25});
+  std::vector<T> xyz(3 * kCount);
+  Planar x(kCount);
+  Planar y(kCount);
+  Planar z(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    x[i] = xyz[3 * i] = static_cast<T>(std::sin(0.1 * i) * 10.);
+    y[i] = xyz[3 * i + 1] = static_cast<T>(0.001 * i);
+    z[i] = xyz[3 * i + 2] = static_cast<T>(std::cos(0.3 * i) - 5.);
+  }
+  const internal::SimdKernels<T>& scalar =
+      internal::simdKernels<T>(SimdLevel::kScalar);
+  const internal::SimdKernels<T>& kernels = internal::simdKernels<T>(level);
+
+  std::vector<T> expected(3 * kCount);
+  std::vector<T> actual(3 * kCount);
+  scalar.transform(rotation, translation, xyz.data(), kCount,
+                   expected.data());
+  kernels.transform(rotation, translation, xyz.data(), kCount, actual.data());
+  EXPECT_EQ(actual, expected);
+
+  // Records of 3 coordinates and a 1 byte field, so that most are unaligned.
+  const std::size_t stride = 3 * sizeof(T) + 1;
+  std::vector<std::uint8_t> records(kCount * stride);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    std::memcpy(&records[i * stride], &xyz[3 * i], 3 * sizeof(T));
+  }
+  kernels.transform_strided(rotation, translation, records.data(), stride,
+                            kCount, actual.data());
+  EXPECT_EQ(actual, expected);
+
+  Planar out_x(kCount);
+  Planar out_y(kCount);
+  Planar out_z(kCount);
+  kernels.transform_planar(rotation, translation, x.data(), y.data(),
+                           z.data(), kCount, out_x.data(), out_y.data(),
+                           out_z.data());
+  // In place too.
+  kernels.transform_planar(rotation, translation, x.data(), y.data(),
+                           z.data(), kCount, x.data(), y.data(), z.data());
+  for (std::size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(out_x[i], expected[3 * i]);
+    EXPECT_EQ(out_y[i], expected[3 * i + 1]);
+    EXPECT_EQ(out_z[i], expected[3 * i + 2]);
+    EXPECT_EQ(x[i], expected[3 * i]);
+    EXPECT_EQ(y[i], expected[3 * i + 1]);
+    EXPECT_EQ(z[i], expected[3 * i + 2]);
+  }
+}
+
+GTEST_TEST(SimdTest, SimdLevelNameTests) {
+  for (const SimdLevel level : kLevels) {
+    SimdLevel parsed{SimdLevel::kScalar};
+    EXPECT_TRUE(parseSimdLevel(toString(level), &parsed));
+    EXPECT_EQ(parsed, level);
+  }
+  SimdLevel level{SimdLevel::kAvx2};
+  EXPECT_FALSE(parseSimdLevel("AVX2", &level));
+  EXPECT_FALSE(parseSimdLevel("", &level));
+  EXPECT_EQ(level, SimdLevel::kAvx2);
+  EXPECT_STREQ(toString(SimdLevel::kAvx512), "avx512");
+}
+
+GTEST_TEST(SimdTest, SimdLevelSelectionTests) {
+  EXPECT_LE(activeSimdLevel(), supportedSimdLevel());
+  EXPECT_EQ(&internal::simdKernels<double>(),
+            &internal::simdKernels<double>(activeSimdLevel()));
+  // Unsupported levels fall back to the widest supported one.
+  EXPECT_EQ(&internal::simdKernels<float>(SimdLevel::kAvx512),
+            &internal::simdKernels<float>(supportedSimdLevel()));
+
+  // The tests also run with ISOMETRY_SIMD set, see CMakeLists.txt.
+  const char* name = std::getenv("ISOMETRY_SIMD");
+  SimdLevel requested;
+  if (name != nullptr && parseSimdLevel(name, &requested) &&
+      requested <= supportedSimdLevel()) {
+    EXPECT_EQ(activeSimdLevel(), requested);
+  } else {
+    EXPECT_EQ(activeSimdLevel(), supportedSimdLevel());
+  }
+}
+
+GTEST_TEST(SimdTest, SimdKernelsTests) {
+  for (const SimdLevel level : kLevels) {
+    if (level > supportedSimdLevel()) {
+      continue;
+    }
+    SCOPED_TRACE(toString(level));
+    expectSameAsScalar<double>(level);
+    expectSameAsScalar<float>(level);
+  }
+}
+
+GTEST_TEST(SimdTest, SimdTransformTests) {
+  // The batch transforms run the kernels of the active level.
+  const Isometry isometry{Vector3(1., 2., 3.),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  std::vector<Vector3> points;
+  for (int i = 0; i < 101; ++i) {
+    points.push_back(Vector3(0.5 * i, -1. * i, 2. + i));
+  }
+  std::vector<Vector3> transformed(points.size());
+  isometry.transform(points.data(), points.size(), transformed.data());
+  const PointCloud cloud{points};
+  PointCloud transformed_cloud;
+  isometry.transform(cloud, &transformed_cloud);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(transformed[i], isometry * points[i]);
+    EXPECT_EQ(transformed_cloud[i], transformed[i]);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
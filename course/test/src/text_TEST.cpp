@@ -0,0 +1,233 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <isometry/isometry.hpp>
+#include <isometry/text.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+std::string format(const double value) {
+  char buffer[text::kMaxDoubleLength];
+  char* end = text::format(value, buffer, buffer + sizeof(buffer));
+  return end == nullptr ? "<overflow>" : std::string(buffer, end);
+}
+
+bool isSameDouble(const double a, const double b) {
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+GTEST_TEST(TextTest, TextFormatDoubleTests) {
+  EXPECT_EQ(format(0.), "0");
+  EXPECT_EQ(format(-0.), "-0");
+  EXPECT_EQ(format(1.), "1");
+  EXPECT_EQ(format(-2.5), "-2.5");
+  EXPECT_EQ(format(0.1), "0.1");
+  EXPECT_EQ(format(0.3), "0.3");
+  EXPECT_EQ(format(0.1 + 0.2), "0.30000000000000004");
+  EXPECT_EQ(format(1. / 3.), "0.3333333333333333");
+  EXPECT_EQ(format(123456789.), "123456789");
+  EXPECT_EQ(format(1e16), "10000000000000000");
+  EXPECT_EQ(format(1e17), "1e17");
+  EXPECT_EQ(format(0.00001), "0.00001");
+  EXPECT_EQ(format(0.000001), "1e-6");
+  EXPECT_EQ(format(-1.5e-300), "-1.5e-300");
+  EXPECT_EQ(format(std::numeric_limits<double>::max()),
+            "1.7976931348623157e308");
+  EXPECT_EQ(format(std::numeric_limits<double>::denorm_min()), "5e-324");
+  EXPECT_EQ(format(std::numeric_limits<double>::infinity()), "inf");
+  EXPECT_EQ(format(-std::numeric_limits<double>::infinity()), "-inf");
+  EXPECT_EQ(format(std::numeric_limits<double>::quiet_NaN()), "nan");
+  EXPECT_EQ(format(std::cos(M_PI / 8.)), "0.9238795325112867");
+
+  // Buffers that are too small are reported, and not overrun.
+  char small[4] = {'a', 'b', 'c', 'd'};
+  EXPECT_EQ(text::format(0.125, small, small + 4), nullptr);
+  EXPECT_EQ(text::format(0.25, small, small + 4), small + 4);
+  EXPECT_EQ(std::string(small, 4), "0.25");
+}
+
+GTEST_TEST(TextTest, TextDoubleRoundTripTests) {
+  // Random bit patterns cover every exponent, and random short decimals the
+  // values that are typed by hand.
+  std::mt19937_64 generator{42};
+  for (int i = 0; i < 200000; ++i) {
+    double value;
+    if (i % 2 == 0) {
+      const std::uint64_t bits = generator();
+      std::memcpy(&value, &bits, sizeof(value));
+      if (std::isnan(value)) {
+        continue;
+      }
+    } else {
+      value = static_cast<double>(generator() % 2000001) / 1000. - 1000.;
+    }
+    const std::string text = format(value);
+    ASSERT_LE(text.size(), text::kMaxDoubleLength);
+    double parsed;
+    const char* end = text::parse(text.data(), text.data() + text.size(),
+                                  &parsed);
+    ASSERT_EQ(end, text.data() + text.size()) << text;
+    ASSERT_TRUE(isSameDouble(parsed, value)) << text;
+    // Shortest: one digit less does not round trip, checked with strtod.
+    ASSERT_TRUE(isSameDouble(std::strtod(text.c_str(), nullptr), value));
+  }
+}
+
+GTEST_TEST(TextTest, TextParseDoubleTests) {
+  // Texts not written by format() are rounded like strtod does.
+  const char* texts[] = {"3.14159",
+                         "  -42",
+                         "+7.",
+                         ".5",
+                         "1E3",
+                         "2.5e-3",
+                         "9007199254740993",
+                         "0.9238795325112867",
+                         "123456789012345678901234567890",
+                         "0.000000000000000000000000000001234",
+                         "1.7976931348623157e308",
+                         "4.9406564584124654e-324",
+                         "1e400",
+                         "1e-400",
+                         // Halfway points between doubles followed by more
+                         // digits than the mantissa holds.
+                         "9223372036854776832.0000000000001",
+                         "922337203685477683200001e-5",
+                         "9007199254740993.00000000000000000000001",
+                         "9007199254740992.99999999999999999999999",
+                         "0.5000000000000000277555756156289135105907917"};
+  for (const char* text : texts) {
+    const char* last = text + std::strlen(text);
+    double value;
+    EXPECT_EQ(text::parse(text, last, &value), last) << text;
+    EXPECT_TRUE(isSameDouble(value, std::strtod(text, nullptr))) << text;
+  }
+  // Past the digits that strtod is given, only whether one is not zero
+  // matters.
+  for (const char* tail : {"", "1"}) {
+    const std::string text =
+        "9007199254740993." + std::string(1000, '0') + tail;
+    double value;
+    EXPECT_EQ(text::parse(text.data(), text.data() + text.size(), &value),
+              text.data() + text.size());
+    EXPECT_TRUE(isSameDouble(value, std::strtod(text.c_str(), nullptr)))
+        << tail;
+  }
+
+  double value{-1.};
+  const std::string infinity{"-inf"};
+  text::parse(infinity.data(), infinity.data() + infinity.size(), &value);
+  EXPECT_EQ(value, -std::numeric_limits<double>::infinity());
+
+  // The number ends where its characters do.
+  const std::string trailing{"12.5e, 3"};
+  EXPECT_EQ(text::parse(trailing.data(), trailing.data() + trailing.size(),
+                        &value),
+            trailing.data() + 4);
+  EXPECT_EQ(value, 12.5);
+
+  for (const std::string bad : {"", " ", "-", ".", "e5", "x1", "in"}) {
+    value = -1.;
+    EXPECT_EQ(text::parse(bad.data(), bad.data() + bad.size(), &value),
+              nullptr)
+        << bad;
+    EXPECT_EQ(value, -1.);
+  }
+}
+
+GTEST_TEST(TextTest, TextIsometryTests) {
+  const Isometry isometry{Vector3(0.1, -2., 1e-7),
+                          Isometry::fromEulerAngles(0.1, 0.2, 0.3).rotation()};
+  char buffer[text::kMaxIsometryLength];
+  char* end = text::format(isometry, buffer, buffer + sizeof(buffer));
+  ASSERT_NE(end, nullptr);
+  const std::string formatted{buffer, end};
+  EXPECT_EQ(formatted.substr(0, 32), "[T: (x: 0.1, y: -2, z: 1e-7), R:");
+
+  Isometry parsed;
+  EXPECT_EQ(text::parse(buffer, end, &parsed), end);
+  for (int r = 0; r < 3; ++r) {
+    EXPECT_TRUE(isSameDouble(parsed.translation()[r],
+                             isometry.translation()[r]));
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_TRUE(isSameDouble(parsed.rotation()(r, c),
+                               isometry.rotation()(r, c)));
+    }
+  }
+  EXPECT_EQ(text::format(isometry, buffer, buffer + 100), nullptr);
+
+  // The same layout as operator<<, with any whitespace between tokens.
+  const std::string written =
+      "[T: (x: 0, y: 0, z: 0), R:[[0.923879533, -0.382683432, 0], "
+      "[0.382683432, 0.923879533, 0], [0, 0, 1]]]";
+  const std::string spaced =
+      " [ T : ( x : 1 ,y:2,z:3),R:\n[[1,0,0],[0,1,0],[0,0,1]]]";
+  EXPECT_EQ(text::parse(written.data(), written.data() + written.size(),
+                        &parsed),
+            written.data() + written.size());
+  EXPECT_EQ(parsed.rotation()(0, 1), -0.382683432);
+  EXPECT_NE(text::parse(spaced.data(), spaced.data() + spaced.size(),
+                        &parsed),
+            nullptr);
+  EXPECT_EQ(parsed.translation(), Vector3(1., 2., 3.));
+
+  // Malformed input leaves the output untouched.
+  const std::string truncated = written.substr(0, written.size() - 1);
+  EXPECT_EQ(text::parse(truncated.data(), truncated.data() + truncated.size(),
+                        &parsed),
+            nullptr);
+  EXPECT_EQ(parsed.translation(), Vector3(1., 2., 3.));
+
+  Vector3 vector;
+  const std::string vector_text = "(x: 1, y: 2, w: 3)";
+  EXPECT_EQ(text::parse(vector_text.data(),
+                        vector_text.data() + vector_text.size(), &vector),
+            nullptr);
+}
+
+GTEST_TEST(TextTest, TextStreamTests) {
+  const Isometry isometry{Vector3(1. / 3., 2., -3.),
+                          Isometry::fromEulerAngles(0.5, 0.1, 0.).rotation()};
+  char buffer[text::kMaxIsometryLength];
+  char* end = text::format(isometry, buffer, buffer + sizeof(buffer));
+  std::istringstream is{std::string(buffer, end) + " (x: 1, y: 2, z: 3) [[1"};
+  Isometry parsed;
+  Vector3 vector;
+  Matrix3 matrix;
+  EXPECT_TRUE(is >> parsed >> vector);
+  EXPECT_TRUE(isSameDouble(parsed.translation().x(), 1. / 3.));
+  EXPECT_EQ(vector, Vector3(1., 2., 3.));
+  EXPECT_FALSE(is >> matrix);
+
+  // operator<< keeps the caller's precision.
+  std::ostringstream os;
+  os.precision(3);
+  os << isometry << ' ' << 1. / 3.;
+  EXPECT_EQ(os.precision(), 3);
+  EXPECT_EQ(os.str().substr(os.str().size() - 6), " 0.333");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
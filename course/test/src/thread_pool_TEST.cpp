@@ -0,0 +1,127 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <isometry/isometry.hpp>
+#include <isometry/parallel_transform.hpp>
+#include <isometry/point_cloud.hpp>
+#include <isometry/thread_pool.hpp>
+#include <isometry/vector3.hpp>
+#include "gtest/gtest.h"
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+GTEST_TEST(ThreadPoolTest, ThreadPoolParallelForTests) {
+  ThreadPool pool{4};
+  EXPECT_EQ(pool.size(), 4u);
+  EXPECT_GE(ThreadPool().size(), 1u);
+
+  // Every index is visited exactly once, whatever the count and grain, and
+  // the pool is reused across loops.
+  for (const std::size_t count : {0, 1, 7, 100, 1000, 4097}) {
+    for (const std::size_t grain : {0, 1, 3, 64, 5000}) {
+      std::vector<int> visits(count, 0);
+      pool.parallelFor(count, grain,
+                       [&visits](const std::size_t begin,
+                                 const std::size_t end) {
+                         for (std::size_t i = begin; i < end; ++i) {
+                           ++visits[i];
+                         }
+                       });
+      for (std::size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(visits[i], 1) << "count " << count << ", grain " << grain;
+      }
+    }
+  }
+
+  // Chunks are multiples of the grain and at most one per thread.
+  std::vector<std::size_t> begins(pool.size(), 1);
+  pool.parallelFor(1000, 16,
+                   [&begins](const std::size_t begin, const std::size_t) {
+                     begins[begin / 256] = begin;
+                   });
+  EXPECT_EQ(begins, (std::vector<std::size_t>{0, 256, 512, 768}));
+
+  // Fewer than two grains stay on the calling thread, two grains do not.
+  std::atomic<std::size_t> calls{0};
+  const auto count_calls = [&calls](const std::size_t, const std::size_t) {
+    ++calls;
+  };
+  pool.parallelFor(33, 17, count_calls);
+  EXPECT_EQ(calls.load(), 1u);
+  calls = 0;
+  pool.parallelFor(34, 17, count_calls);
+  EXPECT_EQ(calls.load(), 2u);
+}
+
+GTEST_TEST(ThreadPoolTest, ThreadPoolExceptionTests) {
+  ThreadPool pool{3};
+  EXPECT_THROW(pool.parallelFor(300, 1,
+                                [](const std::size_t begin, const std::size_t) {
+                                  if (begin > 0) {
+                                    throw std::runtime_error("chunk failed");
+                                  }
+                                }),
+               std::runtime_error);
+  // The pool is still usable after a failed loop.
+  std::size_t total{0};
+  pool.parallelFor(10, 100, [&total](const std::size_t begin,
+                                     const std::size_t end) {
+    total += end - begin;
+  });
+  EXPECT_EQ(total, 10u);
+}
+
+GTEST_TEST(ThreadPoolTest, ParallelTransformTests) {
+  const Isometry t{Vector3(1., -2., 3.),
+                   Isometry::fromEulerAngles(0.3, -0.2, 1.1).rotation()};
+  ThreadPool pool{4};
+  // Sizes that are not multiples of the aligned blocks nor of the grain.
+  for (const std::size_t size : {0, 5, 1001, 10007}) {
+    std::vector<Vector3> points;
+    for (std::size_t i = 0; i < size; ++i) {
+      points.emplace_back(0.1 * i, -0.2 * i, 1. + 0.01 * i);
+    }
+    std::vector<Vector3> expected(size);
+    t.transform(points.data(), size, expected.data());
+
+    std::vector<Vector3> result(size);
+    parallelTransform(t, points.data(), size, result.data(), &pool, 100);
+    EXPECT_EQ(result, expected);
+
+    const PointCloud cloud{points};
+    PointCloud cloud_result;
+    parallelTransform(t, cloud, &cloud_result, &pool, 100);
+    EXPECT_EQ(cloud_result.toVector(), expected);
+
+    PointCloud in_place{points};
+    parallelTransform(t, &in_place, &pool, 1);
+    EXPECT_EQ(in_place.toVector(), expected);
+
+    PointCloudf cloud_float{std::vector<Vector3f>(size, Vector3f::kUnitX)};
+    parallelTransform(t, &cloud_float, &pool, 1);
+    for (std::size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(cloud_float[i], Isometryf(t) * Vector3f::kUnitX);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/* Copyright 2020, Ekumen
+ * Isometry library tests
+ * Author: Alexis Pojomovsky, 2020
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#include <isometry/isometry.hpp>
+#include <isometry/quaternion.hpp>
+#include <isometry/transform_buffer.hpp>
+#include "gtest/gtest.h"
+
+namespace {
+
+// Number of calls to the global operator new, to check that insertions and
+// lookups do not allocate.
+std::size_t allocation_count{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  void* ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace ekumen {
+namespace math {
+namespace test {
+namespace {
+
+testing::AssertionResult areAlmostEqual(const Isometry& obj1,
+                                        const Isometry& obj2,
+                                        const double tolerance) {
+  for (int r = 0; r < 3; ++r) {
+    if (std::abs(obj1.translation()[r] - obj2.translation()[r]) > tolerance) {
+      return testing::AssertionFailure()
+             << "Values are not equal: " << obj1 << " and " << obj2;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(obj1.rotation()(r, c) - obj2.rotation()(r, c)) >
+          tolerance) {
+        return testing::AssertionFailure()
+               << "Values are not equal: " << obj1 << " and " << obj2;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+Isometry makeIsometry(const double x, const double y, const double z,
+                      const double roll, const double pitch,
+                      const double yaw) {
+  return Isometry{Vector3{x, y, z},
+                  Isometry::fromEulerAngles(roll, pitch, yaw).rotation()};
+}
+
+GTEST_TEST(TransformBufferTest, TransformBufferLookupTests) {
+  const double kTolerance{1e-12};
+  const Isometry a = makeIsometry(1., 2., 3., 0.1, 0.2, 0.3);
+  const Isometry b = makeIsometry(3., 0., -1., 0.1, 0.2, 1.3);
+  const Isometry c = makeIsometry(-1., 5., 2., -0.4, 0.7, 0.);
+
+  TransformBuffer buffer{4};
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.capacity(), 4u);
+  buffer.insert(1., a);
+  buffer.insert(2., b);
+  buffer.insert(4., c);
+  EXPECT_EQ(buffer.size(), 3u);
+  EXPECT_EQ(buffer.oldestTime(), 1.);
+  EXPECT_EQ(buffer.newestTime(), 4.);
+  EXPECT_TRUE(areAlmostEqual(buffer.latest(), c, 0.));
+
+  // Stored samples are returned as inserted.
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(1.), a, 0.));
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(2.), b, 0.));
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(4.), c, 0.));
+
+  // Between samples, the translation is lerped and the rotation slerped.
+  const Quaternion qa = Quaternion::fromRotationMatrix(a.rotation());
+  const Quaternion qb = Quaternion::fromRotationMatrix(b.rotation());
+  const Isometry expected{Vector3{1.5, 1.5, 2.},
+                          qa.slerp(qb, 0.25).toRotationMatrix()};
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(1.25), expected, kTolerance));
+  // a and b differ by a yaw of 1 rad, so halfway is a yaw of 0.8.
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(1.5),
+                             makeIsometry(2., 1., 1., 0.1, 0.2, 0.8),
+                             kTolerance));
+  const Quaternion qc = Quaternion::fromRotationMatrix(c.rotation());
+  EXPECT_TRUE(areAlmostEqual(
+      buffer.lookup(3.5),
+      Isometry{Vector3{0., 3.75, 1.25}, qb.slerp(qc, 0.75).toRotationMatrix()},
+      kTolerance));
+}
+
+GTEST_TEST(TransformBufferTest, TransformBufferWrapAroundTests) {
+  const double kTolerance{1e-12};
+  TransformBuffer buffer{3};
+  for (int i = 0; i < 10; ++i) {
+    buffer.insert(i, Isometry::fromTranslation(Vector3(i, 0., 0.)));
+  }
+  // Only the 3 newest samples are kept.
+  EXPECT_EQ(buffer.size(), 3u);
+  EXPECT_EQ(buffer.oldestTime(), 7.);
+  EXPECT_EQ(buffer.newestTime(), 9.);
+  EXPECT_THROW(buffer.lookup(6.5), std::out_of_range);
+  for (const double time : {7., 7.3, 8., 8.9, 9.}) {
+    EXPECT_TRUE(areAlmostEqual(buffer.lookup(time),
+                               Isometry::fromTranslation(Vector3(time, 0., 0.)),
+                               kTolerance));
+  }
+
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+  buffer.insert(0.5, Isometry::fromTranslation(Vector3::kUnitY));
+  EXPECT_EQ(buffer.oldestTime(), 0.5);
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(0.5),
+                             Isometry::fromTranslation(Vector3::kUnitY), 0.));
+}
+
+GTEST_TEST(TransformBufferTest, TransformBufferAllocationTests) {
+  const std::size_t kCapacity{10000};
+  TransformBuffer buffer{kCapacity};
+  const std::size_t allocations_before = allocation_count;
+  // Fills the ring twice over, so that the steady state overwrites samples.
+  for (std::size_t i = 0; i < 2 * kCapacity; ++i) {
+    const double time = 0.01 * static_cast<double>(i);
+    buffer.insert(time, makeIsometry(time, 0., 0., 0., 0., time));
+  }
+  Isometry result = buffer.lookup(buffer.oldestTime());
+  for (int i = 0; i < 1000; ++i) {
+    result = buffer.lookup(buffer.oldestTime() + 0.0123 * i);
+  }
+  EXPECT_EQ(allocation_count, allocations_before);
+  EXPECT_NEAR(result.translation().x(), buffer.oldestTime() + 0.0123 * 999,
+              1e-9);
+}
+
+GTEST_TEST(TransformBufferTest, TransformBufferErrorTests) {
+  EXPECT_THROW(TransformBuffer{0}, std::invalid_argument);
+  TransformBuffer buffer{2};
+  EXPECT_THROW(buffer.lookup(0.), std::out_of_range);
+  EXPECT_THROW(buffer.latest(), std::out_of_range);
+  EXPECT_THROW(buffer.oldestTime(), std::out_of_range);
+  buffer.insert(1., Isometry::fromTranslation(Vector3::kUnitX));
+  EXPECT_THROW(buffer.insert(1., Isometry::fromTranslation(Vector3::kUnitX)),
+               std::invalid_argument);
+  EXPECT_THROW(buffer.insert(0., Isometry::fromTranslation(Vector3::kUnitX)),
+               std::invalid_argument);
+  EXPECT_THROW(buffer.lookup(0.9), std::out_of_range);
+  EXPECT_THROW(buffer.lookup(1.1), std::out_of_range);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -109,6 +109,37 @@ GTEST_TEST(Vector3Test, Vector3FullTests) {
   EXPECT_EQ(t_moved.z(), 3.);
 }
 
+GTEST_TEST(Vector3Test, Vector3ConstexprTests) {
+  constexpr Vector3 p(1., 2., 3.);
+  constexpr Vector3 q(4., 5., 6.);
+  static_assert((p + q).x() == 5., "Sum must be constexpr");
+  static_assert((p - q).y() == -3., "Subtraction must be constexpr");
+  static_assert((p * q).z() == 18., "Product must be constexpr");
+  static_assert((2. * p / 2.).z() == 3., "Scaling must be constexpr");
+  static_assert(p.dot(q) == 32., "Dot product must be constexpr");
+  static_assert(p.cross(q)[2] == -3., "Cross product must be constexpr");
+  static_assert(Vector3::kUnitX.cross(Vector3::kUnitY).z() == 1. &&
+                    Vector3f::kZero.dot(Vector3f::kUnitZ) == 0.f,
+                "Constants must be constexpr");
+  EXPECT_EQ(p.cross(q), Vector3(-3., 6., -3.));
+}
+
+GTEST_TEST(Vector3Test, Vector3StorageTests) {
+  Vector3 p{1., 2., 3.};
+  const double* data = p.data();
+  EXPECT_EQ(data[0], p.x());
+  EXPECT_EQ(data[1], p.y());
+  EXPECT_EQ(data[2], p.z());
+  EXPECT_EQ(p.at(0), 1.);
+  EXPECT_EQ(p.at(1), 2.);
+  EXPECT_EQ(p.at(2), 3.);
+
+  p.at(1) = 5.;
+  EXPECT_EQ(p.y(), 5.);
+  p.data()[2] = 6.;
+  EXPECT_EQ(p[2], 6.);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace math